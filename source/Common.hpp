@@ -15,6 +15,29 @@ struct GUI;
 struct GUISystem;
 struct GUIItem;
 struct GUIFont;
+struct GUITemplate;
+
+/// Kind of widget a GUIItem represents, given as a text token, such as       
+/// "window", "label", "button", "checkbox", "slider", "list", "table",       
+/// "plot", "console", "inspector", "thumbnails", "editor" or "input" - see   
+/// ParseWidgetKind                                                           
+LANGULUS_DEFINE_TRAIT(Widget,
+   "Kind of widget a GUI item represents");
+
+/// Marks a GUIItem subtree that rarely changes, so its geometry is recorded  
+/// once and replayed until the subtree is invalidated - see GUIRecording     
+LANGULUS_DEFINE_TRAIT(Static,
+   "Whether a GUI item's geometry is recorded and replayed");
+
+/// Forces a top-level GUIItem to always or never be drawn from an offscreen  
+/// layer - when not provided, it's decided automatically, see GUILayer       
+LANGULUS_DEFINE_TRAIT(Layer,
+   "Whether a GUI window is rendered into a cached offscreen layer");
+
+/// Minimum and maximum value of a slider GUIItem, in that order - sliders    
+/// range from zero to one when not provided                                  
+LANGULUS_DEFINE_TRAIT(Limits,
+   "Minimum and maximum value of a GUI slider");
 
 #if 0
    #define VERBOSE_GUI(...)      Logger::Verbose(Self(), __VA_ARGS__)
@@ -29,4 +52,13 @@ struct GUIFont;
 
 #if LANGULUS(DEBUG)
    #define IMGUI_VULKAN_DEBUG_REPORT
+#endif
+
+/// SSE2 is used for converting geometry and evaluating tweens, with scalar   
+/// fallbacks                                                                 
+#if defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+   #include <emmintrin.h>
+   #define GUI_SSE2 1
+#else
+   #define GUI_SSE2 0
 #endif
\ No newline at end of file
@@ -7,6 +7,8 @@
 ///                                                                           
 #pragma once
 #include "GUISystem.hpp"
+#include "GUICompositor.hpp"
+#include "GUITextures.hpp"
 
 
 ///                                                                           
@@ -20,7 +22,13 @@ struct GUI final : A::UI::Module {
    LANGULUS_VERBS(Verbs::Create);
 
 private:
-   // List of created GUI systems                                       
+   // Merges the systems that share a window into one submission        
+   GUICompositor mCompositor;
+   // Images drawn by all systems, so that systems composited into the  
+   // same window also share one texture array                          
+   GUITextures mTextures;
+   // List of created GUI systems - declared last, so that systems are  
+   // destroyed before the compositor and textures they release into    
    TFactory<GUISystem> mSystems;
 
 public:
@@ -28,5 +36,8 @@ public:
 
    bool Update(Time);
    void Create(Verb&);
+
+   NOD() auto& GetCompositor() noexcept { return mCompositor; }
+   NOD() auto& GetTextures() noexcept { return mTextures; }
 };
 
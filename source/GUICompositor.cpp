@@ -0,0 +1,235 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUICompositor.hpp"
+#include <algorithm>
+
+
+/// Register a GUI system as drawing into a window                            
+/// Systems are composited in the order they are attached, so the first       
+/// one ends up at the back                                                   
+///   @param window - the window the system draws into                        
+///   @param system - the system                                              
+void GUICompositor::Attach(const A::Window* window, const GUISystem* system) {
+   auto& target = mTargets[window];
+   target.mSources.push_back({system, nullptr, false});
+   Restart(target);
+}
+
+/// Unregister a GUI system from a window                                     
+/// The window is forgotten along with its upload, once nothing draws in it   
+///   @param window - the window the system draws into                        
+///   @param system - the system                                              
+void GUICompositor::Detach(const A::Window* window, const GUISystem* system) {
+   const auto found = mTargets.find(window);
+   if (found == mTargets.end())
+      return;
+
+   auto& sources = found->second.mSources;
+   std::erase_if(sources, [system](const Source& source) {
+      return source.mSystem == system;
+   });
+
+   if (sources.empty())
+      mTargets.erase(found);
+   else
+      Restart(found->second);
+}
+
+/// Start waiting for a new frame of all sources of a window                  
+///   @param target - the window                                              
+void GUICompositor::Restart(Target& target) noexcept {
+   for (auto& source : target.mSources)
+      source.mFresh = false;
+   target.mSubmitted = 0;
+}
+
+/// Change how long a window waits for its systems to submit                  
+///   @param deadline - time after the first submission of a frame            
+void GUICompositor::SetDeadline(Clock::duration deadline) noexcept {
+   mDeadline = deadline;
+}
+
+/// Check if more than one GUI system draws into a window                     
+///   @param window - the window to check                                     
+///   @return true if the window's systems have to be composited              
+bool GUICompositor::IsShared(const A::Window* window) const {
+   const auto found = mTargets.find(window);
+   return found != mTargets.end() and found->second.mSources.size() > 1;
+}
+
+/// Submit the draw data of a GUI system for the current frame                
+/// The window is composited once all of its systems have submitted, once     
+/// the deadline after the first submission passes, or once a system submits  
+/// twice, which means the others missed the frame. Systems that haven't      
+/// submitted are drawn with their last draw data, which ImGui keeps valid    
+/// until the next ImGui::Render of the same context                          
+///   @param window - the window the system draws into                        
+///   @param system - the system                                              
+///   @param data - the system's draw data                                    
+///   @param workers - threads to stage on, nullptr to stage in place         
+///   @param rebase - whether the renderer lacks RendererHasVtxOffset, so     
+///      indices must be staged with their base vertex added                  
+///   @return true if the window was composited                               
+bool GUICompositor::Submit(const A::Window* window, const GUISystem* system, const ImDrawData* data, GUIWorkers* workers, bool rebase) {
+   const auto found = mTargets.find(window);
+   if (found == mTargets.end())
+      return false;
+
+   auto& target = found->second;
+   const auto submitter = std::find_if(
+      target.mSources.begin(), target.mSources.end(),
+      [system](const Source& source) { return source.mSystem == system; });
+   if (submitter == target.mSources.end())
+      return false;
+
+   const auto now = Clock::now();
+   const bool again = submitter->mFresh;
+   if (not target.mSubmitted)
+      target.mStarted = now;
+   if (not again) {
+      submitter->mFresh = true;
+      ++target.mSubmitted;
+   }
+   submitter->mData = data;
+
+   if (not again and target.mSubmitted < target.mSources.size()
+   and now - target.mStarted < mDeadline)
+      return false;
+
+   Compose(target, workers, rebase);
+   Restart(target);
+   return true;
+}
+
+/// Stage the draw lists of all systems of a window together, and build       
+/// the window's command stream                                               
+///   @param target - the window to composite                                 
+///   @param workers - threads to stage on, nullptr to stage in place         
+///   @param rebase - whether to stage indices with their base vertex added   
+void GUICompositor::Compose(Target& target, GUIWorkers* workers, bool rebase) {
+   target.mLists.clear();
+   target.mCommands.clear();
+   target.mBinds = target.mMerged = 0;
+
+   ImVec2 origin {};
+   bool first = true;
+   for (auto& source : target.mSources) {
+      const auto data = source.mData;
+      if (not data or not data->Valid)
+         continue;
+      if (first)
+         origin = data->DisplayPos;
+      first = false;
+
+      // CmdLists is indexed, because it's an array or an ImVector,     
+      // depending on the ImGui version                                 
+      for (int n = 0; n < data->CmdListsCount; ++n)
+         target.mLists.push_back(data->CmdLists[n]);
+   }
+
+   target.mUpload.Stage(target.mLists.data(), target.mLists.size(), origin, workers, rebase);
+
+   // Lists are staged in source order, so ranges are walked alongside  
+   const auto& ranges = target.mUpload.GetRanges();
+   Offset index = 0;
+   ImTextureID bound {};
+   for (auto& source : target.mSources) {
+      const auto data = source.mData;
+      if (not data or not data->Valid)
+         continue;
+
+      const auto offset = data->DisplayPos;
+      for (int n = 0; n < data->CmdListsCount; ++n, ++index) {
+         const auto list = target.mLists[index];
+         const auto& range = ranges[index];
+
+         for (auto& cmd : list->CmdBuffer) {
+            if (cmd.UserCallback) {
+               // Callbacks might change any state, so the texture      
+               // is bound again after them                             
+               target.mCommands.push_back({
+                  cmd.ClipRect, cmd.TextureId, 0, 0, 0,
+                  range.mFormat, false, list, &cmd
+               });
+               bound = {};
+               continue;
+            }
+
+            if (not cmd.ElemCount)
+               continue;
+
+            const ImVec4 clip {
+               cmd.ClipRect.x - offset.x, cmd.ClipRect.y - offset.y,
+               cmd.ClipRect.z - offset.x, cmd.ClipRect.w - offset.y
+            };
+            // Rebased indices already include the list's base vertex   
+            const auto vertex = rebase
+               ? cmd.VtxOffset : range.mVertexOffset + cmd.VtxOffset;
+            const auto start = range.mIndexOffset + cmd.IdxOffset;
+
+            if (not target.mCommands.empty()) {
+               auto& last = target.mCommands.back();
+               if (not last.mCallback
+               and last.mTexture == cmd.TextureId
+               and last.mFormat == range.mFormat
+               and last.mVertexOffset == vertex
+               and last.mIndexOffset + last.mIndexCount == start
+               and last.mClipRect.x == clip.x and last.mClipRect.y == clip.y
+               and last.mClipRect.z == clip.z and last.mClipRect.w == clip.w) {
+                  last.mIndexCount += cmd.ElemCount;
+                  ++target.mMerged;
+                  continue;
+               }
+            }
+
+            const bool bind = not bound or bound != cmd.TextureId;
+            target.mCommands.push_back({
+               clip, cmd.TextureId, vertex, start, cmd.ElemCount,
+               range.mFormat, bind, list, nullptr
+            });
+
+            if (bind) {
+               bound = cmd.TextureId;
+               ++target.mBinds;
+            }
+         }
+      }
+   }
+}
+
+/// Get the merged upload of a window                                         
+///   @param window - the window                                              
+///   @return the upload, or nullptr if the window isn't composited           
+const GUIUpload* GUICompositor::GetUpload(const A::Window* window) const {
+   const auto found = mTargets.find(window);
+   return found != mTargets.end() ? &found->second.mUpload : nullptr;
+}
+
+/// Get the merged command stream of a window                                 
+///   @param window - the window                                              
+///   @return the commands, or nullptr if the window isn't composited         
+const std::vector<GUICompositor::Command>* GUICompositor::GetCommands(const A::Window* window) const {
+   const auto found = mTargets.find(window);
+   return found != mTargets.end() ? &found->second.mCommands : nullptr;
+}
+
+/// Get the number of texture binds in a window's command stream              
+///   @param window - the window                                              
+///   @return the number of binds                                             
+Count GUICompositor::GetBinds(const A::Window* window) const {
+   const auto found = mTargets.find(window);
+   return found != mTargets.end() ? found->second.mBinds : 0;
+}
+
+/// Get the number of commands that were merged into their predecessors       
+///   @param window - the window                                              
+///   @return the number of merged commands                                   
+Count GUICompositor::GetMerged(const A::Window* window) const {
+   const auto found = mTargets.find(window);
+   return found != mTargets.end() ? found->second.mMerged : 0;
+}
@@ -0,0 +1,96 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIUpload.hpp"
+#include <Langulus/Platform.hpp>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+struct GUISystem;
+
+
+///                                                                           
+///   Compositor of GUI systems sharing a window                              
+///                                                                           
+/// GUI systems that draw into the same window hand their draw data to the    
+/// compositor, instead of staging it themselves. Once all of them have       
+/// submitted, or the frame's deadline passes, their draw lists are staged    
+/// together in one upload, and a single command stream is produced, in the   
+/// order the systems were attached. Systems that missed the deadline are     
+/// drawn with their previous frame. Consecutive commands with the same       
+/// texture don't rebind it, and adjacent ones that continue each other are   
+/// merged. Composited windows are always drawn from triangles - systems that 
+/// share a window can't hand it instances                                    
+///                                                                           
+struct GUICompositor {
+   /// A draw call in the merged stream                                       
+   struct Command {
+      // Clip rectangle, relative to the display position               
+      ImVec4 mClipRect;
+      ImTextureID mTexture;
+      // Base vertex and first index in the upload's buffers - the base 
+      // vertex is already in the indices, if the upload is rebased     
+      uint32_t mVertexOffset;
+      uint32_t mIndexOffset;
+      uint32_t mIndexCount;
+      GUIUpload::Format mFormat;
+      // Whether the texture differs from the previous command's        
+      bool mBind;
+      // Callbacks are forwarded as they are, with their draw list      
+      const ImDrawList* mList;
+      const ImDrawCmd* mCallback;
+   };
+
+   using Clock = std::chrono::steady_clock;
+
+   // How long after the first submission of a frame the window is      
+   // composited, even if some systems haven't submitted yet            
+   static constexpr auto DefaultDeadline = std::chrono::milliseconds {4};
+
+private:
+   /// A GUI system and the draw data it submitted last                       
+   struct Source {
+      const GUISystem* mSystem;
+      const ImDrawData* mData;
+      // Whether mData was submitted for the current frame              
+      bool mFresh;
+   };
+
+   /// Everything drawn into a single window                                  
+   struct Target {
+      // Attached systems, in drawing order                             
+      std::vector<Source> mSources;
+      Count mSubmitted {};
+      // Time of the first submission of the current frame              
+      Clock::time_point mStarted;
+      GUIUpload mUpload;
+      std::vector<const ImDrawList*> mLists;
+      std::vector<Command> mCommands;
+      Count mBinds {};
+      Count mMerged {};
+   };
+
+   std::unordered_map<const A::Window*, Target> mTargets;
+   Clock::duration mDeadline {DefaultDeadline};
+
+   void Compose(Target&, GUIWorkers*, bool rebase);
+   static void Restart(Target&) noexcept;
+
+public:
+   void Attach(const A::Window*, const GUISystem*);
+   void Detach(const A::Window*, const GUISystem*);
+   NOD() bool IsShared(const A::Window*) const;
+   bool Submit(const A::Window*, const GUISystem*, const ImDrawData*, GUIWorkers* = nullptr, bool rebase = false);
+   void SetDeadline(Clock::duration) noexcept;
+
+   NOD() const GUIUpload* GetUpload(const A::Window*) const;
+   NOD() const std::vector<Command>* GetCommands(const A::Window*) const;
+   NOD() Count GetBinds(const A::Window*) const;
+   NOD() Count GetMerged(const A::Window*) const;
+};
@@ -0,0 +1,386 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIConsole.hpp"
+#include "GUI.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+///                                                                           
+///   Logger listener, that duplicates everything logged into a console       
+///                                                                           
+struct GUIConsole::Listener final : Logger::A::Interface {
+   GUIConsole* mConsole;
+
+   Listener(GUIConsole* console)
+      : mConsole {console} {}
+
+   void Write(const Token& text) const noexcept override {
+      mConsole->Write(text);
+   }
+
+   void Write(const Logger::Style&) const noexcept override {}
+
+   void NewLine() const noexcept override {
+      mConsole->NewLine();
+   }
+
+   void Clear() const noexcept override {}
+};
+
+/// Lowercase a character, for case-insensitive filtering                     
+///   @param c - the character                                                
+///   @return the lowercase character                                         
+inline char ToLower(char c) noexcept {
+   return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+/// Console construction                                                      
+///   @param capacity - size of the text arena in bytes                       
+GUIConsole::GUIConsole(Count capacity)
+   : mArena(std::max<Count>(capacity, 1024)) {}
+
+/// Console destruction                                                       
+GUIConsole::~GUIConsole() {
+   DetachFromLogger();
+}
+
+/// Start duplicating the Logger output into the console                      
+void GUIConsole::AttachToLogger() {
+   if (mListener)
+      return;
+
+   mListener = new Listener {this};
+   Logger::AttachDuplicator(mListener);
+}
+
+/// Stop duplicating the Logger output into the console                       
+void GUIConsole::DetachFromLogger() {
+   if (not mListener)
+      return;
+
+   Logger::DetachDuplicator(mListener);
+   delete mListener;
+   mListener = nullptr;
+}
+
+/// Write text, that may contain new lines, to the console                    
+/// Safe to call from any thread                                              
+///   @param text - the text to write                                         
+void GUIConsole::Write(const Token& text) {
+   std::lock_guard lock {mMutex};
+   auto begin = text.data();
+   const auto end = begin + text.size();
+   while (begin != end) {
+      const auto newline = std::find(begin, end, '\n');
+      mPending.append(begin, newline);
+      if (newline == end)
+         break;
+
+      Commit(mPending.data(), mPending.size());
+      mPending.clear();
+      begin = newline + 1;
+   }
+}
+
+/// Finish the current line                                                   
+/// Safe to call from any thread                                              
+void GUIConsole::NewLine() {
+   std::lock_guard lock {mMutex};
+   Commit(mPending.data(), mPending.size());
+   mPending.clear();
+}
+
+/// Remove all lines                                                          
+/// Safe to call from any thread - the view drops the lines when it catches   
+/// up with the arena                                                         
+void GUIConsole::Clear() {
+   std::lock_guard lock {mMutex};
+   mFirstLine += mLines.size();
+   mLines.clear();
+   mPending.clear();
+}
+
+/// Replace the contents with the elements of a container, one per line       
+///   @param data - the lines                                                 
+void GUIConsole::SetData(const Many& data) {
+   Clear();
+   for (Offset i = 0; i < data.GetCount(); ++i) {
+      const auto line = data.GetElement(i).template AsCast<Text>();
+      Write(Token {line});
+      NewLine();
+   }
+}
+
+/// Get the number of lines in the arena                                      
+///   @return the number of lines                                             
+Count GUIConsole::GetLineCount() const {
+   std::lock_guard lock {mMutex};
+   return mLines.size();
+}
+
+/// Store a finished line in the arena, dropping the oldest lines if needed   
+/// Lines are always contiguous - if a line doesn't fit at the end of the     
+/// arena, the remainder is skipped and the line is written at the start      
+///   @param text - the line, without the new line character                  
+///   @param size - the size of the line in bytes                             
+void GUIConsole::Commit(const char* text, Count size) {
+   const Count capacity = mArena.size();
+   size = std::min(size, capacity);
+
+   const auto offset = mHead % capacity;
+   if (offset + size > capacity)
+      mHead += capacity - offset;
+
+   const auto start = mHead;
+   mHead += size;
+
+   // Drop the lines that are about to be overwritten - a line survives 
+   // only if it starts within the last 'capacity' bytes                
+   while (not mLines.empty() and mLines.front().mStart + capacity < mHead) {
+      mLines.pop_front();
+      ++mFirstLine;
+   }
+
+   std::memcpy(mArena.data() + start % capacity, text, size);
+   mLines.push_back({start, static_cast<uint32_t>(size)});
+}
+
+/// Get the text of a line in the arena, the arena must be locked             
+///   @param line - the line                                                  
+///   @return a pointer to the first character of the line                    
+const char* GUIConsole::GetText(const Line& line) const noexcept {
+   return mArena.data() + line.mStart % mArena.size();
+}
+
+/// Check if a line passes the filter, the arena must be locked               
+///   @param line - the line to test                                          
+///   @return true if the line contains the filter, ignoring case             
+bool GUIConsole::Matches(const Line& line) const {
+   if (mFilter.empty())
+      return true;
+
+   const auto text = GetText(line);
+   return std::search(text, text + line.mSize, mFilter.begin(), mFilter.end(),
+      [](char a, char b) { return ToLower(a) == b; }
+   ) != text + line.mSize;
+}
+
+/// Change the filter                                                         
+/// If the new filter contains the old one, it can only match a subset of     
+/// the current view, so only the view is filtered. Otherwise the lines       
+/// are tested again from the start, over a number of frames                  
+///   @param filter - the new lowercase filter                                
+void GUIConsole::SetFilter(const std::string& filter) {
+   if (filter == mFilter)
+      return;
+
+   const bool narrowing = filter.find(mFilter) != std::string::npos;
+   mFilter = filter;
+
+   std::lock_guard lock {mMutex};
+   if (not narrowing) {
+      mView.clear();
+      mViewBase = 0;
+      mScanned = mFirstLine;
+      return;
+   }
+
+   std::deque<Visible> view;
+   double previous = mViewBase;
+   double bottom = 0;
+   for (auto& visible : mView) {
+      const double height = visible.mBottom - previous;
+      previous = visible.mBottom;
+      if (visible.mLine >= mFirstLine
+      and Matches(mLines[visible.mLine - mFirstLine])) {
+         bottom += height;
+         view.push_back({visible.mLine, bottom});
+      }
+   }
+
+   mView = std::move(view);
+   mViewBase = 0;
+}
+
+/// Copy the text of a line out of the arena, the arena must be locked        
+///   @param id - the line to copy                                            
+void GUIConsole::CopyLine(uint64_t id) {
+   const auto& line = mLines[id - mFirstLine];
+   const auto text = GetText(line);
+   mCopies.push_back({id, mCopiedText.size(), line.mSize});
+   mCopiedText.append(text, line.mSize);
+}
+
+/// Bring the view up to date with the arena                                  
+/// Dropped lines leave the view, new lines are tested against the filter     
+/// and measured only once, unless the wrap width changes. A new width is     
+/// taken only once it stops changing, so that resizing doesn't measure       
+/// all lines on every frame. Wrapped lines are copied while the arena is     
+/// locked, and measured after that                                           
+///   @param wrapWidth - width to wrap lines at, or zero to not wrap          
+void GUIConsole::CatchUp(float wrapWidth) {
+   // While a new width settles, lines are measured with the old one,   
+   // so heights stay consistent. Turning wrapping on or off takes      
+   // effect immediately                                                
+   if (wrapWidth > 0 and mMeasuredWidth > 0 and wrapWidth != mMeasuredWidth) {
+      const auto frame = ImGui::GetFrameCount();
+      if (wrapWidth != mResizedWidth) {
+         mResizedWidth = wrapWidth;
+         mResizedFrame = frame;
+      }
+
+      if (frame - mResizedFrame < ResizeSettleFrames)
+         wrapWidth = mMeasuredWidth;
+   }
+   else mResizedWidth = -1;
+
+   const bool remeasure = wrapWidth != mMeasuredWidth;
+   const bool wrapping = wrapWidth > 0;
+   Count remeasured = 0;
+   mCopies.clear();
+   mCopiedText.clear();
+
+   {
+      std::lock_guard lock {mMutex};
+
+      // Lines dropped from the arena leave the view                    
+      while (not mView.empty() and mView.front().mLine < mFirstLine) {
+         mViewBase = mView.front().mBottom;
+         mView.pop_front();
+      }
+      mScanned = std::max(mScanned, mFirstLine);
+
+      if (remeasure and wrapping) {
+         for (auto& visible : mView)
+            CopyLine(visible.mLine);
+         remeasured = mView.size();
+      }
+
+      // Test each new line against the filter exactly once             
+      const auto end = mFirstLine + mLines.size();
+      for (Count budget = RescanBudget; mScanned < end and budget; ++mScanned, --budget) {
+         if (not Matches(mLines[mScanned - mFirstLine]))
+            continue;
+
+         if (wrapping)
+            CopyLine(mScanned);
+         else
+            mCopies.push_back({mScanned, 0, 0});
+      }
+   }
+
+   const auto& style = ImGui::GetStyle();
+   const float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+   const auto measure = [&](const CopiedLine& copy) -> double {
+      if (not wrapping)
+         return lineHeight;
+
+      const auto text = mCopiedText.data() + copy.mOffset;
+      return ImGui::CalcTextSize(text, text + copy.mSize, false, wrapWidth).y
+         + style.ItemSpacing.y;
+   };
+
+   // Remeasure everything only when the wrap width changes             
+   mRemeasuredLines = remeasured;
+   if (remeasure) {
+      mMeasuredWidth = wrapWidth;
+      mViewBase = 0;
+      double bottom = 0;
+      for (Offset i = 0; i < mView.size(); ++i) {
+         bottom += wrapping ? measure(mCopies[i]) : lineHeight;
+         mView[i].mBottom = bottom;
+      }
+   }
+
+   double bottom = mView.empty() ? mViewBase : mView.back().mBottom;
+   for (Offset i = remeasured; i < mCopies.size(); ++i) {
+      bottom += measure(mCopies[i]);
+      mView.push_back({mCopies[i].mLine, bottom});
+   }
+}
+
+/// Submit the visible lines of the console                                   
+///   @param item - the item that owns the console                            
+void GUIConsole::Submit(GUIItem& item) {
+   mSubmittedLines = 0;
+   ImGui::PushID(this);
+
+   if (ImGui::InputTextWithHint("##filter", "Filter", mFilterInput, sizeof(mFilterInput))) {
+      std::string filter {mFilterInput};
+      for (auto& c : filter)
+         c = ToLower(c);
+      SetFilter(filter);
+   }
+   ImGui::SameLine();
+   ImGui::Checkbox("Wrap", &mWrap);
+   ImGui::SameLine();
+   ImGui::Checkbox("Auto-scroll", &mAutoScroll);
+
+   const auto flags = mWrap ? ImGuiWindowFlags_None : ImGuiWindowFlags_HorizontalScrollbar;
+   if (ImGui::BeginChild("##console", item.GetRequestedSize(), false, flags)) {
+      CatchUp(mWrap ? ImGui::GetContentRegionAvail().x : 0.0f);
+
+      // Heights are relative to the first line in the view, so they    
+      // stay precise enough for ImGui's single precision               
+      const auto total = static_cast<float>(
+         mView.empty() ? 0 : mView.back().mBottom - mViewBase);
+      const float scroll = ImGui::GetScrollY();
+      const float height = ImGui::GetWindowHeight();
+      const float origin = ImGui::GetCursorPosY();
+
+      // Find the visible lines by their running height                 
+      const auto first = std::upper_bound(mView.begin(), mView.end(),
+         scroll + mViewBase,
+         [](double y, const Visible& visible) { return y < visible.mBottom; });
+      auto last = first;
+      double bottom = first == mView.begin() ? mViewBase : (first - 1)->mBottom;
+      while (last != mView.end() and bottom - mViewBase <= scroll + height)
+         bottom = (last++)->mBottom;
+
+      // Copy them, as lines may be dropped by the logger meanwhile     
+      mCopies.clear();
+      mCopiedText.clear();
+      {
+         std::lock_guard lock {mMutex};
+         for (auto it = first; it != last; ++it) {
+            if (it->mLine >= mFirstLine)
+               CopyLine(it->mLine);
+            else
+               mCopies.push_back({it->mLine, 0, 0});
+         }
+      }
+
+      // Lines are wrapped at the width they were measured with, which  
+      // lags behind while the console is being resized                 
+      if (mWrap)
+         ImGui::PushTextWrapPos(ImGui::GetCursorPosX() + mMeasuredWidth);
+
+      double top = first == mView.begin() ? mViewBase : (first - 1)->mBottom;
+      auto it = first;
+      for (auto& copy : mCopies) {
+         const auto text = mCopiedText.data() + copy.mOffset;
+         ImGui::SetCursorPosY(origin + static_cast<float>(top - mViewBase));
+         ImGui::TextUnformatted(text, text + copy.mSize);
+         top = (it++)->mBottom;
+         ++mSubmittedLines;
+      }
+
+      if (mWrap)
+         ImGui::PopTextWrapPos();
+
+      // Reserve the full height, so that the scrollbar is correct      
+      ImGui::SetCursorPosY(origin + total);
+      ImGui::Dummy({0, 0});
+
+      if (mAutoScroll and ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+         ImGui::SetScrollHereY(1.0f);
+   }
+   ImGui::EndChild();
+   ImGui::PopID();
+}
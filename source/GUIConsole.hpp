@@ -0,0 +1,131 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIWidget.hpp"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+///                                                                           
+///   Streaming log console                                                   
+///                                                                           
+/// Text is kept in a fixed-capacity ring arena, and the oldest lines are     
+/// dropped when it fills up. Lines are indexed as they arrive, and each      
+/// new line is tested against the filter exactly once, so the visible        
+/// view grows incrementally instead of being rebuilt every frame. Heights    
+/// of wrapped lines are cached as a running sum, so only visible lines       
+/// are ever measured and submitted. Can be attached to the Logger. Lines     
+/// are copied out of the arena before ImGui is called, because ImGui may     
+/// log, and the logger writes to the arena                                   
+///                                                                           
+struct GUIConsole final : GUIWidget {
+   // Default capacity of the text arena, in bytes                      
+   static constexpr Count DefaultCapacity = 8 * 1024 * 1024;
+   // Maximum number of lines tested against a new filter per frame     
+   static constexpr Count RescanBudget = 65536;
+   // Frames a new wrap width has to stay the same, before all lines are
+   // measured again with it                                            
+   static constexpr int ResizeSettleFrames = 8;
+
+private:
+   /// A line inside the arena                                                
+   struct Line {
+      // Absolute offset of the first byte, arena offset is modulo capacity
+      uint64_t mStart;
+      uint32_t mSize;
+   };
+
+   /// A line that passed the filter                                          
+   struct Visible {
+      uint64_t mLine;
+      // Running sum of heights, up to and including this line - it     
+      // grows as long as lines arrive, so it's in double precision     
+      double mBottom;
+   };
+
+   /// Text of a line, copied out of the arena                                
+   struct CopiedLine {
+      uint64_t mLine;
+      Offset mOffset;
+      Count mSize;
+   };
+
+   struct Listener;
+
+   // Protects the arena and the line index, which are written by the   
+   // logger on any thread - never held while calling ImGui             
+   mutable std::mutex mMutex;
+
+   // The ring arena and the absolute write position                    
+   std::vector<char> mArena;
+   uint64_t mHead {};
+   // Line index, the first one has the id mFirstLine                   
+   std::deque<Line> mLines;
+   uint64_t mFirstLine {};
+   // Text written since the last new line                              
+   std::string mPending;
+
+   // Lines that passed the filter, with cached heights - only used on  
+   // the main thread                                                   
+   std::deque<Visible> mView;
+   // Sum of heights of the lines dropped from the front of the view    
+   double mViewBase {};
+   // Id of the next line to be tested against the filter               
+   uint64_t mScanned {};
+   // Wrap width the heights were measured with, zero when not wrapping 
+   float mMeasuredWidth {-1};
+   // Wrap width that is waiting to settle, and the frame it changed in 
+   float mResizedWidth {-1};
+   int mResizedFrame {};
+
+   // Lines copied out of the arena while it is locked, and their text  
+   std::vector<CopiedLine> mCopies;
+   std::string mCopiedText;
+
+   // Lowercase filter, and the input buffer for it                     
+   std::string mFilter;
+   char mFilterInput[128] {};
+
+   bool mWrap {};
+   bool mAutoScroll {true};
+   Listener* mListener {};
+
+   // Number of lines submitted and measured again in the last frame    
+   Count mSubmittedLines {};
+   Count mRemeasuredLines {};
+
+   void Commit(const char*, Count);
+   void SetFilter(const std::string&);
+   void CatchUp(float wrapWidth);
+   void CopyLine(uint64_t);
+   NOD() const char* GetText(const Line&) const noexcept;
+   NOD() bool Matches(const Line&) const;
+
+public:
+   GUIConsole(Count capacity = DefaultCapacity);
+   ~GUIConsole();
+
+   void Write(const Token&);
+   void NewLine();
+   void Clear();
+   void SetWrap(bool wrap) noexcept { mWrap = wrap; }
+
+   void AttachToLogger();
+   void DetachFromLogger();
+
+   void SetData(const Many&) override;
+   void Submit(GUIItem&) override;
+
+   NOD() Count GetLineCount() const;
+   NOD() Count GetVisibleLineCount() const noexcept { return mView.size(); }
+   NOD() Count GetSubmittedLines() const noexcept { return mSubmittedLines; }
+   NOD() Count GetRemeasuredLines() const noexcept { return mRemeasuredLines; }
+};
+
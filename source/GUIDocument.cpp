@@ -0,0 +1,449 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIDocument.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+/// Replace the whole text, forgetting the undo log                           
+///   @param text - the new text                                              
+void GUIDocument::Assign(std::string&& text) {
+   const auto previous = mBreaks;
+   for (auto& buffer : mBuffers) {
+      buffer.mText.clear();
+      buffer.mBreaks.clear();
+   }
+
+   // New lines of the loaded text are indexed only once                
+   auto& original = mBuffers[Original];
+   original.mText = std::move(text);
+   const char* const begin = original.mText.data();
+   const auto end = begin + original.mText.size();
+   for (auto at = begin; at != end; ++at) {
+      at = static_cast<const char*>(std::memchr(at, '\n', end - at));
+      if (not at)
+         break;
+      original.mBreaks.push_back(at - begin);
+   }
+
+   mNodes.assign(1, {});
+   mSize = original.mText.size();
+   mBreaks = original.mBreaks.size();
+   if (mSize) {
+      mNodes[0].mPieces.push_back(MakePiece(Original, 0, mSize));
+      mNodes[0].mSize = mSize;
+      mNodes[0].mBreaks = mBreaks;
+   }
+
+   mUndo.clear();
+   mUndoTop = 0;
+   mRemoved.clear();
+   mChanges.push_back({0, previous, mBreaks});
+   ++mVersion;
+}
+
+/// Count the new lines in a span of a buffer                                 
+///   @param buffer - the buffer                                              
+///   @param start - start of the span                                        
+///   @param size - size of the span                                          
+///   @return the number of new lines                                         
+Count GUIDocument::CountBreaks(BufferId buffer, Offset start, Count size) const noexcept {
+   const auto& breaks = mBuffers[buffer].mBreaks;
+   const auto first = std::lower_bound(breaks.begin(), breaks.end(), start);
+   const auto last = std::lower_bound(first, breaks.end(), start + size);
+   return static_cast<Count>(last - first);
+}
+
+/// Create a piece for a span of a buffer                                     
+///   @param buffer - the buffer                                              
+///   @param start - start of the span                                        
+///   @param size - size of the span                                          
+///   @return the piece                                                       
+GUIDocument::Piece GUIDocument::MakePiece(BufferId buffer, Offset start, Count size) const noexcept {
+   return {buffer, start, size, CountBreaks(buffer, start, size)};
+}
+
+/// Find the piece that contains an offset                                    
+/// An offset between two pieces is at the start of the second one, and       
+/// the end of the document is past the last piece of the last node           
+///   @param offset - the offset                                              
+///   @return the position of the offset                                      
+GUIDocument::Position GUIDocument::Locate(Offset offset) const noexcept {
+   for (Offset n = 0; n < mNodes.size(); ++n) {
+      const auto& node = mNodes[n];
+      if (offset >= node.mSize) {
+         offset -= node.mSize;
+         continue;
+      }
+
+      for (Offset p = 0;; ++p) {
+         const auto& piece = node.mPieces[p];
+         if (offset < piece.mSize)
+            return {n, p, offset};
+         offset -= piece.mSize;
+      }
+   }
+
+   return {mNodes.size() - 1, mNodes.back().mPieces.size(), 0};
+}
+
+/// Make sure a piece starts at an offset, splitting the one containing it    
+///   @param offset - the offset                                              
+///   @return the position of the piece that starts at the offset             
+GUIDocument::Position GUIDocument::Split(Offset offset) {
+   const auto pos = Locate(offset);
+   if (not pos.mInner)
+      return pos;
+
+   auto& pieces = mNodes[pos.mNode].mPieces;
+   const auto piece = pieces[pos.mPiece];
+   pieces[pos.mPiece] = MakePiece(piece.mBuffer, piece.mStart, pos.mInner);
+   pieces.insert(pieces.begin() + pos.mPiece + 1, MakePiece(
+      piece.mBuffer, piece.mStart + pos.mInner, piece.mSize - pos.mInner));
+
+   if (pieces.size() <= NodeCapacity)
+      return {pos.mNode, pos.mPiece + 1, 0};
+
+   SplitNode(pos.mNode);
+   return Locate(offset);
+}
+
+/// Split a node until none of its parts is over capacity                     
+///   @param n - index of the node                                            
+void GUIDocument::SplitNode(Offset n) {
+   while (mNodes[n].mPieces.size() > NodeCapacity) {
+      auto& pieces = mNodes[n].mPieces;
+      Node next;
+      next.mPieces.assign(pieces.begin() + NodeCapacity / 2, pieces.end());
+      pieces.resize(NodeCapacity / 2);
+      for (auto& piece : next.mPieces) {
+         next.mSize += piece.mSize;
+         next.mBreaks += piece.mBreaks;
+      }
+
+      mNodes[n].mSize -= next.mSize;
+      mNodes[n].mBreaks -= next.mBreaks;
+      mNodes.insert(mNodes.begin() + ++n, std::move(next));
+   }
+}
+
+/// Insert pieces at an offset                                                
+///   @param offset - the offset                                              
+///   @param pieces - the pieces to insert                                    
+///   @param count - number of pieces                                         
+void GUIDocument::InsertPieces(Offset offset, const Piece* pieces, Count count) {
+   if (not count)
+      return;
+
+   const auto line = GetLineOf(offset);
+   const auto pos = Split(offset);
+   auto& node = mNodes[pos.mNode];
+   node.mPieces.insert(node.mPieces.begin() + pos.mPiece, pieces, pieces + count);
+
+   Count size = 0, breaks = 0;
+   for (Offset i = 0; i < count; ++i) {
+      size += pieces[i].mSize;
+      breaks += pieces[i].mBreaks;
+   }
+
+   node.mSize += size;
+   node.mBreaks += breaks;
+   mSize += size;
+   mBreaks += breaks;
+   SplitNode(pos.mNode);
+   mChanges.push_back({line, 0, breaks});
+   ++mVersion;
+}
+
+/// Remove a range of text                                                    
+///   @param offset - start of the range                                      
+///   @param size - size of the range                                         
+///   @param removed - [out] the removed pieces, can be nullptr               
+void GUIDocument::RemovePieces(Offset offset, Count size, std::vector<Piece>* removed) {
+   if (not size)
+      return;
+
+   const auto line = GetLineOf(offset);
+   Split(offset + size);
+   const auto pos = Split(offset);
+
+   Count remaining = size, breaks = 0;
+   for (auto n = pos.mNode, p = pos.mPiece; remaining;) {
+      auto& node = mNodes[n];
+      if (p == node.mPieces.size()) {
+         ++n;
+         p = 0;
+         continue;
+      }
+
+      const auto piece = node.mPieces[p];
+      if (removed)
+         removed->push_back(piece);
+      node.mPieces.erase(node.mPieces.begin() + p);
+      node.mSize -= piece.mSize;
+      node.mBreaks -= piece.mBreaks;
+      remaining -= piece.mSize;
+      breaks += piece.mBreaks;
+   }
+
+   mSize -= size;
+   mBreaks -= breaks;
+
+   // Emptied nodes are dropped, but there's always at least one        
+   std::erase_if(mNodes, [](const Node& node) { return node.mPieces.empty(); });
+   if (mNodes.empty())
+      mNodes.emplace_back();
+
+   mChanges.push_back({line, breaks, 0});
+   ++mVersion;
+}
+
+/// Forget the undone operations, before making a new one                     
+void GUIDocument::DropRedo() {
+   if (mUndoTop == mUndo.size())
+      return;
+
+   mRemoved.resize(mUndo[mUndoTop].mRemovedFirst);
+   mUndo.resize(mUndoTop);
+}
+
+/// Insert text                                                               
+///   @param offset - where to insert                                         
+///   @param text - the text to insert                                        
+///   @param merge - whether to merge with the previous operation of the      
+///      same group, if the text continues it - used for typing               
+void GUIDocument::Insert(Offset offset, std::string_view text, bool merge) {
+   if (text.empty())
+      return;
+
+   DropRedo();
+   offset = std::min(offset, mSize);
+   auto& added = mBuffers[Added];
+   const Offset start = added.mText.size();
+   added.mText.append(text);
+   for (Offset i = 0; i < text.size(); ++i) {
+      if (text[i] == '\n')
+         added.mBreaks.push_back(start + i);
+   }
+
+   // Typed text continues the piece that ends where it was appended,   
+   // so typing extends a single piece instead of adding one per key    
+   const auto piece = MakePiece(Added, start, text.size());
+   const auto pos = Locate(offset);
+   bool extended = false;
+   if (offset and not pos.mInner) {
+      const auto n = pos.mPiece ? pos.mNode : pos.mNode - 1;
+      auto& node = mNodes[n];
+      auto& previous = pos.mPiece ? node.mPieces[pos.mPiece - 1] : node.mPieces.back();
+      if (previous.mBuffer == Added and previous.mStart + previous.mSize == start) {
+         mChanges.push_back({GetLineOf(offset), 0, piece.mBreaks});
+         previous.mSize += piece.mSize;
+         previous.mBreaks += piece.mBreaks;
+         node.mSize += piece.mSize;
+         node.mBreaks += piece.mBreaks;
+         mSize += piece.mSize;
+         mBreaks += piece.mBreaks;
+         ++mVersion;
+         extended = true;
+      }
+   }
+
+   if (not extended)
+      InsertPieces(offset, &piece, 1);
+
+   if (merge and mUndoTop) {
+      auto& last = mUndo.back();
+      if (last.mGroup == mGroup
+      and last.mOffset + last.mAddedSize == offset
+      and (not last.mAddedSize or last.mAddedStart + last.mAddedSize == start)) {
+         if (not last.mAddedSize)
+            last.mAddedStart = start;
+         last.mAddedSize += text.size();
+         return;
+      }
+   }
+
+   mUndo.push_back({offset, start, text.size(),
+      static_cast<uint32_t>(mRemoved.size()), 0, 0, mGroup});
+   ++mUndoTop;
+}
+
+/// Erase text                                                                
+///   @param offset - start of the text                                       
+///   @param size - size of the text                                          
+void GUIDocument::Erase(Offset offset, Count size) {
+   offset = std::min(offset, mSize);
+   size = std::min(size, mSize - offset);
+   if (not size)
+      return;
+
+   DropRedo();
+   const auto first = mRemoved.size();
+   RemovePieces(offset, size, &mRemoved);
+   mUndo.push_back({offset, 0, 0,
+      static_cast<uint32_t>(first),
+      static_cast<uint32_t>(mRemoved.size() - first),
+      size, mGroup});
+   ++mUndoTop;
+}
+
+/// Undo the last group of operations                                         
+///   @param cursor - [out] where the cursor should be after undoing          
+///   @return true if anything was undone                                     
+bool GUIDocument::Undo(Offset& cursor) {
+   if (not mUndoTop)
+      return false;
+
+   const auto group = mUndo[mUndoTop - 1].mGroup;
+   while (mUndoTop and mUndo[mUndoTop - 1].mGroup == group) {
+      const auto& op = mUndo[--mUndoTop];
+      RemovePieces(op.mOffset, op.mAddedSize, nullptr);
+      InsertPieces(op.mOffset, mRemoved.data() + op.mRemovedFirst, op.mRemovedCount);
+      cursor = op.mOffset + op.mRemovedSize;
+   }
+   return true;
+}
+
+/// Redo the last undone group of operations                                  
+///   @param cursor - [out] where the cursor should be after redoing          
+///   @return true if anything was redone                                     
+bool GUIDocument::Redo(Offset& cursor) {
+   if (mUndoTop == mUndo.size())
+      return false;
+
+   const auto group = mUndo[mUndoTop].mGroup;
+   while (mUndoTop < mUndo.size() and mUndo[mUndoTop].mGroup == group) {
+      const auto& op = mUndo[mUndoTop++];
+      RemovePieces(op.mOffset, op.mRemovedSize, nullptr);
+      if (op.mAddedSize) {
+         const auto piece = MakePiece(Added, op.mAddedStart, op.mAddedSize);
+         InsertPieces(op.mOffset, &piece, 1);
+      }
+      cursor = op.mOffset + op.mAddedSize;
+   }
+   return true;
+}
+
+/// Copy a range of text                                                      
+///   @param offset - start of the range                                      
+///   @param size - size of the range                                         
+///   @param out - [out] the text                                             
+void GUIDocument::Read(Offset offset, Count size, std::string& out) const {
+   out.clear();
+   offset = std::min(offset, mSize);
+   size = std::min(size, mSize - offset);
+   out.reserve(size);
+
+   const auto pos = Locate(offset);
+   auto inner = pos.mInner;
+   for (auto n = pos.mNode, p = pos.mPiece; out.size() < size;) {
+      const auto& node = mNodes[n];
+      if (p == node.mPieces.size()) {
+         ++n;
+         p = 0;
+         continue;
+      }
+
+      const auto& piece = node.mPieces[p++];
+      const auto take = std::min(piece.mSize - inner, size - out.size());
+      out.append(mBuffers[piece.mBuffer].mText, piece.mStart + inner, take);
+      inner = 0;
+   }
+}
+
+/// Get a single character                                                    
+///   @param offset - the offset of the character                             
+///   @return the character, or zero past the end                             
+char GUIDocument::At(Offset offset) const noexcept {
+   if (offset >= mSize)
+      return 0;
+
+   const auto pos = Locate(offset);
+   const auto& piece = mNodes[pos.mNode].mPieces[pos.mPiece];
+   return mBuffers[piece.mBuffer].mText[piece.mStart + pos.mInner];
+}
+
+/// Get the offset where a line starts                                        
+///   @param line - the line                                                  
+///   @return the offset of the first character of the line                   
+Offset GUIDocument::GetLineStart(Offset line) const noexcept {
+   if (not line)
+      return 0;
+   if (line > mBreaks)
+      return mSize;
+
+   // Find the piece with the new line that ends the previous line      
+   Count remaining = line;
+   Offset offset = 0;
+   for (const auto& node : mNodes) {
+      if (remaining > node.mBreaks) {
+         remaining -= node.mBreaks;
+         offset += node.mSize;
+         continue;
+      }
+
+      for (const auto& piece : node.mPieces) {
+         if (remaining > piece.mBreaks) {
+            remaining -= piece.mBreaks;
+            offset += piece.mSize;
+            continue;
+         }
+
+         const auto& breaks = mBuffers[piece.mBuffer].mBreaks;
+         const auto first = std::lower_bound(breaks.begin(), breaks.end(), piece.mStart);
+         return offset + (first[remaining - 1] - piece.mStart) + 1;
+      }
+   }
+
+   return mSize;
+}
+
+/// Get the offset where a line ends                                          
+///   @param line - the line                                                  
+///   @return the offset of the new line character, or the document size      
+Offset GUIDocument::GetLineEnd(Offset line) const noexcept {
+   if (line >= mBreaks)
+      return mSize;
+   return GetLineStart(line + 1) - 1;
+}
+
+/// Get the line that contains an offset                                      
+///   @param offset - the offset                                              
+///   @return the line                                                        
+Offset GUIDocument::GetLineOf(Offset offset) const noexcept {
+   offset = std::min(offset, mSize);
+   Offset line = 0;
+   for (const auto& node : mNodes) {
+      if (offset >= node.mSize) {
+         offset -= node.mSize;
+         line += node.mBreaks;
+         continue;
+      }
+
+      for (const auto& piece : node.mPieces) {
+         if (offset >= piece.mSize) {
+            offset -= piece.mSize;
+            line += piece.mBreaks;
+            continue;
+         }
+
+         return line + CountBreaks(piece.mBuffer, piece.mStart, offset);
+      }
+   }
+
+   return line;
+}
+
+/// Get the number of pieces the text is made of                              
+///   @return the number of pieces                                            
+Count GUIDocument::GetPieceCount() const noexcept {
+   Count count = 0;
+   for (const auto& node : mNodes)
+      count += node.mPieces.size();
+   return count;
+}
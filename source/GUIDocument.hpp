@@ -0,0 +1,139 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+///                                                                           
+///   Text document                                                           
+///                                                                           
+/// A piece table - the loaded text is never modified, and everything typed   
+/// is appended to a second buffer. The document is a sequence of pieces,     
+/// spans of either buffer, kept in fixed capacity nodes with cached sizes    
+/// and new line counts, so that finding an offset or a line only walks the   
+/// node totals. New line positions of both buffers are indexed once, as      
+/// text arrives, so line lookups inside a piece are binary searches, and     
+/// editing never rescans the document. Undo is a log of operations that      
+/// refer to spans of the buffers, instead of copies of the text              
+///                                                                           
+struct GUIDocument {
+   /// A change in the line structure, for views that cache per-line data     
+   struct Change {
+      // First line affected by the change                              
+      Offset mLine;
+      // New lines removed and inserted at that line                    
+      Count mRemoved;
+      Count mInserted;
+   };
+
+   // Pieces per node, before the node is split                         
+   static constexpr Count NodeCapacity = 128;
+
+private:
+   enum BufferId : uint8_t {
+      Original,
+      Added
+   };
+
+   /// A span of text in one of the buffers                                   
+   struct Piece {
+      BufferId mBuffer;
+      Offset mStart;
+      Count mSize;
+      // Number of new lines inside the span                            
+      Count mBreaks;
+   };
+
+   struct Buffer {
+      std::string mText;
+      // Offsets of all new lines in the text, in ascending order       
+      std::vector<Offset> mBreaks;
+   };
+
+   struct Node {
+      std::vector<Piece> mPieces;
+      Count mSize {};
+      Count mBreaks {};
+   };
+
+   /// Where an offset is inside the nodes                                    
+   struct Position {
+      Offset mNode;
+      Offset mPiece;
+      Offset mInner;
+   };
+
+   /// A single edit - a removal followed by an insertion at one offset       
+   struct Operation {
+      Offset mOffset;
+      // Inserted text, always a span of the added buffer               
+      Offset mAddedStart;
+      Count mAddedSize;
+      // Removed text, as the pieces it was made of                     
+      uint32_t mRemovedFirst;
+      uint32_t mRemovedCount;
+      Count mRemovedSize;
+      // Operations of the same group are undone together               
+      uint32_t mGroup;
+   };
+
+   Buffer mBuffers[2];
+   std::vector<Node> mNodes {1};
+   Count mSize {};
+   Count mBreaks {};
+
+   // The undo log, operations past mUndoTop were undone and can be     
+   // redone, until the next edit                                       
+   std::vector<Operation> mUndo;
+   Count mUndoTop {};
+   std::vector<Piece> mRemoved;
+   uint32_t mGroup {};
+
+   std::vector<Change> mChanges;
+   Count mVersion {};
+
+   NOD() Count CountBreaks(BufferId, Offset start, Count size) const noexcept;
+   NOD() Piece MakePiece(BufferId, Offset start, Count size) const noexcept;
+   NOD() Position Locate(Offset) const noexcept;
+   Position Split(Offset);
+   void SplitNode(Offset node);
+   void InsertPieces(Offset, const Piece*, Count);
+   void RemovePieces(Offset, Count, std::vector<Piece>*);
+   void DropRedo();
+
+public:
+   void Assign(std::string&&);
+   void Insert(Offset, std::string_view, bool merge = false);
+   void Erase(Offset, Count);
+   void BeginGroup() noexcept { ++mGroup; }
+   NOD() bool Undo(Offset& cursor);
+   NOD() bool Redo(Offset& cursor);
+
+   void Read(Offset, Count, std::string&) const;
+   NOD() char At(Offset) const noexcept;
+   NOD() Offset GetLineStart(Offset line) const noexcept;
+   NOD() Offset GetLineEnd(Offset line) const noexcept;
+   NOD() Offset GetLineOf(Offset) const noexcept;
+
+   NOD() Count GetSize() const noexcept { return mSize; }
+   NOD() Count GetLineCount() const noexcept { return mBreaks + 1; }
+   NOD() Count GetPieceCount() const noexcept;
+   NOD() Count GetNodeCount() const noexcept { return mNodes.size(); }
+   NOD() Count GetVersion() const noexcept { return mVersion; }
+   NOD() bool CanUndo() const noexcept { return mUndoTop > 0; }
+   NOD() bool CanRedo() const noexcept { return mUndoTop < mUndo.size(); }
+   NOD() Count GetUndoBytes() const noexcept {
+      return mUndo.size() * sizeof(Operation) + mRemoved.size() * sizeof(Piece);
+   }
+
+   NOD() auto& GetChanges() const noexcept { return mChanges; }
+   void ClearChanges() noexcept { mChanges.clear(); }
+};
@@ -0,0 +1,505 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIEditor.hpp"
+#include "GUI.hpp"
+#include <charconv>
+
+
+/// Check if a byte continues a multi-byte UTF-8 character                    
+///   @param c - the byte                                                     
+///   @return true if the byte isn't the start of a character                 
+inline bool IsContinuation(char c) noexcept {
+   return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+/// Encode a character as UTF-8                                               
+///   @param c - the character                                                
+///   @param out - [out] at least four bytes                                  
+///   @return the number of bytes written                                     
+inline int EncodeUTF8(unsigned c, char* out) noexcept {
+   if (c < 0x80) {
+      out[0] = static_cast<char>(c);
+      return 1;
+   }
+   if (c < 0x800) {
+      out[0] = static_cast<char>(0xC0 | (c >> 6));
+      out[1] = static_cast<char>(0x80 | (c & 0x3F));
+      return 2;
+   }
+   if (c < 0x10000) {
+      out[0] = static_cast<char>(0xE0 | (c >> 12));
+      out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      out[2] = static_cast<char>(0x80 | (c & 0x3F));
+      return 3;
+   }
+   out[0] = static_cast<char>(0xF0 | (c >> 18));
+   out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+   out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+   out[3] = static_cast<char>(0x80 | (c & 0x3F));
+   return 4;
+}
+
+/// Replace the text, forgetting the undo log                                 
+///   @param text - the new text                                              
+void GUIEditor::SetText(std::string&& text) {
+   mDocument.Assign(std::move(text));
+   mCursor = mAnchor = mColumn = 0;
+   mWidest = 0;
+   mRows.clear();
+   Invalidate();
+}
+
+/// Replace the text with the elements of a container, one per line           
+///   @param data - the lines                                                 
+void GUIEditor::SetData(const Many& data) {
+   std::string text;
+   for (Offset i = 0; i < data.GetCount(); ++i) {
+      const auto line = data.GetElement(i).template AsCast<Text>();
+      if (i)
+         text += '\n';
+      text.append(line.GetRaw(), line.GetCount());
+   }
+   SetText(std::move(text));
+}
+
+/// Drop the cached layouts of the lines changed since the last frame, and    
+/// move the ones below them along with their lines                           
+void GUIEditor::Invalidate() {
+   for (const auto& change : mDocument.GetChanges()) {
+      std::erase_if(mLayouts, [&](const Layout& layout) {
+         return layout.mLine >= change.mLine
+            and layout.mLine <= change.mLine + change.mRemoved;
+      });
+
+      for (auto& layout : mLayouts) {
+         if (layout.mLine > change.mLine)
+            layout.mLine = layout.mLine + change.mInserted - change.mRemoved;
+      }
+   }
+
+   mDocument.ClearChanges();
+}
+
+/// Get the wrapped layout of a line, laying it out if it isn't cached        
+///   @param line - the line, its text has to be in mLine                     
+///   @param width - the width to wrap at                                     
+///   @return the layout                                                      
+const GUIEditor::Layout& GUIEditor::GetLayout(Offset line, float width) {
+   auto found = std::lower_bound(mLayouts.begin(), mLayouts.end(), line,
+      [](const Layout& layout, Offset line) { return layout.mLine < line; });
+   if (found != mLayouts.end() and found->mLine == line)
+      return *found;
+
+   if (mLayouts.size() >= CacheCapacity) {
+      mLayouts.clear();
+      found = mLayouts.end();
+   }
+
+   // Spaces at a wrap stay at the end of the row, so that the cursor   
+   // can still be placed on them                                       
+   Layout layout {line, {}};
+   const auto font = ImGui::GetFont();
+   const float scale = ImGui::GetFontSize() / font->FontSize;
+   const char* const begin = mLine.data();
+   const auto end = begin + mLine.size();
+   for (auto row = begin; row < end;) {
+      auto next = font->CalcWordWrapPositionA(scale, row, end, width);
+      if (next == row)
+         ++next;
+      while (next < end and (*next == ' ' or *next == '\t'))
+         ++next;
+      while (next < end and IsContinuation(*next))
+         ++next;
+      if (next >= end)
+         break;
+
+      layout.mRows.push_back(static_cast<uint32_t>(next - begin));
+      row = next;
+   }
+
+   ++mMeasuredLines;
+   return *mLayouts.insert(found, std::move(layout));
+}
+
+/// Get the start of the character before an offset                           
+///   @param offset - the offset                                              
+///   @return the offset of the previous character                            
+Offset GUIEditor::Previous(Offset offset) const noexcept {
+   while (offset and IsContinuation(mDocument.At(--offset)));
+   return offset;
+}
+
+/// Get the start of the character after an offset                            
+///   @param offset - the offset                                              
+///   @return the offset of the next character                                
+Offset GUIEditor::Next(Offset offset) const noexcept {
+   const auto size = mDocument.GetSize();
+   if (offset < size)
+      ++offset;
+   while (offset < size and IsContinuation(mDocument.At(offset)))
+      ++offset;
+   return offset;
+}
+
+/// Find the character under a point, using the rows of the last frame        
+///   @param at - the point, relative to the content                          
+///   @return the offset of the character                                     
+Offset GUIEditor::HitTest(ImVec2 at) {
+   if (mRows.empty())
+      return mCursor;
+
+   auto row = std::upper_bound(mRows.begin(), mRows.end(), at.y,
+      [](float y, const Row& row) { return y < row.mY; });
+   if (row != mRows.begin())
+      --row;
+
+   // The character is picked by the middle of its glyph                
+   mDocument.Read(row->mStart, row->mEnd - row->mStart, mLine);
+   const auto font = ImGui::GetFont();
+   const float size = ImGui::GetFontSize();
+   const float x = at.x - mGutter;
+   const char* const begin = mLine.data();
+   const auto end = begin + mLine.size();
+   float left = 0;
+   for (auto it = begin; it < end;) {
+      auto next = it + 1;
+      while (next < end and IsContinuation(*next))
+         ++next;
+
+      const float right = font->CalcTextSizeA(size, FLT_MAX, 0, begin, next).x;
+      if (x < (left + right) * 0.5f)
+         return row->mStart + (it - begin);
+      left = right;
+      it = next;
+   }
+
+   return row->mEnd;
+}
+
+/// Move the cursor                                                           
+///   @param offset - the new place of the cursor                             
+///   @param select - whether to keep the other end of the selection          
+void GUIEditor::MoveTo(Offset offset, bool select) {
+   mCursor = std::min(offset, mDocument.GetSize());
+   if (not select)
+      mAnchor = mCursor;
+   mColumn = mCursor - mDocument.GetLineStart(mDocument.GetLineOf(mCursor));
+   mTyping = false;
+   mScrollToCursor = true;
+}
+
+/// Move the cursor up or down, keeping its column                            
+///   @param lines - number of lines to move, negative to move up             
+///   @param select - whether to keep the other end of the selection          
+void GUIEditor::MoveLines(long long lines, bool select) {
+   const auto last = static_cast<long long>(mDocument.GetLineCount()) - 1;
+   const auto line = std::clamp(
+      static_cast<long long>(mDocument.GetLineOf(mCursor)) + lines, 0LL, last);
+   const auto start = mDocument.GetLineStart(line);
+   auto offset = std::min(start + mColumn, mDocument.GetLineEnd(line));
+   while (offset > start and IsContinuation(mDocument.At(offset)))
+      --offset;
+
+   const auto column = mColumn;
+   MoveTo(offset, select);
+   mColumn = column;
+}
+
+/// Replace the selection with text                                           
+///   @param text - the text                                                  
+///   @param typed - whether the text was typed, so that it's undone          
+///      together with the text typed before it                               
+void GUIEditor::Replace(std::string_view text, bool typed) {
+   if (mReadOnly)
+      return;
+
+   const auto begin = GetSelectionBegin();
+   const auto end = GetSelectionEnd();
+   if (not typed or not mTyping or begin != end)
+      mDocument.BeginGroup();
+
+   mDocument.Erase(begin, end - begin);
+   mDocument.Insert(begin, text, typed);
+   MoveTo(begin + text.size(), false);
+   mTyping = typed;
+}
+
+/// Remove text, or the selection if there is one                             
+///   @param begin - start of the text                                        
+///   @param end - end of the text                                            
+void GUIEditor::Remove(Offset begin, Offset end) {
+   if (mCursor != mAnchor) {
+      begin = GetSelectionBegin();
+      end = GetSelectionEnd();
+   }
+
+   if (mReadOnly or begin == end)
+      return;
+
+   mDocument.BeginGroup();
+   mDocument.Erase(begin, end - begin);
+   MoveTo(begin, false);
+}
+
+/// Copy the selection to the clipboard                                       
+void GUIEditor::Copy() {
+   if (mCursor == mAnchor)
+      return;
+
+   std::string text;
+   mDocument.Read(GetSelectionBegin(), GetSelectionEnd() - GetSelectionBegin(), text);
+   ImGui::SetClipboardText(text.c_str());
+}
+
+/// React on the keyboard, while the editor is focused                        
+void GUIEditor::HandleKeyboard() {
+   const auto& io = ImGui::GetIO();
+   const bool shift = io.KeyShift;
+   // AltGr is reported as Ctrl+Alt on some platforms, and it types     
+   // characters instead of triggering shortcuts                        
+   const bool ctrl = io.KeyCtrl and not io.KeyAlt;
+   const bool selected = mCursor != mAnchor;
+   const auto pressed = [](ImGuiKey key) {
+      return ImGui::IsKeyPressed(key);
+   };
+
+   if (ctrl and pressed(ImGuiKey_A)) {
+      mAnchor = 0;
+      MoveTo(mDocument.GetSize(), true);
+   }
+   else if (ctrl and pressed(ImGuiKey_C))
+      Copy();
+   else if (ctrl and pressed(ImGuiKey_X)) {
+      Copy();
+      Replace({});
+   }
+   else if (ctrl and pressed(ImGuiKey_V)) {
+      if (const auto text = ImGui::GetClipboardText())
+         Replace(text);
+   }
+   else if (ctrl and (pressed(ImGuiKey_Y) or (shift and pressed(ImGuiKey_Z)))) {
+      Offset cursor = mCursor;
+      if (not mReadOnly and mDocument.Redo(cursor))
+         MoveTo(cursor, false);
+   }
+   else if (ctrl and pressed(ImGuiKey_Z)) {
+      Offset cursor = mCursor;
+      if (not mReadOnly and mDocument.Undo(cursor))
+         MoveTo(cursor, false);
+   }
+   else if (pressed(ImGuiKey_LeftArrow))
+      MoveTo(selected and not shift ? GetSelectionBegin() : Previous(mCursor), shift);
+   else if (pressed(ImGuiKey_RightArrow))
+      MoveTo(selected and not shift ? GetSelectionEnd() : Next(mCursor), shift);
+   else if (pressed(ImGuiKey_UpArrow))
+      MoveLines(-1, shift);
+   else if (pressed(ImGuiKey_DownArrow))
+      MoveLines(1, shift);
+   else if (pressed(ImGuiKey_PageUp))
+      MoveLines(-static_cast<long long>(mPageLines), shift);
+   else if (pressed(ImGuiKey_PageDown))
+      MoveLines(static_cast<long long>(mPageLines), shift);
+   else if (pressed(ImGuiKey_Home))
+      MoveTo(ctrl ? 0 : mDocument.GetLineStart(mDocument.GetLineOf(mCursor)), shift);
+   else if (pressed(ImGuiKey_End))
+      MoveTo(ctrl ? mDocument.GetSize() : mDocument.GetLineEnd(mDocument.GetLineOf(mCursor)), shift);
+   else if (pressed(ImGuiKey_Backspace))
+      Remove(Previous(mCursor), mCursor);
+   else if (pressed(ImGuiKey_Delete))
+      Remove(mCursor, Next(mCursor));
+   else if (pressed(ImGuiKey_Enter) or pressed(ImGuiKey_KeypadEnter))
+      Replace("\n");
+   else if (pressed(ImGuiKey_Tab))
+      Replace("\t");
+
+   if (ctrl)
+      return;
+
+   for (const auto c : io.InputQueueCharacters) {
+      if (c < 32 or c == 127)
+         continue;
+
+      char utf8[4];
+      Replace({utf8, static_cast<size_t>(EncodeUTF8(c, utf8))}, true);
+   }
+}
+
+/// React on the mouse - clicking places the cursor, dragging selects         
+///   @param origin - screen position of the content                          
+void GUIEditor::HandleMouse(ImVec2 origin) {
+   const auto& io = ImGui::GetIO();
+   const ImVec2 at {io.MousePos.x - origin.x, io.MousePos.y - origin.y};
+
+   // Clicks on the scrollbars make them active, and are left to them   
+   if (ImGui::IsWindowHovered() and not ImGui::IsAnyItemActive()
+   and ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+      MoveTo(HitTest(at), io.KeyShift);
+      mDragging = true;
+   }
+   else if (mDragging) {
+      if (ImGui::IsMouseDown(ImGuiMouseButton_Left))
+         MoveTo(HitTest(at), true);
+      else
+         mDragging = false;
+   }
+}
+
+/// Scroll so that the cursor is visible                                      
+void GUIEditor::ScrollToCursor() {
+   mScrollToCursor = false;
+   const auto line = mDocument.GetLineOf(mCursor);
+   const float top = line * mLineHeight;
+   const float height = ImGui::GetWindowHeight();
+   if (top < ImGui::GetScrollY())
+      ImGui::SetScrollY(top);
+   else if (top + mLineHeight > ImGui::GetScrollY() + height)
+      ImGui::SetScrollY(top + mLineHeight - height);
+
+   if (mWrap)
+      return;
+
+   // Only the part of the line before the cursor is measured           
+   const auto start = mDocument.GetLineStart(line);
+   mDocument.Read(start, std::min<Count>(mCursor - start, MaxLineBytes), mLine);
+   const float x = ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(),
+      FLT_MAX, 0, mLine.data(), mLine.data() + mLine.size()).x;
+   const float width = ImGui::GetWindowWidth() - mGutter;
+   if (x < ImGui::GetScrollX())
+      ImGui::SetScrollX(x);
+   else if (x + mLineHeight > ImGui::GetScrollX() + width)
+      ImGui::SetScrollX(x + mLineHeight - width);
+}
+
+/// Draw the visible lines, starting with the one at the top of the view      
+/// Wrapped lines push the following ones down, so a line is always at the    
+/// top, and the scrollbar doesn't depend on the heights of other lines       
+///   @param origin - screen position of the content                          
+void GUIEditor::Render(ImVec2 origin) {
+   const auto font = ImGui::GetFont();
+   const float fontSize = ImGui::GetFontSize();
+   const float height = ImGui::GetWindowHeight();
+   const float scroll = ImGui::GetScrollY();
+   const float wrapWidth = std::max(ImGui::GetContentRegionAvail().x - mGutter, fontSize);
+   if (mWrap and (wrapWidth != mLayoutWidth or fontSize != mLayoutFontSize)) {
+      mLayouts.clear();
+      mLayoutWidth = wrapWidth;
+      mLayoutFontSize = fontSize;
+   }
+
+   auto draw = ImGui::GetWindowDrawList();
+   const auto textColor = ImGui::GetColorU32(ImGuiCol_Text);
+   const auto numberColor = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+   const auto selectColor = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+   const bool focused = ImGui::IsWindowFocused();
+   const float space = font->CalcTextSizeA(fontSize, FLT_MAX, 0, " ").x;
+   const auto selBegin = GetSelectionBegin();
+   const auto selEnd = GetSelectionEnd();
+   const auto lines = mDocument.GetLineCount();
+
+   mRows.clear();
+   mSubmittedLines = 0;
+   auto line = std::min<Offset>(static_cast<Offset>(scroll / mLineHeight), lines - 1);
+   float y = line * mLineHeight;
+   for (; line < lines and y < scroll + height; ++line) {
+      const auto start = mDocument.GetLineStart(line);
+      const auto end = mDocument.GetLineEnd(line);
+      mDocument.Read(start, std::min<Count>(end - start, MaxLineBytes), mLine);
+      const auto text = mLine.data();
+      const auto size = mLine.size();
+
+      char number[24];
+      const auto written = std::to_chars(number, number + sizeof(number), line + 1).ptr;
+      const float numberWidth = font->CalcTextSizeA(fontSize, FLT_MAX, 0, number, written).x;
+      draw->AddText(font, fontSize, {origin.x + mGutter - space - numberWidth, origin.y + y},
+         numberColor, number, written);
+
+      const Layout* layout = mWrap ? &GetLayout(line, wrapWidth) : nullptr;
+      const Count rows = layout ? layout->mRows.size() + 1 : 1;
+      for (Offset r = 0; r < rows; ++r) {
+         const Offset rowBegin = r ? layout->mRows[r - 1] : 0;
+         const Offset rowEnd = r + 1 < rows ? layout->mRows[r] : size;
+         const bool last = r + 1 == rows;
+         const ImVec2 pos {origin.x + mGutter, origin.y + y};
+         const auto measure = [&](Offset at) {
+            return font->CalcTextSizeA(fontSize, FLT_MAX, 0,
+               text + rowBegin, text + at).x;
+         };
+
+         // Selected new lines are shown as a space after the row       
+         const auto a = std::max(selBegin, start + rowBegin);
+         const auto b = std::min(selEnd, start + rowEnd);
+         if (a < b or (last and selBegin <= end and selEnd > end)) {
+            const float left = a < b ? measure(a - start) : measure(rowEnd);
+            float right = a < b ? measure(b - start) : left;
+            if (last and selEnd > end and selBegin <= end)
+               right += space;
+            draw->AddRectFilled({pos.x + left, pos.y},
+               {pos.x + right, pos.y + mLineHeight}, selectColor);
+         }
+
+         draw->AddText(font, fontSize, pos, textColor, text + rowBegin, text + rowEnd);
+         if (not mWrap)
+            mWidest = std::max(mWidest, measure(rowEnd));
+
+         if (focused and mCursor >= start + rowBegin
+         and (mCursor < start + rowEnd or (last and mCursor <= end))) {
+            const float x = pos.x + measure(std::min(mCursor - start, rowEnd));
+            draw->AddLine({x, pos.y}, {x, pos.y + mLineHeight}, textColor);
+         }
+
+         mRows.push_back({start + rowBegin, start + rowEnd, y});
+         y += mLineHeight;
+      }
+
+      ++mSubmittedLines;
+   }
+}
+
+/// Submit the visible lines of the editor, and react on input                
+///   @param item - the item that owns the editor                             
+void GUIEditor::Submit(GUIItem& item) {
+   mMeasuredLines = 0;
+   ImGui::PushID(this);
+
+   const auto flags = ImGuiWindowFlags_NoNavInputs
+      | (mWrap ? ImGuiWindowFlags_None : ImGuiWindowFlags_HorizontalScrollbar);
+   if (ImGui::BeginChild("##editor", item.GetRequestedSize(), false, flags)) {
+      const auto font = ImGui::GetFont();
+      const float fontSize = ImGui::GetFontSize();
+      const auto origin = ImGui::GetCursorScreenPos();
+      const float height = ImGui::GetWindowHeight();
+      mLineHeight = ImGui::GetTextLineHeight();
+      mPageLines = std::max<Count>(1, static_cast<Count>(height / mLineHeight) - 1);
+
+      // Room for the widest line number, and a space on each side      
+      Count digits = 1;
+      for (auto lines = mDocument.GetLineCount(); lines >= 10; lines /= 10)
+         ++digits;
+      mGutter = font->CalcTextSizeA(fontSize, FLT_MAX, 0, "0").x * (digits + 2);
+
+      if (ImGui::IsWindowFocused()) {
+         ImGui::SetNextFrameWantCaptureKeyboard(true);
+         HandleKeyboard();
+      }
+      HandleMouse(origin);
+      Invalidate();
+
+      if (mScrollToCursor)
+         ScrollToCursor();
+      Render(origin);
+
+      // Reserve the full size, so that the scrollbars are correct - when
+      // wrapping, the last line can be scrolled to the top, whatever the
+      // heights of the lines before it                                 
+      const float total = mDocument.GetLineCount() * mLineHeight
+         + (mWrap ? std::max(height - mLineHeight, 0.0f) : 0.0f);
+      ImGui::Dummy({mWrap ? 0.0f : mGutter + mWidest, total});
+   }
+   ImGui::EndChild();
+   ImGui::PopID();
+}
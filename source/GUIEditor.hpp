@@ -0,0 +1,110 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIWidget.hpp"
+#include "GUIDocument.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+///                                                                           
+///   Large text editor                                                       
+///                                                                           
+/// Edits a GUIDocument, so that the text is never copied into a flat         
+/// buffer and never rescanned. Only the visible lines are read from the      
+/// document, laid out and drawn, so the cost of a keystroke doesn't depend   
+/// on the size of the text. Wrapped layouts of lines are cached, and only    
+/// the lines touched by an edit are laid out again. Scrolling is in whole    
+/// lines, so that the scrollbar never needs the height of every line         
+///                                                                           
+struct GUIEditor final : GUIWidget {
+   // Lines longer than this are displayed clipped                      
+   static constexpr Count MaxLineBytes = 16384;
+   // Wrapped layouts kept, the cache is dropped when it fills up       
+   static constexpr Count CacheCapacity = 4096;
+
+private:
+   /// Wrapped layout of a line                                               
+   struct Layout {
+      Offset mLine;
+      // Starts of the rows after the first one, relative to the line   
+      std::vector<uint32_t> mRows;
+   };
+
+   /// A row drawn in the last frame, for mapping the mouse to the text       
+   struct Row {
+      Offset mStart;
+      Offset mEnd;
+      // Top of the row, relative to the content                        
+      float mY;
+   };
+
+   GUIDocument mDocument;
+
+   // The cursor, and the other end of the selection                    
+   Offset mCursor {};
+   Offset mAnchor {};
+   // Column the cursor returns to, when moving between lines           
+   Offset mColumn {};
+
+   bool mWrap {};
+   bool mReadOnly {};
+   // Whether the last edit was typing, so that typing is undone at once
+   bool mTyping {};
+   bool mDragging {};
+   bool mScrollToCursor {};
+
+   std::vector<Layout> mLayouts;
+   float mLayoutWidth {-1};
+   float mLayoutFontSize {};
+   std::vector<Row> mRows;
+   // Reused for the text of each submitted line                        
+   std::string mLine;
+
+   // Widest line drawn so far, for the horizontal scrollbar            
+   float mWidest {};
+   float mGutter {};
+   float mLineHeight {1};
+   Count mPageLines {1};
+
+   // Statistics of the last frame                                      
+   Count mSubmittedLines {};
+   Count mMeasuredLines {};
+
+   void Invalidate();
+   NOD() const Layout& GetLayout(Offset line, float width);
+   NOD() Offset Previous(Offset) const noexcept;
+   NOD() Offset Next(Offset) const noexcept;
+   NOD() Offset HitTest(ImVec2);
+   void MoveTo(Offset, bool select);
+   void MoveLines(long long lines, bool select);
+   void Replace(std::string_view, bool typed = false);
+   void Remove(Offset, Offset);
+   void Copy();
+   void HandleKeyboard();
+   void HandleMouse(ImVec2 origin);
+   void ScrollToCursor();
+   void Render(ImVec2 origin);
+
+public:
+   void SetText(std::string&&);
+   void SetData(const Many&) override;
+   void Submit(GUIItem&) override;
+
+   void SetWrap(bool wrap) noexcept { mWrap = wrap; }
+   void SetReadOnly(bool readOnly) noexcept { mReadOnly = readOnly; }
+
+   NOD() auto& GetDocument() const noexcept { return mDocument; }
+   NOD() Offset GetCursor() const noexcept { return mCursor; }
+   NOD() Offset GetSelectionBegin() const noexcept { return std::min(mCursor, mAnchor); }
+   NOD() Offset GetSelectionEnd() const noexcept { return std::max(mCursor, mAnchor); }
+   NOD() Count GetSubmittedLines() const noexcept { return mSubmittedLines; }
+   NOD() Count GetMeasuredLines() const noexcept { return mMeasuredLines; }
+   NOD() Count GetCachedLayouts() const noexcept { return mLayouts.size(); }
+};
@@ -114,7 +114,11 @@ struct ImFontConfig {
 
    // Store atlas and identifier                                        
    mAtlas = RunIn(createTexture)->As<A::Image*>();
-   io->SetTexID(mAtlas->GetGPUHandle());
+   io->SetTexID(producer->GetTextures().Register(mAtlas.Get()));
+
+   // Glyph metrics and UVs might have changed with the atlas, so any   
+   // cached text measurements and recorded geometry are stale          
+   producer->FontsChanged();
 
 
    //ImGui_ImplVulkan_CreateFontsTexture(command_buffer);
@@ -240,4 +244,9 @@ struct ImFontConfig {
       io->SetTexID((ImTextureID)bd->FontDescriptorSet);*/
    }
    VERBOSE_GUI("Initialized");
-}
\ No newline at end of file
+}
+
+/// GUI font destruction                                                      
+GUIFont::~GUIFont() {
+   mProducer->GetTextures().Release(mAtlas.Get());
+}
@@ -23,6 +23,7 @@ private:
 
 public:
    GUIFont(GUISystem*, Describe);
+   ~GUIFont();
 
    void Refresh() {}
 };
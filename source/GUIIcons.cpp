@@ -0,0 +1,309 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIIcons.hpp"
+#include "GUI.hpp"
+#include <Langulus/Image.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+
+/// Icon atlas destruction                                                    
+GUIIcons::~GUIIcons() {
+   for (auto& page : mPages)
+      mSystem->GetTextures().Release(page->mImage.Get());
+}
+
+/// Find the lowest place on a page's skyline, where a rectangle fits         
+///   @param page - the page to search                                        
+///   @param width - width of the rectangle, including padding                
+///   @param height - height of the rectangle, including padding              
+///   @param x - [out] left of the place                                      
+///   @param y - [out] top of the place                                       
+///   @return true if the rectangle fits                                      
+bool GUIIcons::Fit(const Page& page, int width, int height, int& x, int& y) noexcept {
+   const auto& skyline = page.mSkyline;
+   int best = INT_MAX;
+   for (size_t i = 0; i < skyline.size(); ++i) {
+      const int left = skyline[i].mX;
+      if (left + width > PageSize)
+         break;
+
+      // The rectangle rests on the highest segment below it            
+      int top = 0;
+      int remaining = width;
+      for (size_t j = i; remaining > 0; ++j) {
+         top = std::max(top, skyline[j].mY);
+         remaining -= skyline[j].mWidth;
+      }
+
+      if (top + height <= PageSize and top < best) {
+         best = top;
+         x = left;
+         y = top;
+      }
+   }
+
+   return best != INT_MAX;
+}
+
+/// Raise the skyline of a page over a placed rectangle                       
+///   @param page - the page                                                  
+///   @param x - left of the rectangle, always at the start of a segment      
+///   @param y - top of the rectangle                                         
+///   @param width - width of the rectangle                                   
+///   @param height - height of the rectangle                                 
+void GUIIcons::Place(Page& page, int x, int y, int width, int height) {
+   auto& skyline = page.mSkyline;
+   auto at = std::find_if(skyline.begin(), skyline.end(),
+      [x](const Segment& s) { return s.mX == x; });
+   at = skyline.insert(at, {x, y + height, width});
+
+   // Segments under the rectangle are shortened or removed             
+   const int right = x + width;
+   auto next = at + 1;
+   while (next != skyline.end() and next->mX < right) {
+      const int overlap = right - next->mX;
+      if (next->mWidth > overlap) {
+         next->mX += overlap;
+         next->mWidth -= overlap;
+         break;
+      }
+      next = skyline.erase(next);
+   }
+
+   // Neighbours at the same height are merged                          
+   for (size_t i = 0; i + 1 < skyline.size();) {
+      if (skyline[i].mY == skyline[i + 1].mY) {
+         skyline[i].mWidth += skyline[i + 1].mWidth;
+         skyline.erase(skyline.begin() + i + 1);
+      }
+      else ++i;
+   }
+}
+
+/// Pack an image into a page, and schedule copying it there                  
+///   @param page - the page to pack into                                     
+///   @param entry - [in/out] the icon, its image and size have to be set     
+///   @return true if the image fit in the page                               
+bool GUIIcons::Insert(Page& page, Entry& entry) {
+   int x, y;
+   if (not Fit(page, entry.mWidth + Padding, entry.mHeight + Padding, x, y))
+      return false;
+
+   Place(page, x, y, entry.mWidth + Padding, entry.mHeight + Padding);
+   page.mUsedArea += (entry.mWidth + Padding) * (entry.mHeight + Padding);
+   ++page.mIcons;
+
+   constexpr float Texel = 1.0f / PageSize;
+   entry.mPage = &page;
+   entry.mX = x;
+   entry.mY = y;
+   entry.mIcon = {
+      page.mTexture,
+      {x * Texel, y * Texel},
+      {(x + entry.mWidth) * Texel, (y + entry.mHeight) * Texel}
+   };
+
+   mBlits.push_back({entry.mImage, page.mImage.Get(), x, y, entry.mWidth, entry.mHeight});
+   return true;
+}
+
+/// Create a new atlas page                                                   
+///   @return the page, or nullptr if there are too many pages already        
+GUIIcons::Page* GUIIcons::AddPage() {
+   if (mPages.size() >= MaxPages)
+      return nullptr;
+
+   auto page = std::make_unique<Page>();
+   page->mImage = mSystem->CreateImage({PageSize, PageSize});
+   page->mTexture = mSystem->GetTextures().Register(page->mImage.Get());
+   page->mSkyline.push_back({0, 0, PageSize});
+   mPages.emplace_back(std::move(page));
+   return mPages.back().get();
+}
+
+/// Pack a page from scratch, reclaiming the space of evicted icons           
+/// Icons are reinserted from the tallest, which packs skylines tightly       
+///   @param page - the page to repack                                        
+void GUIIcons::Repack(Page& page) {
+   std::vector<std::pair<const A::Image*, Entry*>> icons;
+   icons.reserve(page.mIcons);
+   for (auto& [image, entry] : mEntries) {
+      if (entry.mPage == &page)
+         icons.emplace_back(image, &entry);
+   }
+
+   std::sort(icons.begin(), icons.end(), [](const auto& a, const auto& b) {
+      return a.second->mHeight > b.second->mHeight;
+   });
+
+   // Pending copies into the page are for the old places               
+   std::erase_if(mBlits, [&](const Blit& blit) {
+      return blit.mPage == page.mImage.Get();
+   });
+
+   page.mSkyline.assign(1, {0, 0, PageSize});
+   page.mUsedArea = page.mWastedArea = 0;
+   page.mIcons = 0;
+   for (auto& [image, entry] : icons) {
+      // Icons only ever fit better after eviction                      
+      if (not Insert(page, *entry))
+         mEntries.erase(image);
+   }
+
+   ++mRepacks;
+}
+
+/// Forget an icon, its space is reclaimed on the next repack                 
+///   @param entry - the icon                                                 
+void GUIIcons::Evict(Entry& entry) {
+   auto& page = *entry.mPage;
+   const auto area = static_cast<Count>(
+      (entry.mWidth + Padding) * (entry.mHeight + Padding));
+   page.mUsedArea -= area;
+   page.mWastedArea += area;
+   --page.mIcons;
+   ++mEvictions;
+}
+
+/// Get an image from the atlas, packing it if it isn't there yet             
+/// The result is valid until EndFrame                                        
+///   @param image - the image, referenced while it's in the atlas            
+///   @param size - size of the image in pixels                               
+///   @return the icon, or nullptr if the image has to be drawn on its own    
+const GUIIcons::Icon* GUIIcons::Use(A::Image* image, ImVec2 size) {
+   const int width = static_cast<int>(std::ceil(size.x));
+   const int height = static_cast<int>(std::ceil(size.y));
+   if (not image or width <= 0 or height <= 0
+   or width > MaxSize or height > MaxSize)
+      return nullptr;
+
+   auto found = mEntries.find(image);
+   if (found != mEntries.end()
+   and (found->second.mWidth != width or found->second.mHeight != height)) {
+      // The image was resized, so it's packed again                    
+      Evict(found->second);
+      mEntries.erase(found);
+      found = mEntries.end();
+   }
+
+   if (found == mEntries.end()) {
+      Entry entry {};
+      entry.mImage = image;
+      entry.mWidth = width;
+      entry.mHeight = height;
+
+      // Try the existing pages, then create a new page. Icons drawn    
+      // this frame can't move, so evicted space is only reclaimed on   
+      // the next frame                                                 
+      const auto needed = static_cast<Count>((width + Padding) * (height + Padding));
+      bool packed = false;
+      for (auto& page : mPages) {
+         if ((packed = Insert(*page, entry)))
+            break;
+      }
+
+      for (auto& page : mPages) {
+         if (packed or mRepack)
+            break;
+         if (page->mWastedArea >= needed)
+            mRepack = page.get();
+      }
+
+      if (not packed) {
+         const auto page = AddPage();
+         if (not page or not Insert(*page, entry))
+            return nullptr;
+      }
+
+      found = mEntries.emplace(image, entry).first;
+   }
+
+   auto& entry = found->second;
+   entry.mUsed = mFrame;
+   ++mDrawnIcons;
+   if (entry.mPage->mDrawn != mFrame) {
+      entry.mPage->mDrawn = mFrame;
+      ++mDrawnPages;
+   }
+   return &entry.mIcon;
+}
+
+/// Remove an image from the atlas, releasing it before it would be evicted   
+///   @param image - the image                                                
+void GUIIcons::Remove(const A::Image* image) {
+   const auto found = mEntries.find(image);
+   if (found == mEntries.end())
+      return;
+
+   std::erase_if(mBlits, [image](const Blit& blit) {
+      return blit.mSource.Get() == image;
+   });
+   Evict(found->second);
+   mEntries.erase(found);
+}
+
+/// Repack the page chosen in the previous frame                              
+/// Called at the start of a UI frame, before anything is submitted, when     
+/// the renderer no longer draws the previous frame's texture coordinates.    
+/// Recorded geometry and captured layers still refer to them, so they are    
+/// discarded                                                                 
+void GUIIcons::BeginFrame() {
+   if (not mRepack)
+      return;
+
+   Repack(*mRepack);
+   mRepack = nullptr;
+   mSystem->IconsMoved();
+}
+
+/// Evict icons that weren't drawn for a while, release the pages they        
+/// leave empty, and pick a page to repack - called once per UI frame         
+void GUIIcons::EndFrame() {
+   for (auto it = mEntries.begin(); it != mEntries.end();) {
+      if (mFrame - it->second.mUsed > EvictFrames) {
+         Evict(it->second);
+         it = mEntries.erase(it);
+      }
+      else ++it;
+   }
+
+   // Empty pages are released, and pages that are mostly evicted space 
+   // are repacked one at a time, to spread the copying over frames     
+   std::erase_if(mPages, [&](const std::unique_ptr<Page>& page) {
+      if (page->mIcons)
+         return false;
+      if (mRepack == page.get())
+         mRepack = nullptr;
+      std::erase_if(mBlits, [&](const Blit& blit) {
+         return blit.mPage == page->mImage.Get();
+      });
+      mSystem->GetTextures().Release(page->mImage.Get());
+      return true;
+   });
+
+   for (auto& page : mPages) {
+      if (not mRepack and page->mWastedArea * 4 > PageSize * PageSize)
+         mRepack = page.get();
+   }
+
+   mLastDrawnIcons = mDrawnIcons;
+   mLastDrawnPages = mDrawnPages;
+   mDrawnIcons = mDrawnPages = 0;
+   ++mFrame;
+}
+
+/// Get the fraction of a page's area taken by icons                          
+///   @param page - index of the page                                         
+///   @return the occupancy in the range [0;1]                                
+float GUIIcons::GetOccupancy(Offset page) const noexcept {
+   if (page >= mPages.size())
+      return 0;
+   return static_cast<float>(mPages[page]->mUsedArea) / (PageSize * PageSize);
+}
@@ -0,0 +1,124 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUITextures.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+///                                                                           
+///   Icon atlas                                                              
+///                                                                           
+/// Packs small images into shared atlas pages, so that toolbars and asset    
+/// browsers bind one texture for hundreds of icons. Every page is packed     
+/// with a skyline - images are placed as low as possible on the outline      
+/// of what's already packed. Icons that aren't drawn for a while are         
+/// evicted, and pages with too much evicted space are repacked on their      
+/// own. Repacking moves icons, so it's deferred to the start of the next     
+/// frame, once the renderer is done with the old places. Copying pixels      
+/// into the pages is left to the renderer, which consumes the blits. Packed  
+/// images are kept alive until they are evicted or removed                   
+///                                                                           
+struct GUIIcons {
+   /// Where an icon is in the atlas                                          
+   struct Icon {
+      ImTextureID mTexture;
+      ImVec2 mUV0;
+      ImVec2 mUV1;
+   };
+
+   /// A copy of an image into a page, for the renderer to do                 
+   struct Blit {
+      Ref<A::Image> mSource;
+      A::Image* mPage;
+      int mX, mY;
+      int mWidth, mHeight;
+   };
+
+   // Images larger than this are drawn on their own                    
+   static constexpr int MaxSize = 128;
+   static constexpr int PageSize = 1024;
+   // Pixels between icons, so that filtering doesn't bleed             
+   static constexpr int Padding = 1;
+   // Icons not drawn for this many frames are evicted                  
+   static constexpr uint64_t EvictFrames = 300;
+   static constexpr Count MaxPages = 8;
+
+private:
+   /// A segment of the skyline, the packed outline of a page                 
+   struct Segment {
+      int mX, mY, mWidth;
+   };
+
+   struct Page {
+      Ref<A::Image> mImage;
+      ImTextureID mTexture;
+      std::vector<Segment> mSkyline;
+      // Area of the icons in the page, and of the evicted ones         
+      Count mUsedArea {};
+      Count mWastedArea {};
+      Count mIcons {};
+      // Last frame an icon from this page was drawn                    
+      uint64_t mDrawn {};
+   };
+
+   struct Entry {
+      // The image is kept alive, so that it isn't replaced by another  
+      // one at the same address while packed                           
+      Ref<A::Image> mImage;
+      Icon mIcon;
+      Page* mPage;
+      int mX, mY;
+      int mWidth, mHeight;
+      uint64_t mUsed;
+   };
+
+   GUISystem* mSystem;
+   std::vector<std::unique_ptr<Page>> mPages;
+   std::unordered_map<const A::Image*, Entry> mEntries;
+   std::vector<Blit> mBlits;
+   uint64_t mFrame {1};
+   // Page to repack at the start of the next frame                     
+   Page* mRepack {};
+
+   // Statistics of the current and of the last finished frame          
+   Count mDrawnIcons {};
+   Count mDrawnPages {};
+   Count mLastDrawnIcons {};
+   Count mLastDrawnPages {};
+   Count mRepacks {};
+   Count mEvictions {};
+
+   NOD() static bool Fit(const Page&, int width, int height, int& x, int& y) noexcept;
+   static void Place(Page&, int x, int y, int width, int height);
+   NOD() bool Insert(Page&, Entry&);
+   NOD() Page* AddPage();
+   void Repack(Page&);
+   void Evict(Entry&);
+
+public:
+   GUIIcons(GUISystem* system) : mSystem {system} {}
+   ~GUIIcons();
+
+   NOD() const Icon* Use(A::Image*, ImVec2 size);
+   void Remove(const A::Image*);
+   void BeginFrame();
+   void EndFrame();
+   void ClearBlits() noexcept { mBlits.clear(); }
+
+   NOD() float GetOccupancy(Offset page) const noexcept;
+   NOD() Count GetPageCount() const noexcept { return mPages.size(); }
+   NOD() Count GetIconCount() const noexcept { return mEntries.size(); }
+   NOD() auto& GetBlits() const noexcept { return mBlits; }
+   NOD() Count GetDrawnIcons() const noexcept { return mLastDrawnIcons; }
+   NOD() Count GetBinds() const noexcept { return mLastDrawnPages; }
+   NOD() Count GetSavedBinds() const noexcept { return mLastDrawnIcons - mLastDrawnPages; }
+   NOD() Count GetRepacks() const noexcept { return mRepacks; }
+   NOD() Count GetEvictions() const noexcept { return mEvictions; }
+};
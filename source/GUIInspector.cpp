@@ -0,0 +1,358 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIInspector.hpp"
+#include "GUI.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+
+
+/// Generate the label of a thing                                             
+///   @param thing - the thing                                                
+///   @return the label                                                       
+Text MakeThingLabel(const Thing* thing) {
+   char label[128];
+   std::snprintf(label, sizeof(label),
+      "Thing %p (%zu children, %zu units, %zu traits)",
+      static_cast<const void*>(thing),
+      static_cast<size_t>(thing->GetChildren().GetCount()),
+      static_cast<size_t>(thing->GetUnits().GetCount()),
+      static_cast<size_t>(thing->GetTraits().GetCount())
+   );
+   return Text {label};
+}
+
+/// Generate the label of a trait, with its value                             
+///   @param trait - the trait                                                
+///   @return the label                                                       
+Text MakeTraitLabel(const Trait& trait) {
+   const auto meta = trait.GetTrait();
+   const Token name = meta ? meta->mToken : Token {"Trait"};
+
+   // Values that can't be converted to text are displayed by type only 
+   Text value;
+   try { value = trait.template AsCast<Text>(); }
+   catch (const Exception&) {
+      if (trait.GetType())
+         value = Text {trait.GetType()->mToken};
+   }
+
+   const Token valueToken {value};
+   char label[256];
+   std::snprintf(label, sizeof(label), "%.*s: %.*s",
+      static_cast<int>(name.size()), name.data(),
+      static_cast<int>(valueToken.size()), valueToken.data()
+   );
+   return Text {label};
+}
+
+/// Bind the root of the inspected hierarchy                                  
+///   @param data - must contain a thing                                      
+void GUIInspector::SetData(const Many& data) {
+   if (data.IsEmpty())
+      return;
+
+   mRoot = data.template As<Thing*>();
+   mNodes.clear();
+   mExpanded.clear();
+}
+
+/// React on the item being marked dirty - only the nodes submitted in the    
+/// last frame are refreshed, when they're submitted again                    
+///   @param item - the item that owns the inspector                          
+void GUIInspector::Refresh(GUIItem&) {
+   for (auto thing : mSubmitted) {
+      const auto found = mNodes.find(thing);
+      if (found != mNodes.end())
+         found->second.mStale = true;
+   }
+}
+
+/// React on a change notification for an observed thing                      
+///   @param thing - the thing that has changed                               
+void GUIInspector::Changed(const Thing* thing) {
+   const auto found = mNodes.find(thing);
+   if (found != mNodes.end())
+      found->second.mStale = true;
+}
+
+/// Get the state of a thing, creating it on first use                        
+///   @param thing - the thing                                                
+///   @return the node                                                        
+GUIInspector::Node& GUIInspector::Materialize(const Thing* thing) {
+   auto [found, inserted] = mNodes.try_emplace(thing);
+   auto& node = found->second;
+   if (inserted or node.mLastFrame + 1 < mFrame)
+      node.mStale = true;
+   return node;
+}
+
+/// Compare the children of a thing against the last snapshot                 
+/// Only done for expanded nodes that were notified or revalidated            
+///   @param item - the item that owns the inspector                          
+///   @param thing - the thing                                                
+///   @param node - the state of the thing                                    
+void GUIInspector::Diff(GUIItem& item, Thing* thing, Node& node) {
+   ++mDiffedNodes;
+   node.mLabel = MakeThingLabel(thing);
+   node.mStale = false;
+
+   node.mTraits.clear();
+   for (auto pair : thing->GetTraits()) {
+      for (auto& trait : pair.mValue)
+         node.mTraits.push_back(MakeTraitLabel(trait));
+   }
+
+   std::vector<Ref<Thing>> children;
+   children.reserve(thing->GetChildren().GetCount());
+   for (auto& child : thing->GetChildren())
+      children.emplace_back(&*child);
+
+   if (std::equal(children.begin(), children.end(),
+      node.mChildren.begin(), node.mChildren.end(),
+      [](const Ref<Thing>& a, const Ref<Thing>& b) {
+         return a.Get() == b.Get();
+      }))
+      return;
+
+   node.mPositions.clear();
+   if (children.size() > ClipThreshold) {
+      node.mPositions.reserve(children.size());
+      for (Offset i = 0; i < children.size(); ++i)
+         node.mPositions.emplace(children[i].Get(), i);
+   }
+
+   // Removed children lose their state, along with their descendants   
+   std::unordered_set<const Thing*> alive;
+   for (auto& child : children)
+      alive.insert(child.Get());
+
+   for (auto& child : node.mChildren) {
+      if (not alive.contains(child.Get()))
+         Forget(item, child.Get());
+   }
+
+   node.mChildren = std::move(children);
+}
+
+/// Drop the state of a node that left the tree, and of its descendants       
+/// Expanded descendants stop observing their things                          
+///   @param item - the item that owns the inspector                          
+///   @param thing - the thing                                                
+void GUIInspector::Forget(GUIItem& item, const Thing* thing) {
+   auto found = mNodes.find(thing);
+   if (found == mNodes.end())
+      return;
+
+   const auto children = std::move(found->second.mChildren);
+   for (auto& child : children)
+      Forget(item, child.Get());
+
+   found = mNodes.find(thing);
+   if (found->second.mExpanded)
+      SetExpanded(item, thing, found->second, false);
+   mNodes.erase(found);
+}
+
+/// Change the expansion state of a node                                      
+/// Only expanded nodes observe their thing for changes                       
+///   @param item - the item that owns the inspector                          
+///   @param thing - the thing                                                
+///   @param node - the state of the thing                                    
+///   @param expanded - the new state                                         
+void GUIInspector::SetExpanded(GUIItem& item, const Thing* thing, Node& node, bool expanded) {
+   if (node.mExpanded == expanded)
+      return;
+
+   node.mExpanded = expanded;
+   if (node.mParent) {
+      const auto parent = mNodes.find(node.mParent);
+      if (parent != mNodes.end()) {
+         auto& siblings = parent->second.mExpandedChildren;
+         if (expanded)
+            siblings.push_back(thing);
+         else
+            std::erase(siblings, thing);
+      }
+   }
+
+   if (expanded) {
+      item.Observe(thing);
+      mExpanded.push_back(thing);
+      node.mStale = true;
+   }
+   else {
+      item.Unobserve(thing);
+      std::erase(mExpanded, thing);
+      node.mChildren.clear();
+      node.mChildren.shrink_to_fit();
+      node.mPositions.clear();
+      node.mTraits.clear();
+   }
+}
+
+/// Submit a node and, if expanded, its contents                              
+///   @param item - the item that owns the inspector                          
+///   @param thing - the thing                                                
+///   @param parent - the parent thing, if any                                
+void GUIInspector::SubmitNode(GUIItem& item, Thing* thing, const Thing* parent) {
+   auto& node = Materialize(thing);
+   node.mParent = parent;
+   node.mLastFrame = mFrame;
+   mSubmitted.push_back(thing);
+   ++mSubmittedNodes;
+
+   // A different number of children, units or traits is a change, even 
+   // if nobody notified about it                                       
+   const Count counts[3] {
+      thing->GetChildren().GetCount(),
+      thing->GetUnits().GetCount(),
+      thing->GetTraits().GetCount()
+   };
+   if (not std::equal(counts, counts + 3, node.mCounts)) {
+      std::copy(counts, counts + 3, node.mCounts);
+      node.mStale = true;
+   }
+
+   if (node.mStale and not node.mExpanded) {
+      node.mLabel = MakeThingLabel(thing);
+      node.mStale = false;
+   }
+
+   if (node.mOpen) {
+      ImGui::SetNextItemOpen(true);
+      node.mOpen = false;
+   }
+
+   const Token label {node.mLabel};
+   const bool open = ImGui::TreeNodeEx(thing, ImGuiTreeNodeFlags_OpenOnArrow,
+      "%.*s", static_cast<int>(label.size()), label.data());
+   SetExpanded(item, thing, node, open);
+   if (not open)
+      return;
+
+   if (node.mStale)
+      Diff(item, thing, node);
+
+   // Units and traits are leaves, listed only while expanded           
+   for (auto& unit : thing->GetUnits()) {
+      const Token type = unit->GetType()->mToken;
+      ImGui::BulletText("%.*s", static_cast<int>(type.size()), type.data());
+   }
+
+   for (auto& trait : node.mTraits) {
+      const Token text {trait};
+      ImGui::BulletText("%.*s", static_cast<int>(text.size()), text.data());
+   }
+
+   SubmitChildren(item, thing, node);
+   ImGui::TreePop();
+}
+
+/// Submit the children of an expanded node                                   
+/// Long lists are clipped. Collapsed children all have the same height, so   
+/// the runs between expanded children are clipped one by one, and only the   
+/// expanded children are always submitted                                    
+///   @param item - the item that owns the inspector                          
+///   @param thing - the thing                                                
+///   @param node - the state of the thing                                    
+void GUIInspector::SubmitChildren(GUIItem& item, Thing* thing, Node& node) {
+   const auto count = node.mChildren.size();
+   if (count <= ClipThreshold) {
+      // Submitting may add expanded children, so iterate by index      
+      for (Offset i = 0; i < node.mChildren.size(); ++i)
+         SubmitNode(item, node.mChildren[i].Get(), thing);
+      return;
+   }
+
+   // Submitting may change which children are expanded, so their       
+   // positions are collected first, with the end of the list last      
+   std::vector<Offset> expanded;
+   expanded.reserve(node.mExpandedChildren.size() + 1);
+   for (auto child : node.mExpandedChildren) {
+      const auto found = node.mPositions.find(child);
+      if (found != node.mPositions.end())
+         expanded.push_back(found->second);
+   }
+   std::sort(expanded.begin(), expanded.end());
+   expanded.push_back(count);
+
+   Offset from = 0;
+   for (auto to : expanded) {
+      if (to > from) {
+         ImGuiListClipper clipper;
+         clipper.Begin(static_cast<int>(to - from));
+         while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+               SubmitNode(item, node.mChildren[from + i].Get(), thing);
+         }
+      }
+
+      if (to < count)
+         SubmitNode(item, node.mChildren[to].Get(), thing);
+      from = to + 1;
+   }
+}
+
+/// Open a node, the next time it is submitted                                
+///   @param thing - the thing to open                                        
+void GUIInspector::Expand(const Thing* thing) {
+   Materialize(thing).mOpen = true;
+}
+
+/// Drop the state of nodes that weren't submitted for a while                
+///   @param item - the item that owns the inspector                          
+void GUIInspector::Collect(GUIItem& item) {
+   std::erase_if(mNodes, [&](auto& pair) {
+      auto& [thing, node] = pair;
+      if (node.mLastFrame + CollectAfter >= mFrame)
+         return false;
+
+      if (node.mExpanded) {
+         item.Unobserve(thing);
+         std::erase(mExpanded, thing);
+
+         const auto parent = mNodes.find(node.mParent);
+         if (parent != mNodes.end())
+            std::erase(parent->second.mExpandedChildren, thing);
+      }
+      return true;
+   });
+}
+
+/// Submit the visible part of the hierarchy                                  
+///   @param item - the item that owns the inspector                          
+void GUIInspector::Submit(GUIItem& item) {
+   ++mFrame;
+   mSubmittedNodes = mDiffedNodes = 0;
+   mSubmitted.clear();
+
+   if (not mRoot) {
+      ImGui::TextDisabled("Nothing to inspect");
+      return;
+   }
+
+   // Revalidate a few visible expanded nodes, in case a change wasn't  
+   // notified - this replaces walking the whole tree every frame       
+   const auto revalidate = std::min(RevalidateBudget, mExpanded.size());
+   for (Count i = 0; i < revalidate; ++i) {
+      mRevalidateCursor = (mRevalidateCursor + 1) % mExpanded.size();
+      auto& node = mNodes[mExpanded[mRevalidateCursor]];
+      if (node.mLastFrame + 1 >= mFrame)
+         node.mStale = true;
+   }
+
+   ImGui::PushID(this);
+   if (ImGui::BeginChild("##inspector", item.GetRequestedSize()))
+      SubmitNode(item, mRoot.Get(), nullptr);
+   ImGui::EndChild();
+   ImGui::PopID();
+
+   if (mFrame % 256 == 0)
+      Collect(item);
+}
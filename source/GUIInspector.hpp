@@ -0,0 +1,95 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIWidget.hpp"
+#include <unordered_map>
+#include <vector>
+
+
+///                                                                           
+///   Live hierarchy inspector                                                
+///                                                                           
+/// Displays the things, units and traits of a hierarchy as a tree. Nodes     
+/// are materialized only when their parent is expanded, and only expanded    
+/// nodes observe their thing for changes. A changed node diffs its child     
+/// list against the previous one on the next frame. Things don't announce    
+/// changes on their own - whoever changes an inspected thing outside the     
+/// GUI should call GUISystem::Notify for it. Otherwise, submitted nodes      
+/// notice when their number of children, units or traits changes, and        
+/// expanded nodes are revalidated a few per frame, so the whole tree is      
+/// never walked at once. Expanded nodes keep their children alive, so that   
+/// a child destroyed before the next diff is never submitted                 
+///                                                                           
+struct GUIInspector final : GUIWidget {
+   // Number of expanded nodes revalidated per frame, when not notified 
+   static constexpr Count RevalidateBudget = 32;
+   // Children lists longer than this are clipped, except for their     
+   // expanded children                                                 
+   static constexpr Count ClipThreshold = 256;
+   // Frames a node can stay unused before its state is dropped         
+   static constexpr Count CollectAfter = 600;
+
+private:
+   /// Materialized state of a thing in the tree                              
+   struct Node {
+      // Children snapshot, kept only while the node is expanded        
+      std::vector<Ref<Thing>> mChildren;
+      // Positions of the children in the snapshot, kept only for long  
+      // lists, where expanded children are submitted between clipped runs
+      std::unordered_map<const Thing*, Offset> mPositions;
+      // Children that are expanded, which breaks clipping              
+      std::vector<const Thing*> mExpandedChildren;
+      // Cached labels of the traits, while the node is expanded        
+      std::vector<Text> mTraits;
+      // The thing this node was last submitted under                   
+      const Thing* mParent {};
+      // Cached label                                                   
+      Text mLabel;
+      // Frame the node was last submitted in                           
+      uint64_t mLastFrame {};
+      // Number of children, units and traits, when last labeled        
+      Count mCounts[3] {};
+      bool mExpanded {};
+      bool mStale {true};
+      // Whether to open the node when it's submitted next              
+      bool mOpen {};
+   };
+
+   Ref<Thing> mRoot;
+   std::unordered_map<const Thing*, Node> mNodes;
+   // Expanded nodes, for round-robin revalidation                      
+   std::vector<const Thing*> mExpanded;
+   Offset mRevalidateCursor {};
+   uint64_t mFrame {};
+   // Nodes submitted in the last frame, in order                       
+   std::vector<const Thing*> mSubmitted;
+
+   // Statistics for the last frame                                     
+   Count mSubmittedNodes {};
+   Count mDiffedNodes {};
+
+   Node& Materialize(const Thing*);
+   void Diff(GUIItem&, Thing*, Node&);
+   void Forget(GUIItem&, const Thing*);
+   void SubmitNode(GUIItem&, Thing*, const Thing* parent);
+   void SubmitChildren(GUIItem&, Thing*, Node&);
+   void SetExpanded(GUIItem&, const Thing*, Node&, bool);
+   void Collect(GUIItem&);
+
+public:
+   void SetData(const Many&) override;
+   void Refresh(GUIItem&) override;
+   void Changed(const Thing*) override;
+   void Submit(GUIItem&) override;
+   void Expand(const Thing*);
+
+   NOD() Count GetMaterializedCount() const noexcept { return mNodes.size(); }
+   NOD() Count GetSubmittedNodes() const noexcept { return mSubmittedNodes; }
+   NOD() Count GetDiffedNodes() const noexcept { return mDiffedNodes; }
+};
+
@@ -0,0 +1,263 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIInstances.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static_assert(sizeof(GUIInstances::Instance) == 24,
+   "Instances are expected to be tightly packed");
+
+const char* const GUIInstances::VertexShader = R"(
+   layout(location = 0) in ivec4 inRect;     // quarter pixels
+   layout(location = 1) in vec4 inUV;        // normalized unsigned
+   layout(location = 2) in vec4 inColor;     // normalized unsigned
+   layout(location = 3) in uvec2 inRadius;   // quarter pixels, flags
+
+   layout(push_constant) uniform Projection {
+      vec2 uScale;
+      vec2 uTranslate;
+   };
+
+   layout(location = 0) out vec4 outColor;
+   layout(location = 1) out vec2 outUV;
+   layout(location = 2) out vec2 outLocal;
+   layout(location = 3) out vec3 outBox;
+
+   void main() {
+      const vec2 corner = vec2(gl_VertexIndex & 1, gl_VertexIndex >> 1);
+      const vec4 rect = vec4(inRect) * 0.25;
+      const vec2 position = mix(rect.xy, rect.zw, corner);
+      outColor = inColor;
+      outUV = mix(inUV.xy, inUV.zw, corner);
+      outLocal = position - (rect.xy + rect.zw) * 0.5;
+      outBox = vec3((rect.zw - rect.xy) * 0.5, float(inRadius.x) * 0.25);
+      gl_Position = vec4(position * uScale + uTranslate, 0, 1);
+   }
+)";
+
+/// Quantize a coordinate to quarter pixels                                   
+///   @param value - the coordinate                                           
+///   @param out - [out] the quantized coordinate                             
+///   @return false if the coordinate doesn't fit                             
+inline bool QuantizePosition(float value, int16_t& out) noexcept {
+   const float q = std::round(value * 4.0f);
+   if (q < std::numeric_limits<int16_t>::min()
+   or  q > std::numeric_limits<int16_t>::max())
+      return false;
+   out = static_cast<int16_t>(q);
+   return true;
+}
+
+/// Quantize a texture coordinate to 16 bits                                  
+///   @param value - the coordinate in the [0;1] range                        
+///   @return the quantized coordinate                                        
+inline uint16_t QuantizeUV(float value) noexcept {
+   return static_cast<uint16_t>(
+      std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+/// Check if six indices form a single-colored axis-aligned quad              
+/// ImGui's PrimRect and PrimRectUV emit corners in clockwise order from      
+/// the top-left, with indices 0,1,2 0,2,3                                    
+///   @param list - the list the indices are in                               
+///   @param cmd - the command the indices are in                             
+///   @param idx - the six indices                                            
+///   @param out - [out] the instance, if the indices form a quad             
+///   @return true if the indices form a quad                                 
+bool GUIInstances::TryQuad(const ImDrawList* list, const ImDrawCmd& cmd, const ImDrawIdx* idx, Instance& out) const {
+   const uint32_t b = idx[0];
+   if (idx[1] != b + 1 or idx[2] != b + 2 or idx[3] != b
+   or  idx[4] != b + 2 or idx[5] != b + 3)
+      return false;
+
+   const auto v = list->VtxBuffer.Data + cmd.VtxOffset + b;
+   if (v[1].pos.y != v[0].pos.y or v[2].pos.x != v[1].pos.x
+   or  v[3].pos.x != v[0].pos.x or v[3].pos.y != v[2].pos.y)
+      return false;
+   if (v[1].uv.y != v[0].uv.y or v[2].uv.x != v[1].uv.x
+   or  v[3].uv.x != v[0].uv.x or v[3].uv.y != v[2].uv.y)
+      return false;
+   if (v[1].col != v[0].col or v[2].col != v[0].col or v[3].col != v[0].col)
+      return false;
+
+   if (not QuantizePosition(v[0].pos.x - mOrigin.x, out.mRect[0])
+   or  not QuantizePosition(v[0].pos.y - mOrigin.y, out.mRect[1])
+   or  not QuantizePosition(v[2].pos.x - mOrigin.x, out.mRect[2])
+   or  not QuantizePosition(v[2].pos.y - mOrigin.y, out.mRect[3]))
+      return false;
+
+   out.mUV[0] = QuantizeUV(v[0].uv.x);
+   out.mUV[1] = QuantizeUV(v[0].uv.y);
+   out.mUV[2] = QuantizeUV(v[2].uv.x);
+   out.mUV[3] = QuantizeUV(v[2].uv.y);
+   out.mColor = v[0].col;
+   out.mRadius = 0;
+   out.mFlags = 0;
+   return true;
+}
+
+/// Get the last batch if it's compatible, or start a new one                 
+///   @param kind - kind of batch                                             
+///   @param list - the list being converted                                  
+///   @param cmd - the command being converted                                
+///   @param split - whether to start a new batch even if compatible          
+///   @return the batch to append to                                          
+GUIInstances::Batch& GUIInstances::GetBatch(Kind kind, const ImDrawList* list, const ImDrawCmd& cmd, bool split) {
+   if (not split and not mBatches.empty()) {
+      auto& last = mBatches.back();
+      if (last.mKind == kind and last.mTexture == cmd.TextureId
+      and last.mClipRect.x == cmd.ClipRect.x and last.mClipRect.y == cmd.ClipRect.y
+      and last.mClipRect.z == cmd.ClipRect.z and last.mClipRect.w == cmd.ClipRect.w)
+         return last;
+   }
+
+   const auto first = kind == Kind::Instances
+      ? mInstances.size() : mIndices.size();
+   return mBatches.emplace_back(Batch {
+      kind, cmd.ClipRect, cmd.TextureId,
+      static_cast<uint32_t>(first), 0, list
+   });
+}
+
+/// Copy a run of triangles that aren't quads                                 
+/// Only the range of vertices the run references is copied. With 16-bit      
+/// indices, a batch is split before it references more vertices than an      
+/// ImDrawIdx can address, so that Expand can draw it                         
+///   @param list - the list being converted                                  
+///   @param cmd - the command being converted                                
+///   @param idx - the first index of the run                                 
+///   @param count - number of indices in the run                             
+void GUIInstances::FlushTriangles(const ImDrawList* list, const ImDrawCmd& cmd, const ImDrawIdx* idx, uint32_t count) {
+   if (not count)
+      return;
+
+   constexpr uint64_t MaxVertices = uint64_t {1} << (sizeof(ImDrawIdx) * 8);
+   const auto [lo, hi] = std::minmax_element(idx, idx + count);
+   const auto base = static_cast<uint32_t>(mVertices.size());
+   const auto from = list->VtxBuffer.Data + cmd.VtxOffset;
+   const bool split =
+      uint64_t {base} + (*hi - *lo + 1) - mBatchVertex > MaxVertices;
+
+   auto& batch = GetBatch(Kind::Triangles, list, cmd, split);
+   if (not batch.mCount)
+      mBatchVertex = base;
+   mVertices.insert(mVertices.end(), from + *lo, from + *hi + 1);
+   for (uint32_t i = 0; i < count; ++i)
+      mIndices.push_back(base + idx[i] - *lo);
+   batch.mCount += count;
+}
+
+/// Convert the draw data of a frame                                          
+///   @param data - the draw data to convert                                  
+void GUIInstances::Build(const ImDrawData* data) {
+   mInstances.clear();
+   mVertices.clear();
+   mIndices.clear();
+   mBatches.clear();
+   mBatchVertex = 0;
+   mInputBytes = mOutputBytes = 0;
+   if (not data)
+      return;
+
+   mOrigin = data->DisplayPos;
+   for (int n = 0; n < data->CmdListsCount; ++n) {
+      const auto list = data->CmdLists[n];
+      mInputBytes += list->VtxBuffer.Size * sizeof(ImDrawVert)
+                   + list->IdxBuffer.Size * sizeof(ImDrawIdx);
+
+      for (int c = 0; c < list->CmdBuffer.Size; ++c) {
+         const auto& cmd = list->CmdBuffer[c];
+         if (cmd.UserCallback) {
+            mBatches.push_back({
+               Kind::Callback, cmd.ClipRect, cmd.TextureId,
+               static_cast<uint32_t>(c), 0, list
+            });
+            continue;
+         }
+
+         const auto idx = list->IdxBuffer.Data + cmd.IdxOffset;
+         uint32_t run = 0;
+         uint32_t i = 0;
+         while (i < cmd.ElemCount) {
+            Instance instance;
+            if (i + 6 <= cmd.ElemCount and TryQuad(list, cmd, idx + i, instance)) {
+               FlushTriangles(list, cmd, idx + run, i - run);
+               mInstances.push_back(instance);
+               ++GetBatch(Kind::Instances, list, cmd).mCount;
+               i += 6;
+               run = i;
+            }
+            else i += 3;
+         }
+
+         FlushTriangles(list, cmd, idx + run, cmd.ElemCount - run);
+      }
+   }
+
+   mOutputBytes = mInstances.size() * sizeof(Instance)
+                + mVertices.size() * sizeof(ImDrawVert)
+                + mIndices.size() * sizeof(uint32_t);
+}
+
+/// Expand the stream back into triangles, for headless use and testing       
+/// Rounded instances are drawn as filled rounded rectangles, ignoring UVs    
+///   @param out - the draw list to expand into                               
+void GUIInstances::Expand(ImDrawList* out) const {
+   for (auto& batch : mBatches) {
+      if (batch.mKind == Kind::Callback) {
+         const auto& cmd = batch.mList->CmdBuffer[batch.mFirst];
+         out->AddCallback(cmd.UserCallback, cmd.UserCallbackData);
+         continue;
+      }
+
+      out->PushClipRect(
+         {batch.mClipRect.x, batch.mClipRect.y},
+         {batch.mClipRect.z, batch.mClipRect.w});
+      out->PushTextureID(batch.mTexture);
+
+      if (batch.mKind == Kind::Instances) {
+         for (uint32_t i = batch.mFirst; i < batch.mFirst + batch.mCount; ++i) {
+            const auto& q = mInstances[i];
+            const ImVec2 a {
+               q.mRect[0] * 0.25f + mOrigin.x, q.mRect[1] * 0.25f + mOrigin.y};
+            const ImVec2 b {
+               q.mRect[2] * 0.25f + mOrigin.x, q.mRect[3] * 0.25f + mOrigin.y};
+
+            if (q.mRadius) {
+               out->AddRectFilled(a, b, q.mColor, q.mRadius * 0.25f);
+               continue;
+            }
+
+            out->PrimReserve(6, 4);
+            out->PrimRectUV(a, b,
+               {q.mUV[0] / 65535.0f, q.mUV[1] / 65535.0f},
+               {q.mUV[2] / 65535.0f, q.mUV[3] / 65535.0f},
+               q.mColor);
+         }
+      }
+      else {
+         // Indices are rebased to the vertices the batch references    
+         const auto idx = mIndices.data() + batch.mFirst;
+         const auto [lo, hi] = std::minmax_element(idx, idx + batch.mCount);
+         const auto vertices = static_cast<int>(*hi - *lo + 1);
+         out->PrimReserve(static_cast<int>(batch.mCount), vertices);
+         std::copy_n(mVertices.data() + *lo, vertices, out->_VtxWritePtr);
+         for (uint32_t i = 0; i < batch.mCount; ++i) {
+            out->_IdxWritePtr[i] = static_cast<ImDrawIdx>(
+               out->_VtxCurrentIdx + idx[i] - *lo);
+         }
+         out->_VtxWritePtr += vertices;
+         out->_IdxWritePtr += batch.mCount;
+         out->_VtxCurrentIdx += vertices;
+      }
+
+      out->PopTextureID();
+      out->PopClipRect();
+   }
+}
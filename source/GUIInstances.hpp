@@ -0,0 +1,86 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <vector>
+
+
+///                                                                           
+///   Instanced primitive stream                                              
+///                                                                           
+/// An alternative to uploading ImGui's expanded triangles. Axis-aligned      
+/// quads with a single color - glyphs, solid rectangles and images - are     
+/// turned into compact per-instance records, that a vertex shader expands    
+/// into four corners. Everything else, such as anti-aliased paths and        
+/// gradients, falls back to triangles. Batches preserve the draw order of    
+/// the original commands                                                     
+///                                                                           
+struct GUIInstances {
+   /// A single quad, 24 bytes instead of 92 for four ImDrawVerts and six     
+   /// 16-bit indices. Positions are in quarter pixels relative to the        
+   /// display position, texture coordinates are normalized to 16 bits        
+   struct Instance {
+      int16_t mRect[4];
+      uint16_t mUV[4];
+      ImU32 mColor;
+      // Corner radius in quarter pixels, zero for plain quads          
+      uint16_t mRadius;
+      uint16_t mFlags;
+   };
+
+   enum class Kind : uint8_t {
+      // mCount instances, starting at mFirst                           
+      Instances,
+      // mCount indices into the fallback triangles, starting at mFirst 
+      Triangles,
+      // A user callback, mFirst is the command index in mList          
+      Callback
+   };
+
+   struct Batch {
+      Kind mKind;
+      ImVec4 mClipRect;
+      ImTextureID mTexture;
+      uint32_t mFirst;
+      uint32_t mCount;
+      const ImDrawList* mList;
+   };
+
+   // GLSL vertex shader that expands instances, drawn as triangle      
+   // strips of four vertices per instance                              
+   static const char* const VertexShader;
+
+private:
+   std::vector<Instance> mInstances;
+   std::vector<ImDrawVert> mVertices;
+   std::vector<uint32_t> mIndices;
+   std::vector<Batch> mBatches;
+   ImVec2 mOrigin {};
+   // First vertex of the last batch of triangles                       
+   uint32_t mBatchVertex {};
+
+   // Sizes of the last frame, in ImGui's format and in this one        
+   size_t mInputBytes {};
+   size_t mOutputBytes {};
+
+   bool TryQuad(const ImDrawList*, const ImDrawCmd&, const ImDrawIdx*, Instance&) const;
+   Batch& GetBatch(Kind, const ImDrawList*, const ImDrawCmd&, bool split = false);
+   void FlushTriangles(const ImDrawList*, const ImDrawCmd&, const ImDrawIdx*, uint32_t count);
+
+public:
+   void Build(const ImDrawData*);
+   void Expand(ImDrawList*) const;
+
+   NOD() auto& GetInstances() const noexcept { return mInstances; }
+   NOD() auto& GetVertices() const noexcept { return mVertices; }
+   NOD() auto& GetIndices() const noexcept { return mIndices; }
+   NOD() auto& GetBatches() const noexcept { return mBatches; }
+   NOD() size_t GetInputBytes() const noexcept { return mInputBytes; }
+   NOD() size_t GetOutputBytes() const noexcept { return mOutputBytes; }
+};
+
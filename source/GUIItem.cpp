@@ -6,7 +6,15 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later                                 
 ///                                                                           
 #include "GUIItem.hpp"
+#include "GUIList.hpp"
+#include "GUIPlot.hpp"
+#include "GUIConsole.hpp"
+#include "GUIInspector.hpp"
+#include "GUIThumbnails.hpp"
+#include "GUIEditor.hpp"
 #include "GUI.hpp"
+#include <Langulus/Image.hpp>
+#include <imgui_internal.h>
 
 
 /// GUI item construction                                                     
@@ -16,11 +24,562 @@ GUIItem::GUIItem(GUISystem* producer, Describe descriptor)
    : A::UIUnit    {MetaOf<GUIItem>()}
    , ProducedFrom {producer, descriptor} {
    VERBOSE_GUI("Initializing...");
+
+   // Configure from a cached template - the descriptor is walked once  
+   // and parsed only the first time its shape is encountered           
+   const GUITemplate::Shape shape {descriptor};
+   producer->GetTemplate(shape).Instantiate(*this, shape);
+
+   // Attach to a parent item, if one is provided - only top-level      
+   // items are windows, that can be drawn from a layer                 
+   if (mParent) {
+      mParent->mChildren.push_back(this);
+      mDepth = mParent->mDepth + 1;
+      mLayer.reset();
+   }
+   else if (not mLayer)
+      mLayer = std::make_unique<GUILayer>();
+
+   producer->Attach(this);
+   if (mParent)
+      mParent->MarkDirty(DirtyLayout);
    VERBOSE_GUI("Initialized");
 }
 
+/// GUI item destruction                                                      
+GUIItem::~GUIItem() {
+   // Detach from the hierarchy - children become top-level items       
+   if (mParent) {
+      auto& siblings = mParent->mChildren;
+      std::erase(siblings, this);
+      mParent->MarkDirty(DirtyLayout);
+   }
+
+   for (auto child : mChildren)
+      child->mParent = nullptr;
+
+   for (auto source : mSources)
+      mProducer->Unsubscribe(this, source);
+   if (mIconTexture)
+      GetTextures().Release(mIcon.Get());
+   mProducer->Detach(this);
+}
+
+/// Subscribe the item to changes of an entity it displays                    
+///   @param source - the entity to observe                                   
+///   @param trait - the trait to observe, or nullptr for any change          
+void GUIItem::Observe(const Thing* source, TMeta trait) {
+   if (std::find(mSources.begin(), mSources.end(), source) == mSources.end())
+      mSources.push_back(source);
+   mProducer->Subscribe(this, source, trait);
+}
+
+/// Unsubscribe the item from changes of an entity                            
+///   @param source - the entity to stop observing                            
+void GUIItem::Unobserve(const Thing* source) {
+   std::erase(mSources, source);
+   mProducer->Unsubscribe(this, source);
+}
+
+/// Bind a checkbox, slider or input field to a trait of an entity, both ways 
+/// The value is read only when the entity notifies about a change of the     
+/// trait, and edits are sent back only when committed. Entities don't        
+/// notify on their own - edits made through the GUI do, but anything else    
+/// that changes the trait has to call GUISystem::Notify with the entity and  
+/// the trait, or the widget keeps showing the old value                      
+///   @param thing - the entity                                               
+///   @param trait - the trait to edit                                        
+void GUIItem::Bind(Thing* thing, TMeta trait) {
+   // The old subscription is dropped even for the same entity, so that 
+   // it's replaced, and not widened to any trait                       
+   if (mBoundThing)
+      Unobserve(mBoundThing.Get());
+
+   mBoundThing = thing;
+   mBoundTrait = trait;
+   if (thing)
+      Observe(thing, trait);
+   MarkDirty(DirtyContent);
+}
+
+/// Draw an image on a button, instead of its label                           
+/// Small images are packed into the system's icon pages, so that many icons  
+/// are drawn with a single texture                                           
+///   @param image - the image, or nullptr to draw the label again            
+void GUIItem::SetIcon(A::Image* image) {
+   if (mIconTexture)
+      GetTextures().Release(mIcon.Get());
+   mIcon = image;
+   mIconTexture = {};
+   MarkDirty(DirtyLayout);
+}
+
+/// Reread the value of the bound trait                                       
+void GUIItem::ReadBinding() {
+   const auto trait = mBoundThing->GetTrait(mBoundTrait);
+   if (trait.IsEmpty())
+      return;
+
+   switch (mKind) {
+   case Kind::Checkbox:
+      mChecked = trait.template AsCast<bool>();
+      break;
+   case Kind::Slider:
+      mValue = trait.template AsCast<float>();
+      break;
+   case Kind::Input: {
+      const auto text = trait.template AsCast<Text>();
+      mInput.assign(text.GetRaw(), text.GetCount());
+   } break;
+   default:
+      break;
+   }
+}
+
+/// Make the item's subtree static or dynamic                                 
+/// Static subtrees are recorded on their first submission, and replayed      
+/// until the item or any of its descendants is marked dirty                  
+///   @param enabled - whether the subtree is static                          
+void GUIItem::SetStatic(bool enabled) {
+   if (not enabled)
+      mRecording.reset();
+   else if (not mRecording)
+      mRecording = std::make_unique<GUIRecording>();
+}
+
+/// Discard the recordings and the layer that contain the item, when its      
+/// appearance changes without affecting the layout                           
+void GUIItem::Invalidate() {
+   for (auto item = this; item; item = item->mParent) {
+      if (item->mRecording)
+         item->mRecording->Reset();
+      if (item->mLayer)
+         item->mLayer->Invalidate();
+   }
+}
+
+/// Animate a property of the item from its current value                     
+///   @param property - the property to animate                               
+///   @param to - the final value                                             
+///   @param duration - seconds the animation takes, zero to set it at once   
+///   @param easing - the easing curve                                        
+void GUIItem::Animate(GUITweens::Property property, float to, float duration, GUITweens::Easing easing) {
+   mProducer->GetTweens().Start(*this, property, to, duration, easing);
+}
+
+/// Create an image in the item's context, for offscreen rendering            
+///   @param size - size of the image in pixels                               
+///   @return the image                                                       
+A::Image* GUIItem::CreateImage(ImVec2 size) {
+   Verbs::Create createImage {
+      Construct::From<A::Image>(
+         Traits::Name {"GUI layer"},
+         Traits::Size {
+            static_cast<int>(size.x),
+            static_cast<int>(size.y)
+         }
+      )
+   };
+
+   return RunIn(createImage)->As<A::Image*>();
+}
+
+/// Get the registry of images drawn by the item's system                     
+///   @return the registry                                                    
+GUITextures& GUIItem::GetTextures() const {
+   return mProducer->GetTextures();
+}
+
+/// Create the state for the more complex widget kinds                        
+void GUIItem::CreateWidget() {
+   switch (mKind) {
+   case Kind::List:
+   case Kind::Table:
+      mWidget = std::make_unique<GUIList>(mProducer, mKind == Kind::Table);
+      break;
+   case Kind::Plot:
+      mWidget = std::make_unique<GUIPlot>();
+      break;
+   case Kind::Console: {
+      auto console = std::make_unique<GUIConsole>();
+      console->AttachToLogger();
+      mWidget = std::move(console);
+   } break;
+   case Kind::Inspector:
+      mWidget = std::make_unique<GUIInspector>();
+      break;
+   case Kind::Thumbnails:
+      mWidget = std::make_unique<GUIThumbnails>(mProducer);
+      break;
+   case Kind::Editor:
+      mWidget = std::make_unique<GUIEditor>();
+      break;
+   default:
+      mWidget.reset();
+   }
+}
+
 /// React on environmental change                                             
+/// Called whenever the traits or units of an owner change, so instead of     
+/// rereading anything here, we just mark the item for the next refresh.      
+/// The owners have changed, so items that display them are notified too      
 void GUIItem::Refresh() {
+   MarkDirty(DirtyContent);
+   for (auto owner : GetOwners())
+      mProducer->Notify(owner);
+}
+
+/// Mark the item for reprocessing on the next GUISystem::Refresh             
+/// Layout dirtiness is propagated to all ancestors, stopping early at the    
+/// first one that is already dirty, so marking is amortized O(1)             
+///   @param dirt - the reason for reprocessing                               
+void GUIItem::MarkDirty(Dirt dirt) {
+   if (dirt == DirtyContent)
+      dirt = static_cast<Dirt>(DirtyContent | DirtyLayout);
+
+   if ((mDirt & dirt) == dirt)
+      return;
 
+   if (not mDirt)
+      mProducer->EnqueueDirty(this);
+   mDirt |= dirt;
+
+   auto parent = mParent;
+   while (parent and not (parent->mDirt & DirtyLayout)) {
+      if (not parent->mDirt)
+         mProducer->EnqueueDirty(parent);
+      parent->mDirt |= DirtyLayout;
+      parent = parent->mParent;
+   }
 }
 
+/// Reread the displayed data and/or recompute the layout                     
+/// Children are guaranteed to be processed before their parents              
+///   @param dirt - what to reprocess                                         
+void GUIItem::Reprocess(uint8_t dirt) {
+   if (dirt & DirtyContent) {
+      // Reread the label from the owners, if it's available there      
+      Text label;
+      if (SeekValue<Traits::Name>(label))
+         mLabel = label.Terminate();
+      // A value changed while the user is editing is overwritten by    
+      // the edit once committed                                        
+      if (mBoundThing and not mEditing)
+         ReadBinding();
+      if (mWidget)
+         mWidget->Refresh(*this);
+   }
+
+   if (dirt & DirtyLayout) {
+      // Size of the label, followed by children stacked vertically     
+      const auto& style = ImGui::GetStyle();
+      const auto font = ImGui::GetFont();
+      mSize = {};
+      if (mLabel and font) {
+         mSize = mProducer->GetTextCache().Measure(
+            font, font->FontSize, GetLabelView(), GetWrapWidth()
+         ).mSize;
+      }
+
+      // Icons have to be used every frame to stay in the atlas, so     
+      // they can't be recorded, just like widgets                      
+      mHasWidgets = mWidget != nullptr or mIcon;
+      mSubtreeCount = 1;
+      for (auto child : mChildren) {
+         mSize.x = std::max(mSize.x, child->mSize.x);
+         mSize.y += child->mSize.y + style.ItemSpacing.y;
+         mHasWidgets |= child->mHasWidgets;
+         mSubtreeCount += child->mSubtreeCount;
+      }
+
+      // Layout dirt reaches all ancestors, so any recording or layer   
+      // that contains this item is discarded here                      
+      if (mRecording)
+         mRecording->Reset();
+      if (mLayer)
+         mLayer->Invalidate();
+   }
+}
+
+/// Submit the item and its children to the current ImGui frame               
+void GUIItem::Submit() {
+   const auto begin = mLabel.GetRaw();
+
+   // Faded items are drawn with less opacity, and so are their children,
+   // fades of nested items multiply                                    
+   const bool faded = mAlpha < 1;
+   if (faded) {
+      ImGui::PushStyleVar(ImGuiStyleVar_Alpha,
+         ImGui::GetStyle().Alpha * std::max(mAlpha, 0.0f));
+   }
+
+   if (not mParent) {
+      // Top-level items are windows                                    
+      if (mRequestedSize.x > 0 and mRequestedSize.y > 0)
+         ImGui::SetNextWindowSize(mRequestedSize, ImGuiCond_FirstUseEver);
+      const bool open = ImGui::Begin(mLabel ? begin : "##GUIItem");
+      auto& spatial = mProducer->GetSpatial();
+      spatial.BeginWindow(*this, open);
+
+      // Nothing inside a collapsed or hidden window is submitted, but  
+      // the window itself is, so only its contents are parked          
+      if (mCollapsed and open)
+         mProducer->Uncover();
+      mCollapsed = not open;
+      if (mCollapsed)
+         mProducer->AddCulled(mSubtreeCount - 1);
+      mLayer->Begin(mHasWidgets);
+      const bool live = open and not mLayer->Replay();
+      if (live) {
+         mLayer->BeginCapture();
+         SubmitRecordable();
+         mLayer->EndCapture();
+      }
+      spatial.EndWindow(live);
+      ImGui::End();
+   }
+   else {
+      // The order is taken before the children, which are submitted    
+      // inside the group, so that they end up above their parent       
+      auto& spatial = mProducer->GetSpatial();
+      const auto order = spatial.Reserve();
+
+      // Subtrees outside the clip rectangle are replaced by a          
+      // placeholder of the size they had when last displayed, so that  
+      // scrollbars stay correct                                        
+      ImVec2 size = mSize;
+      if (ImVec4 rect; spatial.GetRect(*this, rect))
+         size = {rect.z - rect.x, rect.w - rect.y};
+
+      const bool culled = not ImGui::IsRectVisible(
+         {std::max(size.x, 1.0f), std::max(size.y, 1.0f)});
+      if (mCulled and not culled)
+         mProducer->Uncover();
+      mCulled = culled;
+      if (mCulled) {
+         ImGui::Dummy(size);
+         mProducer->AddCulled(mSubtreeCount);
+         spatial.Update(*this, order,
+            ImGui::GetItemRectMin(), ImGui::GetItemRectMax());
+         Unindex();
+      }
+      else {
+         // Slid items are displaced, and a placeholder of their size   
+         // is left where they would be, so nothing after them moves    
+         const bool slid = mOffset.x != 0 or mOffset.y != 0;
+         const auto start = ImGui::GetCursorScreenPos();
+         if (slid)
+            ImGui::SetCursorScreenPos({start.x + mOffset.x, start.y + mOffset.y});
+
+         ImGui::BeginGroup();
+         SubmitRecordable();
+         ImGui::EndGroup();
+         const auto min = ImGui::GetItemRectMin();
+         const auto max = ImGui::GetItemRectMax();
+         if (slid) {
+            ImGui::SetCursorScreenPos(start);
+            ImGui::Dummy({max.x - min.x, max.y - min.y});
+         }
+         spatial.Update(*this, order, min, max);
+      }
+   }
+
+   if (faded)
+      ImGui::PopStyleVar();
+}
+
+/// Remove the descendants from the spatial index, when the item is culled    
+/// They aren't displayed, so they must not be hit, or ranked as visible      
+void GUIItem::Unindex() {
+   auto& spatial = mProducer->GetSpatial();
+   for (auto child : mChildren) {
+      if (child->mSpatial == GUISpatial::None and child->mChildren.empty())
+         continue;
+
+      spatial.Remove(*child);
+      child->Unindex();
+   }
+}
+
+/// Keep the descendants indexed where they were, because they are replayed   
+/// from a recording instead of being submitted                               
+void GUIItem::KeepIndexed() {
+   auto& spatial = mProducer->GetSpatial();
+   for (auto child : mChildren) {
+      spatial.Keep(*child);
+      child->KeepIndexed();
+   }
+}
+
+/// Check if the item, or any of its ancestors, was culled in the last frame  
+/// Collapsed windows are still submitted, so only their contents are culled  
+///   @return true if the item wasn't submitted because of culling            
+bool GUIItem::IsCulled() const noexcept {
+   if (mCulled)
+      return true;
+   for (auto item = mParent; item; item = item->mParent) {
+      if (item->mCulled or item->mCollapsed)
+         return true;
+   }
+   return false;
+}
+
+/// Check if the group that was just submitted contains the active widget,    
+/// or the widget with keyboard focus                                         
+///   @return true if the group holds the focus                               
+bool GroupHoldsFocus() {
+   // Groups forward the activity of the widgets inside them            
+   if (ImGui::IsItemActive())
+      return true;
+
+   const auto& context = *ImGui::GetCurrentContext();
+   const auto window = ImGui::GetCurrentWindowRead();
+   if (not context.NavId or context.NavWindow != window)
+      return false;
+
+   const auto nav = ImGui::WindowRectRelToAbs(window, window->NavRectRel[0]);
+   return ImRect {ImGui::GetItemRectMin(), ImGui::GetItemRectMax()}.Contains(nav);
+}
+
+/// Check if keyboard navigation happens in the current window                
+///   @return true if the user navigates the window with keyboard or gamepad  
+bool IsNavigating() {
+   const auto& context = *ImGui::GetCurrentContext();
+   return context.IO.NavVisible and context.NavWindow
+      and context.NavWindow->RootWindow == ImGui::GetCurrentWindowRead()->RootWindow;
+}
+
+/// Submit the contents of static items by replaying their recording          
+/// Content is submitted live while hovered, so that static buttons and       
+/// checkboxes remain interactive, and isn't recorded in that state, so       
+/// that hover highlights don't end up in the recording. The same goes for    
+/// content that holds the active widget or keyboard focus, which ImGui       
+/// drops if the widget isn't submitted, and for the whole window while       
+/// it's navigated with the keyboard, so that navigation can enter it         
+void GUIItem::SubmitRecordable() {
+   if (not mRecording or mHasWidgets)
+      return SubmitContents();
+
+   const auto origin = ImGui::GetCursorScreenPos();
+   const float width = ImGui::GetContentRegionAvail().x;
+   const bool valid = mRecording->IsValid(width);
+   const auto size = valid ? mRecording->GetSize() : mSize;
+   const bool hovered = ImGui::IsMouseHoveringRect(
+      origin, {origin.x + size.x, origin.y + size.y});
+   const bool live = hovered or mFocused or mEditing or IsNavigating();
+
+   if (valid and not live) {
+      if (ImGui::IsRectVisible(size))
+         mRecording->Replay(ImGui::GetWindowDrawList(), origin);
+      ImGui::Dummy(size);
+      KeepIndexed();
+      return;
+   }
+
+   if (live) {
+      ImGui::BeginGroup();
+      SubmitContents();
+      ImGui::EndGroup();
+      mFocused = GroupHoldsFocus();
+      return;
+   }
+
+   auto draw = ImGui::GetWindowDrawList();
+   mRecording->Begin(draw);
+   ImGui::BeginGroup();
+   SubmitContents();
+   ImGui::EndGroup();
+   mFocused = GroupHoldsFocus();
+   mRecording->End(draw, origin, ImGui::GetItemRectSize(), width);
+}
+
+/// Resize the edited text of input fields, as ImGui requests                 
+///   @param data - the request                                               
+///   @return always zero                                                     
+int ResizeInput(ImGuiInputTextCallbackData* data) {
+   if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
+      const auto text = static_cast<std::string*>(data->UserData);
+      text->resize(data->BufTextLen);
+      data->Buf = text->data();
+   }
+   return 0;
+}
+
+/// Submit a button that shows the item's icon                                
+/// Buttons without a requested size are as tall as a line of text            
+void GUIItem::SubmitIconButton() {
+   auto size = mRequestedSize;
+   if (size.x <= 0 or size.y <= 0)
+      size = {ImGui::GetFrameHeight(), ImGui::GetFrameHeight()};
+
+   const auto id = mLabel ? mLabel.GetRaw() : "##GUIIcon";
+   if (const auto icon = mProducer->GetIcons().Use(mIcon.Get(), size)) {
+      ImGui::ImageButton(id, icon->mTexture, size, icon->mUV0, icon->mUV1);
+      return;
+   }
+
+   // Too large for the atlas, or the atlas is full                     
+   if (not mIconTexture)
+      mIconTexture = GetTextures().Register(mIcon.Get());
+   ImGui::ImageButton(id, mIconTexture, size);
+}
+
+/// Submit the item's own widget, followed by its children                    
+/// Top-level items only submit their children, as they are windows           
+void GUIItem::SubmitContents() {
+   const auto begin = mLabel.GetRaw();
+   if (mParent) {
+      switch (mKind) {
+      case Kind::Window:
+      case Kind::Label:
+         mProducer->GetTextCache().Label(GetLabelView(), GetWrapWidth());
+         break;
+      case Kind::Button:
+         if (mIcon)
+            SubmitIconButton();
+         else
+            ImGui::Button(begin, mRequestedSize);
+         break;
+      case Kind::Checkbox:
+         // A changed state invalidates any recording that contains it, 
+         // and a click is a commit                                     
+         if (ImGui::Checkbox(begin, &mChecked)) {
+            MarkDirty(DirtyLayout);
+            if (mBoundThing)
+               mProducer->Commit(mBoundThing.Get(), mBoundTrait, Many {mChecked});
+         }
+         break;
+      case Kind::Slider:
+         if (ImGui::SliderFloat(begin, &mValue, mMin, mMax))
+            MarkDirty(DirtyLayout);
+         // Dragging is committed once the slider is released           
+         mEditing = ImGui::IsItemActive();
+         if (mBoundThing and ImGui::IsItemDeactivatedAfterEdit())
+            mProducer->Commit(mBoundThing.Get(), mBoundTrait, Many {mValue});
+         break;
+      case Kind::Input:
+         if (ImGui::InputText(begin, mInput.data(), mInput.capacity() + 1,
+               ImGuiInputTextFlags_CallbackResize, ResizeInput, &mInput))
+            MarkDirty(DirtyLayout);
+         // Typing is committed on enter, or when focus is lost         
+         mEditing = ImGui::IsItemActive();
+         if (mBoundThing and ImGui::IsItemDeactivatedAfterEdit()) {
+            mProducer->Commit(mBoundThing.Get(), mBoundTrait,
+               Many {Text {mInput.data(), mInput.size()}});
+         }
+         break;
+      case Kind::List:
+      case Kind::Table:
+      case Kind::Plot:
+      case Kind::Console:
+      case Kind::Inspector:
+      case Kind::Thumbnails:
+      case Kind::Editor:
+         mWidget->Submit(*this);
+         break;
+      }
+   }
+
+   for (auto child : mChildren)
+      child->Submit();
+}
@@ -6,8 +6,15 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later                                 
 ///                                                                           
 #pragma once
-#include "Common.hpp"
+#include "GUIWidget.hpp"
+#include "GUIRecording.hpp"
+#include "GUILayer.hpp"
+#include "GUISpatial.hpp"
+#include "GUITweens.hpp"
 #include <Flow/Factory.hpp>
+#include <memory>
+#include <string>
+#include <vector>
 
 
 ///                                                                           
@@ -20,9 +27,174 @@ struct GUIItem final : A::UIUnit, ProducedFrom<GUISystem> {
    LANGULUS(PRODUCER) GUISystem;
    LANGULUS_BASES(A::UIUnit);
 
+   /// Kinds of widgets an item can represent                                 
+   enum class Kind : uint8_t {
+      Window,
+      Label,
+      Button,
+      Checkbox,
+      Slider,
+      List,
+      Table,
+      Plot,
+      Console,
+      Inspector,
+      Thumbnails,
+      Editor,
+      Input
+   };
+
+   /// Reasons for an item to be reprocessed by GUISystem::Refresh            
+   enum Dirt : uint8_t {
+      Clean = 0,
+      // The data the item displays has changed and must be reread      
+      DirtyContent = 1,
+      // Item size has changed, or one of its descendants did           
+      DirtyLayout = 2
+   };
+
+   /// Refresh queues of GUISystem a dirty item can wait in                   
+   enum Queue : uint8_t {
+      Unqueued,
+      // Marked dirty since the last refresh                            
+      QueuedDirty,
+      // Deferred by the refresh budget                                 
+      QueuedScheduled,
+      // Waiting for its culled subtree to be displayed again           
+      QueuedParked
+   };
+
+private:
+   friend struct GUISystem;
+   friend struct GUITemplate;
+   friend struct GUISpatial;
+   friend struct GUITweens;
+
+   // Kind of widget                                                    
+   Kind mKind {Kind::Label};
+
+   // The parent item, or nullptr if this item is a top-level window    
+   GUIItem* mParent {};
+   // Child items, in submission order                                  
+   std::vector<GUIItem*> mChildren;
+   // Distance from the top-level item, used to order layout passes     
+   Count mDepth {};
+   // Accumulated dirt, consumed by GUISystem::Refresh                  
+   uint8_t mDirt {DirtyContent | DirtyLayout};
+   // Refresh queue the item waits in, and its place there, so that     
+   // destroyed items leave the queue in constant time                  
+   uint8_t mQueue {Unqueued};
+   uint32_t mQueueIndex {};
+   // Entities this item is subscribed to for change notifications      
+   std::vector<const Thing*> mSources;
+
+   // Text displayed by the item                                        
+   Text mLabel;
+   // Size requested by the descriptor, zero for automatic              
+   ImVec2 mRequestedSize {};
+   // Widget state for checkboxes, sliders and input fields             
+   bool mChecked {};
+   float mValue {};
+   // Range of sliders                                                  
+   float mMin {0};
+   float mMax {1};
+   std::string mInput;
+   // Trait of an entity that the widget edits, if bound - the entity   
+   // is kept alive while bound, so that edits never reach a dead one   
+   Ref<Thing> mBoundThing;
+   TMeta mBoundTrait {};
+   // Whether the widget is being edited, external changes are ignored  
+   bool mEditing {};
+   // Image drawn on a button instead of its label, and its texture if  
+   // it had to be registered on its own, because the atlas refused it  
+   Ref<A::Image> mIcon;
+   ImTextureID mIconTexture {};
+   // Whether a static subtree held the active widget or keyboard focus 
+   // when it was last submitted, so it has to stay live                
+   bool mFocused {};
+   // Animated opacity and displacement, see GUITweens                  
+   float mAlpha {1};
+   ImVec2 mOffset {};
+   // Running tweens of each property                                   
+   uint32_t mTweens[GUITweens::PropertyCount] {
+      GUITweens::None, GUITweens::None, GUITweens::None, GUITweens::None
+   };
+   // State of the more complex widgets, such as lists                  
+   std::unique_ptr<GUIWidget> mWidget;
+   // Recorded geometry of static items, nullptr for dynamic ones       
+   std::unique_ptr<GUIRecording> mRecording;
+   // Offscreen layer of top-level items                                
+   std::unique_ptr<GUILayer> mLayer;
+   // Whether the subtree contains complex widgets - these have their   
+   // own child windows and can't be recorded                           
+   bool mHasWidgets {};
+   // Estimated size of the item, including its children                
+   ImVec2 mSize {};
+   // Number of items in the subtree, including this one                
+   Count mSubtreeCount {1};
+   // Whether the subtree was skipped in the last submission, because   
+   // it was outside the clip rectangle                                 
+   bool mCulled {};
+   // Whether the item is a window that was collapsed or hidden in the  
+   // last submission, which culls everything inside it                 
+   bool mCollapsed {};
+   // Entry of the item in GUISpatial                                   
+   uint32_t mSpatial {GUISpatial::None};
+
+   void Reprocess(uint8_t);
+   void CreateWidget();
+   void ReadBinding();
+   void SubmitRecordable();
+   void SubmitContents();
+   void SubmitIconButton();
+   void Unindex();
+   void KeepIndexed();
+
+   NOD() std::string_view GetLabelView() const noexcept {
+      return {mLabel.GetRaw(), mLabel.GetCount()};
+   }
+
+   /// Labels wrap at the requested width, if any                             
+   NOD() float GetWrapWidth() const noexcept {
+      return mKind == Kind::Label ? mRequestedSize.x : 0;
+   }
+
 public:
    GUIItem(GUISystem*, Describe);
+   ~GUIItem();
 
    void Refresh();
+   void MarkDirty(Dirt = DirtyContent);
+   void Observe(const Thing*, TMeta = {});
+   void Unobserve(const Thing*);
+   void Bind(Thing*, TMeta);
+   void SetIcon(A::Image*);
+   void SetStatic(bool);
+   void Invalidate();
+   void Animate(GUITweens::Property, float to, float duration,
+      GUITweens::Easing = GUITweens::Easing::InOut);
+   NOD() A::Image* CreateImage(ImVec2);
+   NOD() GUITextures& GetTextures() const;
+   void Submit();
+
+   NOD() auto GetKind() const noexcept { return mKind; }
+   NOD() auto GetParent() const noexcept { return mParent; }
+   NOD() auto& GetChildren() const noexcept { return mChildren; }
+   NOD() auto& GetLabel() const noexcept { return mLabel; }
+   NOD() auto GetSize() const noexcept { return mSize; }
+   NOD() auto GetRequestedSize() const noexcept { return mRequestedSize; }
+   NOD() bool IsChecked() const noexcept { return mChecked; }
+   NOD() float GetValue() const noexcept { return mValue; }
+   NOD() float GetAlpha() const noexcept { return mAlpha; }
+   NOD() auto GetOffset() const noexcept { return mOffset; }
+   NOD() auto& GetInput() const noexcept { return mInput; }
+   NOD() auto GetBoundThing() const noexcept { return mBoundThing.Get(); }
+   NOD() auto GetBoundTrait() const noexcept { return mBoundTrait; }
+   NOD() auto GetWidget() const noexcept { return mWidget.get(); }
+   NOD() auto GetRecording() const noexcept { return mRecording.get(); }
+   NOD() bool IsStatic() const noexcept { return mRecording != nullptr; }
+   NOD() auto GetLayer() const noexcept { return mLayer.get(); }
+   NOD() bool IsDirty() const noexcept { return mDirt != Clean; }
+   NOD() bool IsCulled() const noexcept;
 };
 
@@ -0,0 +1,199 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUILayer.hpp"
+#include "GUIItem.hpp"
+#include <Langulus/Image.hpp>
+#include <algorithm>
+
+
+/// Layer destruction                                                         
+GUILayer::~GUILayer() {
+   if (mTextures)
+      mTextures->Release(mImage.Get());
+}
+
+/// Check if the layer should be used                                         
+///   @return true if the window should be drawn from its layer               
+bool GUILayer::IsWanted() const noexcept {
+   switch (mMode) {
+   case Mode::Off:
+      return false;
+   case Mode::Always:
+      return true;
+   default:
+      return not mDynamic
+         and mChangeRate < MaxChangeRate
+         and mVertices >= MinVertices;
+   }
+}
+
+/// Discard the captured image, because the window's content changed          
+/// A capture that is still being drawn is outdated too                       
+void GUILayer::Invalidate() noexcept {
+   mValid = false;
+   mPending = false;
+   mChanged = true;
+}
+
+/// The renderer has drawn a capture into the image                           
+/// Only the last capture makes the layer valid, and only if nothing has      
+/// invalidated it since                                                      
+///   @param serial - the capture that was drawn                              
+void GUILayer::Acknowledge(uint64_t serial) noexcept {
+   if (not mPending or serial != mSerial)
+      return;
+
+   mPending = false;
+   mValid = true;
+}
+
+/// A capture was discarded without being drawn, so the window can be         
+/// captured again                                                            
+///   @param serial - the capture that was discarded                          
+void GUILayer::Drop(uint64_t serial) noexcept {
+   if (serial == mSerial)
+      mPending = false;
+}
+
+/// Update the change frequency, once per drawn frame                         
+void GUILayer::EndFrame() noexcept {
+   mDrawList = nullptr;
+   constexpr float Alpha = 1.0f / 32.0f;
+   mChangeRate += ((mChanged ? 1.0f : 0.0f) - mChangeRate) * Alpha;
+   mChanged = false;
+}
+
+/// Start a frame of the window, right after its ImGui::Begin                 
+/// Called even for collapsed windows, so that their draw lists are known     
+///   @param dynamic - whether the window contains widgets that can change    
+///      without being marked dirty, such as consoles                         
+void GUILayer::Begin(bool dynamic) {
+   mDynamic = dynamic;
+   mDrawList = ImGui::GetWindowDrawList();
+   mCapturing = false;
+}
+
+/// Check if the captured image still matches the current window              
+/// Must be called between ImGui::Begin and ImGui::End of the window          
+///   @param size - current size of the window                                
+///   @return true if the captured image can be composited                    
+bool GUILayer::IsCurrent(ImVec2 size) const {
+   return mValid
+      and size.x == mImageSize.x and size.y == mImageSize.y
+      and ImGui::GetScrollX() == mCapturedScroll.x
+      and ImGui::GetScrollY() == mCapturedScroll.y
+      and ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) == mCapturedFocused;
+}
+
+/// Composite the layer instead of submitting the window's contents           
+/// The window is drawn live while hovered, so that it stays interactive,     
+/// which doesn't count as a change                                           
+/// Must be called between ImGui::Begin and ImGui::End of the window          
+///   @return true if the layer was composited                                
+bool GUILayer::Replay() {
+   const auto pos = ImGui::GetWindowPos();
+   const auto size = ImGui::GetWindowSize();
+   if (not IsWanted())
+      return false;
+
+   if (not IsCurrent(size)) {
+      if (mValid)
+         Invalidate();
+      return false;
+   }
+
+   if (ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows))
+      return false;
+
+   // The layer includes the title bar and borders, so it covers the    
+   // whole window, not just its content region                         
+   auto draw = ImGui::GetWindowDrawList();
+   draw->PushClipRectFullScreen();
+   draw->AddImage(mTexture, pos, {pos.x + size.x, pos.y + size.y});
+   draw->PopClipRect();
+
+   // Keep the content size, so that scrollbars don't change            
+   ImGui::Dummy(mContentSize);
+   return true;
+}
+
+/// Start submitting the window's contents live                               
+/// Unless the window is hovered, the contents are also captured into the     
+/// layer after ImGui::Render                                                 
+/// Must be called between ImGui::Begin and ImGui::End of the window          
+void GUILayer::BeginCapture() {
+   ImGui::BeginGroup();
+   mCapturing = not ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows);
+   mOrigin = ImGui::GetWindowPos();
+   mSize = ImGui::GetWindowSize();
+   mScroll = {ImGui::GetScrollX(), ImGui::GetScrollY()};
+   mFocused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+}
+
+/// Finish submitting the window's contents live                              
+/// Must be called between ImGui::Begin and ImGui::End of the window          
+void GUILayer::EndCapture() {
+   ImGui::EndGroup();
+   mContentSize = ImGui::GetItemRectSize();
+}
+
+/// Measure and capture the window's draw lists after ImGui::Render           
+/// ImGui places the draw lists of child windows right after their parent's,  
+/// so the window owns every list up to the next top-level window             
+///   @param owner - the window item, creates the layer's image               
+///   @param data - the rendered draw data                                    
+///   @param windows - draw lists of all top-level windows                    
+///   @param captures - [out] where to push the capture for the renderer      
+void GUILayer::Capture(GUIItem& owner, const ImDrawData* data, const std::vector<const ImDrawList*>& windows, std::vector<Capture>& captures) {
+   if (not mCapturing or not mDrawList or not data)
+      return;
+   mCapturing = false;
+
+   // Lists are indexed, instead of iterated, because CmdLists is an    
+   // array in some ImGui versions, and an ImVector in others           
+   int first = 0;
+   while (first < data->CmdListsCount and data->CmdLists[first] != mDrawList)
+      ++first;
+   if (first == data->CmdListsCount)
+      return;
+
+   int last = first + 1;
+   while (last < data->CmdListsCount and std::find(windows.begin(),
+      windows.end(), data->CmdLists[last]) == windows.end())
+      ++last;
+
+   // Remember how expensive the window is, for the heuristic           
+   mVertices = 0;
+   for (int n = first; n < last; ++n)
+      mVertices += data->CmdLists[n]->VtxBuffer.Size;
+
+   // A window isn't captured again while the renderer hasn't drawn     
+   // the last capture - if it's outdated by then, it's recaptured      
+   if (not IsWanted() or mPending)
+      return;
+
+   // Recreate the image if the window was resized                      
+   if (not mImage or mImageSize.x != mSize.x or mImageSize.y != mSize.y) {
+      if (mTextures)
+         mTextures->Release(mImage.Get());
+      mImage = owner.CreateImage(mSize);
+      mImageSize = mSize;
+      mTextures = &owner.GetTextures();
+      mTexture = mTextures->Register(mImage.Get());
+   }
+
+   Capture capture {mImage.Get(), mOrigin, mSize, {}, this, ++mSerial};
+   for (int n = first; n < last; ++n)
+      capture.mLists.emplace_back(data->CmdLists[n]->CloneOutput());
+   captures.emplace_back(std::move(capture));
+
+   mCapturedScroll = mScroll;
+   mCapturedFocused = mFocused;
+   mPending = true;
+   mValid = false;
+}
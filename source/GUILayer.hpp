@@ -0,0 +1,115 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUITextures.hpp"
+#include <memory>
+#include <vector>
+
+
+///                                                                           
+///   Cached window layer                                                     
+///                                                                           
+/// A top-level window that is rendered into an offscreen image once, and     
+/// then composited as a single textured quad every frame, until its          
+/// content, size, scroll or focus changes. In automatic mode a layer is      
+/// used only for windows that are expensive to draw and rarely change.       
+/// A layer is replayed only after the renderer acknowledges that it has      
+/// drawn the capture into the image, so a blank image is never composited    
+///                                                                           
+struct GUILayer {
+   enum class Mode : uint8_t {
+      // Never cache the window                                         
+      Off,
+      // Cache the window when the heuristic deems it worthwhile        
+      Auto,
+      // Always cache the window                                        
+      Always
+   };
+
+   struct ListDeleter {
+      void operator () (ImDrawList* list) const { IM_DELETE(list); }
+   };
+   using ListPtr = std::unique_ptr<ImDrawList, ListDeleter>;
+
+   /// Window contents that the renderer has to draw into a layer's image     
+   /// Lists are to be drawn with a projection that maps mOrigin to the       
+   /// image's top-left corner. Once drawn, the renderer acknowledges the     
+   /// capture via GUISystem::AcknowledgeCapture                              
+   struct Capture {
+      A::Image* mImage;
+      ImVec2 mOrigin;
+      ImVec2 mSize;
+      std::vector<ListPtr> mLists;
+      // The layer that is waiting for the capture, and which one it is 
+      GUILayer* mLayer;
+      uint64_t mSerial;
+   };
+
+   // Windows with fewer vertices than this are cheaper to draw directly
+   static constexpr Count MinVertices = 2048;
+   // Automatic layers are used only below this many changes per frame  
+   static constexpr float MaxChangeRate = 1.0f / 30.0f;
+
+private:
+   Mode mMode {Mode::Auto};
+   Ref<A::Image> mImage;
+   ImVec2 mImageSize {};
+   // Identifier of the image in the registry it was created for        
+   GUITextures* mTextures {};
+   ImTextureID mTexture {};
+   // State of the window when it was last submitted live               
+   ImVec2 mOrigin {};
+   ImVec2 mSize {};
+   ImVec2 mContentSize {};
+   ImVec2 mScroll {};
+   bool mFocused {};
+   // State of the window in the captured image                         
+   ImVec2 mCapturedScroll {};
+   bool mCapturedFocused {};
+   bool mValid {};
+   // The last capture, and whether the renderer has yet to draw it     
+   uint64_t mSerial {};
+   bool mPending {};
+   // Automatic layers aren't used for windows with dynamic widgets     
+   bool mDynamic {};
+   // Draw list of the window in the current frame, nullptr if the      
+   // window wasn't submitted or is collapsed                           
+   const ImDrawList* mDrawList {};
+   // Whether the window was submitted live, and should be captured     
+   bool mCapturing {};
+   // Exponential moving average of changes per frame                   
+   float mChangeRate {1};
+   bool mChanged {};
+   // Vertices the window emitted the last time it was drawn live       
+   Count mVertices {};
+
+   NOD() bool IsCurrent(ImVec2 size) const;
+
+public:
+   GUILayer(Mode mode = Mode::Auto) : mMode {mode} {}
+   ~GUILayer();
+
+   void Begin(bool dynamic);
+   bool Replay();
+   void BeginCapture();
+   void EndCapture();
+   void Capture(GUIItem&, const ImDrawData*, const std::vector<const ImDrawList*>& windows, std::vector<Capture>&);
+   void Acknowledge(uint64_t serial) noexcept;
+   void Drop(uint64_t serial) noexcept;
+   void Invalidate() noexcept;
+   void EndFrame() noexcept;
+
+   NOD() bool IsWanted() const noexcept;
+   NOD() bool IsValid() const noexcept { return mValid; }
+   NOD() bool IsPending() const noexcept { return mPending; }
+   NOD() auto GetMode() const noexcept { return mMode; }
+   NOD() auto GetDrawList() const noexcept { return mDrawList; }
+   NOD() float GetChangeRate() const noexcept { return mChangeRate; }
+   NOD() Count GetVertexCount() const noexcept { return mVertices; }
+};
+
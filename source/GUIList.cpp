@@ -0,0 +1,402 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIList.hpp"
+#include "GUI.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+
+/// Source construction                                                       
+///   @param data - the container to display                                  
+GUIList::ManySource::ManySource(const Many& data)
+   : mData {data} {}
+
+/// Get the number of rows                                                    
+///   @return the number of elements in the container                         
+Count GUIList::ManySource::GetRowCount() const {
+   return mData.GetCount();
+}
+
+/// Get the number of columns                                                 
+///   @return the number of elements in the first row, if container is deep   
+Count GUIList::ManySource::GetColumnCount() const {
+   if (not mData.IsDeep() or mData.IsEmpty())
+      return 1;
+   return std::max<Count>(1, mData.template As<Many>(0).GetCount());
+}
+
+/// Get the text of a single cell                                             
+///   @param row - the data row                                               
+///   @param column - the column                                              
+///   @param output - [out] the text of the cell                              
+void GUIList::ManySource::GetCell(Offset row, Offset column, Text& output) const {
+   if (mData.IsDeep()) {
+      auto& cells = mData.template As<Many>(row);
+      if (column < cells.GetCount())
+         output = cells.GetElement(column).template AsCast<Text>();
+      else
+         output.Clear();
+   }
+   else output = mData.GetElement(row).template AsCast<Text>();
+}
+
+
+/// Sort key construction                                                     
+/// Text that is entirely a number, that isn't NaN, is sorted as a number     
+///   @param text - the text of the cell                                      
+GUIList::SortKey::SortKey(const Token& text)
+   : mText {text} {
+   const auto end = text.data() + text.size();
+   const auto parsed = std::from_chars(text.data(), end, mNumber);
+   mNumeric = parsed.ec == std::errc {} and parsed.ptr == end
+      and not std::isnan(mNumber);
+}
+
+/// Compare two sort keys                                                     
+///   @param rhs - the key to compare with                                    
+///   @return true if this key is ordered before rhs                          
+bool GUIList::SortKey::operator < (const SortKey& rhs) const noexcept {
+   if (mNumeric != rhs.mNumeric)
+      return mNumeric;
+   if (mNumeric)
+      return mNumber < rhs.mNumber;
+   return mText < rhs.mText;
+}
+
+/// Case-insensitive substring search                                         
+///   @param haystack - the text to search in                                 
+///   @param needle - the lowercase text to search for                        
+///   @return true if needle is found in haystack                             
+bool ContainsNoCase(const Token& haystack, const Token& needle) {
+   return std::search(
+      haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+      [](char a, char b) {
+         return std::tolower(static_cast<unsigned char>(a)) == b;
+      }
+   ) != haystack.end();
+}
+
+/// List construction                                                         
+///   @param system - the system that owns the background workers             
+///   @param table - whether to display columns as a table                    
+GUIList::GUIList(GUISystem* system, bool table)
+   : mSystem {system}
+   , mTable {table}
+   , mShared {std::make_shared<Shared>()} {}
+
+/// Bind a new data source, resetting the row index                           
+///   @param source - the source to bind                                      
+void GUIList::SetSource(std::shared_ptr<const Source> source) {
+   mSource = std::move(source);
+   mCells.reset();
+   mCopy.reset();
+   mCopiedRows = 0;
+   mAwaitingCopy = false;
+   mIndex.reset();
+   RequestIndex();
+}
+
+/// Bind a Langulus container as data source                                  
+///   @param data - the container to display                                  
+void GUIList::SetData(const Many& data) {
+   SetSource(std::make_shared<ManySource>(data));
+}
+
+/// Get the number of displayed rows                                          
+///   @return the number of rows after filtering                              
+Count GUIList::GetRowCount() const noexcept {
+   if (mIndex)
+      return mIndex->size();
+   return mSource ? mSource->GetRowCount() : 0;
+}
+
+/// Map a displayed row to the data row it represents                         
+///   @param row - the displayed row                                          
+///   @return the data row                                                    
+Offset GUIList::GetDataRow(Offset row) const noexcept {
+   return mIndex ? (*mIndex)[row] : row;
+}
+
+/// Request a new row index for the current filter and sort settings          
+/// The work is done on the background workers; any job still in progress     
+/// becomes stale and its result will be discarded                            
+void GUIList::RequestIndex() {
+   const auto generation = ++mShared->mGeneration;
+   if (not mSource or (not mFilter[0] and mSortColumn < 0)) {
+      // Rows map to data one to one, no need for a job                 
+      mIndex.reset();
+      mPendingJob = false;
+      mAwaitingCopy = false;
+      return;
+   }
+
+   // Sources that can't be read by the workers are copied first, and   
+   // the copy is shared by all later jobs. The job is started once the 
+   // copy is complete, see Submit                                      
+   if (not mSource->IsThreadSafe() and not CopyCells()) {
+      mPendingJob = true;
+      mAwaitingCopy = true;
+      return;
+   }
+
+   // Lowercase the filter once, the job compares against it            
+   std::string filter {mFilter};
+   for (auto& c : filter)
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+   const Count rows = mSource->GetRowCount();
+   const Count columns = mSource->GetColumnCount();
+   mPendingJob = true;
+   mSystem->GetWorkers().Push([
+      shared = mShared, source = mSource, cells = mCells, rows, columns,
+      generation, filter, column = mSortColumn, descending = mSortDescending
+   ] {
+      const auto stale = [&] {
+         return shared->mGeneration.load(std::memory_order_relaxed) != generation;
+      };
+
+      Text cell;
+      const auto read = [&](Offset row, Offset c) -> Token {
+         if (cells) {
+            const auto& copy = (*cells)[row * columns + c];
+            return {copy.data(), copy.size()};
+         }
+
+         source->GetCell(row, c, cell);
+         return Token {cell};
+      };
+
+      const Token needle {filter.data(), filter.size()};
+      Index index;
+      index.reserve(rows);
+
+      // Filter - a row passes if any of its cells contains the filter  
+      for (Offset row = 0; row < rows; ++row) {
+         if ((row & 0xFFF) == 0 and stale())
+            return;
+
+         if (not filter.empty()) {
+            bool match = false;
+            for (Offset c = 0; c < columns and not match; ++c)
+               match = ContainsNoCase(read(row, c), needle);
+
+            if (not match)
+               continue;
+         }
+
+         index.push_back(static_cast<uint32_t>(row));
+      }
+
+      // Sort - numbers before text, see SortKey                        
+      if (column >= 0 and static_cast<Count>(column) < columns) {
+         std::vector<SortKey> keys(index.size());
+         for (Offset i = 0; i < index.size(); ++i) {
+            if ((i & 0xFFF) == 0 and stale())
+               return;
+            keys[i] = SortKey {read(index[i], column)};
+         }
+
+         if (stale())
+            return;
+
+         std::vector<uint32_t> order(index.size());
+         std::iota(order.begin(), order.end(), 0u);
+         std::stable_sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) {
+               return descending ? keys[b] < keys[a] : keys[a] < keys[b];
+            }
+         );
+
+         Index sorted(index.size());
+         for (Offset i = 0; i < order.size(); ++i)
+            sorted[i] = index[order[i]];
+         index = std::move(sorted);
+      }
+
+      if (stale())
+         return;
+
+      Publish(*shared, new Result {generation, std::move(index)});
+   });
+}
+
+/// Copy the next chunk of cells of a source that can't be read by the        
+/// background workers                                                        
+///   @return true if all cells are copied                                    
+bool GUIList::CopyCells() {
+   if (mCells)
+      return true;
+
+   const Count rows = mSource->GetRowCount();
+   const Count columns = mSource->GetColumnCount();
+   if (not mCopy) {
+      mCopy = std::make_shared<Cells>();
+      mCopy->reserve(rows * columns);
+   }
+
+   const auto end = std::min(rows,
+      mCopiedRows + std::max<Count>(1, CopyChunk / columns));
+   for (; mCopiedRows < end; ++mCopiedRows) {
+      for (Offset c = 0; c < columns; ++c) {
+         mSource->GetCell(mCopiedRows, c, mCell);
+         const Token token {mCell};
+         mCopy->emplace_back(token.data(), token.size());
+      }
+   }
+
+   if (mCopiedRows < rows)
+      return false;
+
+   mCells = std::move(mCopy);
+   return true;
+}
+
+/// Publish a finished index, unless a newer one is already waiting           
+/// Jobs may finish out of order, so a stale job that passed its last check   
+/// must not replace the result of a newer one. Results are only ever         
+/// dereferenced by whoever took them out, so this is safe while the widget   
+/// consumes results concurrently                                             
+///   @param shared - the state shared with the widget                        
+///   @param result - the result to publish, ownership is taken               
+void GUIList::Publish(Shared& shared, Result* result) {
+   while (result) {
+      const auto previous = shared.mPending.exchange(result);
+      if (not previous or previous->mGeneration < result->mGeneration) {
+         delete previous;
+         return;
+      }
+
+      // A newer result was taken out - put it back, and take out       
+      // whatever is there now                                          
+      result = previous;
+   }
+}
+
+/// Swap in the latest finished index, if it's still relevant                 
+void GUIList::ConsumeIndex() {
+   const auto result = mShared->mPending.exchange(nullptr);
+   if (not result)
+      return;
+
+   if (result->mGeneration == mShared->mGeneration.load()) {
+      mIndex = std::make_unique<Index>(std::move(result->mRows));
+      mPendingJob = false;
+   }
+
+   delete result;
+}
+
+/// Submit a single row                                                       
+///   @param row - the displayed row                                          
+///   @param columns - number of columns to submit                            
+void GUIList::SubmitRow(Offset row, Count columns) {
+   const auto data = GetDataRow(row);
+
+   for (Offset c = 0; c < columns; ++c) {
+      if (mTable) {
+         if (c == 0)
+            ImGui::TableNextRow();
+         ImGui::TableSetColumnIndex(static_cast<int>(c));
+      }
+
+      mSource->GetCell(data, c, mCell);
+      const Token token {mCell};
+      ImGui::TextUnformatted(token.data(), token.data() + token.size());
+   }
+
+   ++mSubmittedRows;
+}
+
+/// Submit the visible rows of the list                                       
+///   @param item - the item that owns the list                               
+void GUIList::Submit(GUIItem& item) {
+   if (mAwaitingCopy and CopyCells()) {
+      mAwaitingCopy = false;
+      RequestIndex();
+   }
+
+   ConsumeIndex();
+   mSubmittedRows = 0;
+   ImGui::PushID(this);
+
+   if (ImGui::InputTextWithHint("##filter", "Filter", mFilter, sizeof(mFilter)))
+      RequestIndex();
+   if (mPendingJob) {
+      ImGui::SameLine();
+      ImGui::TextDisabled("(updating)");
+   }
+
+   if (not mSource) {
+      ImGui::TextDisabled("No data");
+      ImGui::PopID();
+      return;
+   }
+
+   const auto rows = static_cast<int>(GetRowCount());
+   const auto size = item.GetRequestedSize();
+
+   if (mTable) {
+      const auto columns = static_cast<int>(
+         std::min<Count>(mSource->GetColumnCount(), 64));
+      constexpr auto flags = ImGuiTableFlags_ScrollY
+         | ImGuiTableFlags_RowBg
+         | ImGuiTableFlags_BordersOuter
+         | ImGuiTableFlags_BordersV
+         | ImGuiTableFlags_Resizable
+         | ImGuiTableFlags_Sortable
+         | ImGuiTableFlags_SortTristate;
+
+      if (ImGui::BeginTable("##table", columns, flags, size)) {
+         ImGui::TableSetupScrollFreeze(0, 1);
+         for (int c = 0; c < columns; ++c) {
+            char name[16];
+            std::snprintf(name, sizeof(name), "%d", c);
+            ImGui::TableSetupColumn(name);
+         }
+         ImGui::TableHeadersRow();
+
+         // Sorting changed - request a new index in the background     
+         if (auto specs = ImGui::TableGetSortSpecs(); specs and specs->SpecsDirty) {
+            if (specs->SpecsCount > 0) {
+               mSortColumn = specs->Specs[0].ColumnIndex;
+               mSortDescending = specs->Specs[0].SortDirection
+                  == ImGuiSortDirection_Descending;
+            }
+            else mSortColumn = -1;
+
+            specs->SpecsDirty = false;
+            RequestIndex();
+         }
+
+         ImGuiListClipper clipper;
+         clipper.Begin(rows);
+         while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+               SubmitRow(row, columns);
+         }
+
+         ImGui::EndTable();
+      }
+   }
+   else {
+      if (ImGui::BeginChild("##list", size)) {
+         ImGuiListClipper clipper;
+         clipper.Begin(rows);
+         while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+               SubmitRow(row, 1);
+         }
+      }
+      ImGui::EndChild();
+   }
+
+   ImGui::PopID();
+}
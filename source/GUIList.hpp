@@ -0,0 +1,147 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIWidget.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+///                                                                           
+///   Virtualized list and table                                              
+///                                                                           
+/// Only the visible rows are submitted, through ImGuiListClipper, so the     
+/// cost of building the widget doesn't depend on the number of rows.         
+/// Rows are mapped to data through a stable index, that is produced by       
+/// sorting and filtering on the system's background workers, and swapped     
+/// in atomically once ready. Until then, the previous index is displayed     
+///                                                                           
+struct GUIList final : GUIWidget {
+   ///                                                                        
+   ///   Data provider for the list                                           
+   ///                                                                        
+   /// Must not change after it is bound - bind a new source to change the    
+   /// data. Sources are read on the main thread, unless they report that     
+   /// they're safe to read from multiple threads at once. Other sources are  
+   /// copied before they're sorted or filtered, a chunk per frame            
+   ///                                                                        
+   struct Source {
+      virtual ~Source() = default;
+      NOD() virtual Count GetRowCount() const = 0;
+      NOD() virtual Count GetColumnCount() const { return 1; }
+      NOD() virtual bool IsThreadSafe() const { return false; }
+      virtual void GetCell(Offset row, Offset column, Text&) const = 0;
+   };
+
+   ///                                                                        
+   ///   Source that displays the elements of a Langulus container            
+   ///                                                                        
+   /// Each element is a row. If the container is deep, each element's        
+   /// own elements are the columns                                           
+   ///                                                                        
+   struct ManySource final : Source {
+      Many mData;
+
+      ManySource(const Many&);
+      Count GetRowCount() const override;
+      Count GetColumnCount() const override;
+      void GetCell(Offset, Offset, Text&) const override;
+   };
+
+   ///                                                                        
+   ///   Sort key of a cell                                                   
+   ///                                                                        
+   /// Numbers are ordered before text. Numbers are compared by value, and    
+   /// text lexicographically, so that mixed columns are ordered strictly     
+   ///                                                                        
+   struct SortKey {
+      std::string mText;
+      double mNumber {};
+      bool mNumeric {};
+
+      SortKey() = default;
+      SortKey(const Token&);
+
+      NOD() bool operator < (const SortKey&) const noexcept;
+   };
+
+   // Row index - maps displayed rows to data rows                      
+   using Index = std::vector<uint32_t>;
+
+   /// Index produced in the background, tagged with its request              
+   struct Result {
+      uint64_t mGeneration;
+      Index mRows;
+   };
+
+   /// State shared with the background jobs, so that jobs can outlive        
+   /// the widget safely                                                      
+   struct Shared {
+      // Incremented on each request, stale jobs bail out early         
+      std::atomic<uint64_t> mGeneration {};
+      // The newest finished result, waiting to be swapped in           
+      std::atomic<Result*> mPending {};
+
+      ~Shared() { delete mPending.load(); }
+   };
+
+   static void Publish(Shared&, Result*);
+
+   // Cells copied from sources that can't be read by the workers, per  
+   // frame, so that large sources don't stall a single frame           
+   static constexpr Count CopyChunk = 16384;
+
+private:
+   // Text of every cell, row by row, copied from sources that can't be 
+   // read by the background workers                                    
+   using Cells = std::vector<std::string>;
+
+   GUISystem* mSystem;
+   bool mTable;
+   std::shared_ptr<const Source> mSource;
+   std::shared_ptr<const Cells> mCells;
+   // Copy in progress, and the number of rows copied so far            
+   std::shared_ptr<Cells> mCopy;
+   Count mCopiedRows {};
+   // Whether a job waits for the copy to finish                        
+   bool mAwaitingCopy {};
+   std::shared_ptr<Shared> mShared;
+   // Current row index, or empty if rows map to data one to one        
+   std::unique_ptr<Index> mIndex;
+   // Whether a background job is still running                         
+   bool mPendingJob {};
+
+   // Filter and sort state                                             
+   char mFilter[128] {};
+   int mSortColumn {-1};
+   bool mSortDescending {};
+
+   // Number of rows submitted in the last frame                        
+   Count mSubmittedRows {};
+   // Reused for the text of each submitted cell                        
+   Text mCell;
+
+   void RequestIndex();
+   void ConsumeIndex();
+   NOD() bool CopyCells();
+   void SubmitRow(Offset row, Count columns);
+
+public:
+   GUIList(GUISystem*, bool table);
+
+   void SetSource(std::shared_ptr<const Source>);
+   void SetData(const Many&) override;
+   void Submit(GUIItem&) override;
+
+   NOD() Count GetRowCount() const noexcept;
+   NOD() Offset GetDataRow(Offset row) const noexcept;
+   NOD() Count GetSubmittedRows() const noexcept { return mSubmittedRows; }
+   NOD() bool IsIndexPending() const noexcept { return mPendingJob; }
+};
+
@@ -0,0 +1,127 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIOcclusion.hpp"
+#include <imgui_internal.h>
+#include <algorithm>
+
+
+/// Check if a window hides everything behind it                              
+/// Only the style is consulted, so windows are opaque only if the style's    
+/// background color has no transparency                                      
+///   @param window - the window to check                                     
+///   @param style - the style the window was drawn with                      
+///   @return true if nothing is visible through the window                   
+bool GUIOcclusion::IsOpaque(const ImGuiWindow* window, const ImGuiStyle& style) {
+   if (window->Collapsed or (window->Flags & ImGuiWindowFlags_NoBackground))
+      return false;
+
+   auto color = ImGuiCol_WindowBg;
+   if (window->Flags & ImGuiWindowFlags_ChildWindow)
+      color = ImGuiCol_ChildBg;
+   else if (window->Flags & (ImGuiWindowFlags_Popup | ImGuiWindowFlags_Tooltip))
+      color = ImGuiCol_PopupBg;
+
+   return style.Colors[color].w * style.Alpha >= 1.0f;
+}
+
+/// Check if a clip rectangle is entirely inside one of the occluders         
+///   @param clip - the clip rectangle                                        
+///   @return true if nothing inside the rectangle is visible                 
+bool GUIOcclusion::IsCovered(const ImVec4& clip) const noexcept {
+   for (auto& o : mOccluders) {
+      if (clip.x >= o.x and clip.y >= o.y and clip.z <= o.z and clip.w <= o.w)
+         return true;
+   }
+   return false;
+}
+
+/// Remove the covered commands of a draw list                                
+/// Callbacks are always kept, because they might not draw anything           
+/// within their clip rectangle                                               
+///   @param data - the draw data, its totals are updated                     
+///   @param list - the list to trim                                          
+void GUIOcclusion::Trim(ImDrawData* data, ImDrawList* list) {
+   auto& commands = list->CmdBuffer;
+   int kept = 0;
+   for (int i = 0; i < commands.Size; ++i) {
+      const auto& cmd = commands[i];
+      if (not cmd.UserCallback and IsCovered(cmd.ClipRect)) {
+         ++mCulledCommands;
+         mCulledArea += (cmd.ClipRect.z - cmd.ClipRect.x)
+                      * (cmd.ClipRect.w - cmd.ClipRect.y);
+         continue;
+      }
+
+      if (kept != i)
+         commands[kept] = cmd;
+      ++kept;
+   }
+
+   if (kept == commands.Size)
+      return;
+
+   commands.resize(kept);
+   if (kept)
+      return;
+
+   // Nothing is left to draw, so there's nothing to upload either      
+   ++mCulledLists;
+   mCulledVertices += list->VtxBuffer.Size;
+   data->TotalVtxCount -= list->VtxBuffer.Size;
+   data->TotalIdxCount -= list->IdxBuffer.Size;
+   list->VtxBuffer.resize(0);
+   list->IdxBuffer.resize(0);
+}
+
+/// Cull the draw data of the current frame                                   
+/// Lists are ordered back to front, with child windows right after their     
+/// parents, so walking them in reverse visits every window after all of      
+/// the windows in front of it                                                
+///   @param data - the draw data to cull                                     
+void GUIOcclusion::Cull(ImDrawData* data) {
+   mCulledLists = mCulledCommands = mCulledVertices = 0;
+   mCulledArea = 0;
+   if (not data)
+      return;
+
+   const auto& context = *ImGui::GetCurrentContext();
+   mWindows.clear();
+   for (auto window : context.Windows) {
+      if (window->Active and not window->Hidden)
+         mWindows.emplace(window->DrawList, window);
+   }
+
+   mOccluders.clear();
+   for (int n = data->CmdListsCount - 1; n >= 0; --n) {
+      const auto list = data->CmdLists[n];
+      if (not mOccluders.empty())
+         Trim(data, list);
+
+      // A window doesn't hide itself, so it becomes an occluder only   
+      // after its own list was trimmed                                 
+      const auto found = mWindows.find(list);
+      if (found == mWindows.end() or not IsOpaque(found->second, context.Style))
+         continue;
+
+      // Rounded corners aren't opaque, so shrink the rectangle by the  
+      // rounding on all sides, to stay conservative. Child windows can 
+      // extend past their scrolled parent, so only the part of them    
+      // that is visible hides anything                                 
+      const auto window = found->second;
+      const float inset = std::max(window->WindowRounding, window->WindowBorderSize);
+      ImRect occluder {
+         window->Pos.x + inset,
+         window->Pos.y + inset,
+         window->Pos.x + window->Size.x - inset,
+         window->Pos.y + window->Size.y - inset
+      };
+      occluder.ClipWithFull(window->OuterRectClipped);
+      if (occluder.Min.x < occluder.Max.x and occluder.Min.y < occluder.Max.y)
+         mOccluders.push_back(occluder.ToVec4());
+   }
+}
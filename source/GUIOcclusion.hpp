@@ -0,0 +1,49 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <unordered_map>
+#include <vector>
+
+struct ImGuiWindow;
+
+
+///                                                                           
+///   Occlusion culling of draw commands                                      
+///                                                                           
+/// Runs after ImGui::Render, walking the draw lists from front to back.      
+/// Commands whose clip rectangle is entirely behind an opaque window are     
+/// removed, and lists that lose all of their commands are emptied, so that   
+/// they are neither uploaded nor rasterized                                  
+///                                                                           
+struct GUIOcclusion {
+private:
+   // Windows by their draw list, rebuilt every frame                   
+   std::unordered_map<const ImDrawList*, const ImGuiWindow*> mWindows;
+   // Opaque rectangles of the windows in front of the current list     
+   std::vector<ImVec4> mOccluders;
+
+   // Statistics of the last culled frame                               
+   Count mCulledLists {};
+   Count mCulledCommands {};
+   Count mCulledVertices {};
+   float mCulledArea {};
+
+   NOD() static bool IsOpaque(const ImGuiWindow*, const ImGuiStyle&);
+   NOD() bool IsCovered(const ImVec4&) const noexcept;
+   void Trim(ImDrawData*, ImDrawList*);
+
+public:
+   void Cull(ImDrawData*);
+
+   NOD() Count GetCulledLists() const noexcept { return mCulledLists; }
+   NOD() Count GetCulledCommands() const noexcept { return mCulledCommands; }
+   NOD() Count GetCulledVertices() const noexcept { return mCulledVertices; }
+   NOD() float GetCulledArea() const noexcept { return mCulledArea; }
+};
+
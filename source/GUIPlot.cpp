@@ -0,0 +1,331 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIPlot.hpp"
+#include "GUI.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static_assert(sizeof(ImDrawVert) == 5 * sizeof(float),
+   "GUIPlot::Emit relies on the default ImDrawVert layout");
+
+
+/// Append a single sample                                                    
+/// Only the pyramid entries completed by the sample are propagated to the    
+/// next level, so level L is touched once every 2^(L-1) samples              
+///   @param value - the sample                                               
+void GUIPlot::Append(float value) {
+   mSamples.push_back(value);
+
+   Offset child = mSamples.size() - 1;
+   MinMax completed {value, value};
+   for (Count level = 1; ; ++level) {
+      if (mLevels.size() < level)
+         mLevels.emplace_back();
+
+      auto& entries = mLevels[level - 1];
+      const Offset parent = child >> 1;
+      if (parent == entries.size())
+         entries.push_back(completed);
+      else
+         entries.back().Merge(completed);
+
+      // Parent is complete only after its second child                 
+      if (not (child & 1))
+         break;
+
+      completed = entries.back();
+      child = parent;
+   }
+}
+
+/// Append a batch of samples                                                 
+///   @param values - the samples                                             
+///   @param count - number of samples                                        
+void GUIPlot::Append(const float* values, Count count) {
+   mSamples.reserve(mSamples.size() + count);
+   for (Offset i = 0; i < count; ++i)
+      Append(values[i]);
+}
+
+/// Remove all samples                                                        
+void GUIPlot::Clear() {
+   mSamples.clear();
+   mLevels.clear();
+   mViewBegin = mViewEnd = 0;
+}
+
+/// Replace the samples with the contents of a container                      
+///   @param data - the samples, must be convertible to real numbers          
+void GUIPlot::SetData(const Many& data) {
+   Clear();
+   mSamples.reserve(data.GetCount());
+   for (Offset i = 0; i < data.GetCount(); ++i)
+      Append(data.template AsCast<float>(i));
+}
+
+/// Get the value range of a single pyramid entry                             
+/// Incomplete entries are combined with their partial child on the fly,      
+/// which costs at most one step per level                                    
+///   @param level - the pyramid level                                        
+///   @param entry - the entry index                                          
+///   @return the value range of the samples covered by the entry             
+GUIPlot::MinMax GUIPlot::Query(Count level, Offset entry) const {
+   if (level == 0)
+      return {mSamples[entry], mSamples[entry]};
+
+   const Offset samples = mSamples.size();
+   const auto& entries = mLevels[level - 1];
+   if (((entry + 1) << level) <= samples)
+      return entries[entry];
+
+   // Incomplete entry - its completed child, if any, is already stored 
+   const Offset childSpan = Offset {1} << (level - 1);
+   const Offset complete = (samples - (entry << level)) / childSpan;
+   const Offset partial = (entry << 1) + complete;
+   if (partial * childSpan >= samples)
+      return entries[entry];
+
+   auto result = Query(level - 1, partial);
+   if (complete)
+      result.Merge(entries[entry]);
+   return result;
+}
+
+/// Get the value range of a range of samples, at a given level of detail     
+/// The range is extended to the boundaries of the level's entries            
+///   @param level - the pyramid level                                        
+///   @param begin - the first sample                                         
+///   @param end - the sample after the last one                              
+///   @return the value range                                                 
+GUIPlot::MinMax GUIPlot::QueryRange(Count level, Offset begin, Offset end) const {
+   const Offset last = (end - 1) >> level;
+   auto result = Query(level, begin >> level);
+   for (Offset entry = (begin >> level) + 1; entry <= last; ++entry)
+      result.Merge(Query(level, entry));
+   return result;
+}
+
+/// Emit the min/max envelope of mColumns as a triangle strip, two vertices   
+/// per column, written directly into the draw list                           
+///   @param draw - the draw list                                             
+///   @param min - top-left corner of the plot                                
+///   @param max - bottom-right corner of the plot                            
+///   @param range - value range mapped to the height of the plot             
+///   @param color - color of the envelope                                    
+void GUIPlot::Emit(ImDrawList* draw, const ImVec2& min, const ImVec2& max, const MinMax& range, ImU32 color) {
+   const Count columns = mColumns.size();
+   if (columns < 2)
+      return;
+
+   // Map values to screen - y grows downwards                          
+   const float spread = range.mMax - range.mMin;
+   const float scale = spread > 0 ? -(max.y - min.y - 2.0f) / spread : 0.0f;
+   const float offset = spread > 0
+      ? max.y - 1.0f - range.mMin * scale
+      : (min.y + max.y) * 0.5f;
+
+   const Count vtxCount = columns * 2;
+   const Count idxCount = (columns - 1) * 6;
+   draw->PrimReserve(static_cast<int>(idxCount), static_cast<int>(vtxCount));
+   const auto base = draw->_VtxCurrentIdx;
+   const auto uv = ImGui::GetFontTexUvWhitePixel();
+   auto vtx = draw->_VtxWritePtr;
+   auto idx = draw->_IdxWritePtr;
+   float x = min.x + 0.5f;
+   Offset c = 0;
+
+#if GUI_SSE2
+   // The color is packed bits, so it's kept in integer lanes and merged
+   // into the vertices bitwise, it's never loaded as a float           
+   const auto bits = static_cast<int>(color);
+   const __m128i vColor[4] {
+      _mm_setr_epi32(bits, 0, 0, 0),
+      _mm_setr_epi32(0, bits, 0, 0),
+      _mm_setr_epi32(0, 0, bits, 0),
+      _mm_setr_epi32(0, 0, 0, bits)
+   };
+   const auto store = [](float* out, __m128 v, __m128i colored) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+         _mm_or_si128(_mm_castps_si128(v), colored));
+   };
+
+   const auto vScale = _mm_set1_ps(scale);
+   const auto vOffset = _mm_set1_ps(offset);
+   const auto vOne = _mm_set1_ps(1.0f);
+   alignas(16) float low[4];
+   alignas(16) float high[4];
+
+   for (; c + 4 <= columns; c += 4) {
+      // Deinterleave four min/max pairs and map them to screen         
+      const auto a = _mm_loadu_ps(&mColumns[c].mMin);
+      const auto b = _mm_loadu_ps(&mColumns[c + 2].mMin);
+      const auto mins = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+      const auto maxs = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+      const auto yLow = _mm_add_ps(vOffset, _mm_mul_ps(mins, vScale));
+      auto yHigh = _mm_add_ps(vOffset, _mm_mul_ps(maxs, vScale));
+      // Keep the envelope at least a pixel thick                       
+      yHigh = _mm_min_ps(yHigh, _mm_sub_ps(yLow, vOne));
+      _mm_store_ps(low, yLow);
+      _mm_store_ps(high, yHigh);
+
+      // Four vertices of two columns are exactly five 16-byte stores   
+      for (int pair = 0; pair < 4; pair += 2) {
+         const float x0 = x;
+         const float x1 = x + 1.0f;
+         auto out = reinterpret_cast<float*>(vtx);
+         _mm_storeu_ps(out + 0, _mm_setr_ps(x0, low[pair], uv.x, uv.y));
+         store(out +  4, _mm_setr_ps(0, x0, high[pair], uv.x), vColor[0]);
+         store(out +  8, _mm_setr_ps(uv.y, 0, x1, low[pair + 1]), vColor[1]);
+         store(out + 12, _mm_setr_ps(uv.x, uv.y, 0, x1), vColor[2]);
+         store(out + 16, _mm_setr_ps(high[pair + 1], uv.x, uv.y, 0), vColor[3]);
+         vtx += 4;
+         x += 2.0f;
+      }
+   }
+#endif
+
+   for (; c < columns; ++c) {
+      const float yLow = offset + mColumns[c].mMin * scale;
+      const float yHigh = std::min(offset + mColumns[c].mMax * scale, yLow - 1.0f);
+      vtx[0] = {{x, yLow}, uv, color};
+      vtx[1] = {{x, yHigh}, uv, color};
+      vtx += 2;
+      x += 1.0f;
+   }
+
+   // Two triangles between each pair of neighboring columns            
+   for (Offset i = 1; i < columns; ++i) {
+      const auto v = static_cast<ImDrawIdx>(base + i * 2);
+      idx[0] = v - 2; idx[1] = v - 1; idx[2] = v + 1;
+      idx[3] = v - 2; idx[4] = v + 1; idx[5] = v;
+      idx += 6;
+   }
+
+   draw->_VtxWritePtr = vtx;
+   draw->_IdxWritePtr = idx;
+   draw->_VtxCurrentIdx += static_cast<unsigned>(vtxCount);
+}
+
+/// Submit the plot, handling zoom and pan                                    
+///   @param item - the item that owns the plot                               
+void GUIPlot::Submit(GUIItem& item) {
+   auto size = item.GetRequestedSize();
+   if (size.x <= 0)
+      size.x = ImGui::GetContentRegionAvail().x;
+   if (size.y <= 0)
+      size.y = 150;
+
+   ImGui::PushID(this);
+   ImGui::InvisibleButton("##plot", size);
+   ImGui::PopID();
+
+   const auto min = ImGui::GetItemRectMin();
+   const auto max = ImGui::GetItemRectMax();
+   const float width = max.x - min.x;
+   auto draw = ImGui::GetWindowDrawList();
+   draw->AddRectFilled(min, max, ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+   const Offset samples = mSamples.size();
+   mEmittedVertices = 0;
+   if (samples < 2 or width < 2)
+      return;
+
+   // Visible range - follows all samples until zoomed or panned        
+   double begin = mViewEnd > 0 ? mViewBegin : 0.0;
+   double end = mViewEnd > 0 ? mViewEnd : static_cast<double>(samples);
+   auto& io = ImGui::GetIO();
+   if (ImGui::IsItemHovered()) {
+      if (io.MouseWheel != 0) {
+         const double span = end - begin;
+         const double pivot = begin + span * (io.MousePos.x - min.x) / width;
+         const double zoomed = std::clamp(
+            span * (io.MouseWheel > 0 ? 0.8 : 1.25),
+            2.0, static_cast<double>(samples));
+         begin = pivot - (pivot - begin) * zoomed / span;
+         end = begin + zoomed;
+         mViewEnd = end;
+      }
+
+      if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+         begin = 0;
+         end = static_cast<double>(samples);
+         mViewEnd = 0;
+      }
+   }
+
+   if (ImGui::IsItemActive() and ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+      const double shift = -io.MouseDelta.x * (end - begin) / width;
+      begin += shift;
+      end += shift;
+      mViewEnd = end;
+   }
+
+   // Keep the range inside the samples                                 
+   const double span = std::min(end - begin, static_cast<double>(samples));
+   begin = std::clamp(begin, 0.0, samples - span);
+   end = begin + span;
+   if (mViewEnd > 0) {
+      mViewBegin = begin;
+      mViewEnd = end;
+   }
+
+   const auto color = ImGui::GetColorU32(ImGuiCol_PlotLines);
+   const double perPixel = span / width;
+   const int vtxBefore = draw->VtxBuffer.Size;
+   draw->PushClipRect(min, max, true);
+
+   if (perPixel <= 1.0) {
+      // Less than a sample per pixel - polyline through the samples    
+      const auto first = static_cast<Offset>(begin);
+      const auto last = std::min(samples, static_cast<Offset>(std::ceil(end)) + 1);
+      MinMax range {mSamples[first], mSamples[first]};
+      for (Offset i = first; i < last; ++i)
+         range.Merge({mSamples[i], mSamples[i]});
+
+      const float spread = range.mMax - range.mMin;
+      const float scale = spread > 0 ? (max.y - min.y - 2.0f) / spread : 0.0f;
+      mPoints.clear();
+      for (Offset i = first; i < last; ++i) {
+         mPoints.push_back({
+            min.x + static_cast<float>((i - begin) / perPixel),
+            spread > 0
+               ? max.y - 1.0f - (mSamples[i] - range.mMin) * scale
+               : (min.y + max.y) * 0.5f
+         });
+      }
+
+      draw->AddPolyline(mPoints.data(), static_cast<int>(mPoints.size()),
+         color, ImDrawFlags_None, 1.0f);
+   }
+   else {
+      // Pick the level whose entries are just below a pixel wide       
+      const auto level = std::min<Count>(
+         static_cast<Count>(std::floor(std::log2(perPixel))), mLevels.size());
+
+      const auto pixels = static_cast<Count>(width);
+      mColumns.resize(pixels);
+      MinMax range {
+         std::numeric_limits<float>::max(),
+         std::numeric_limits<float>::lowest()
+      };
+
+      for (Offset p = 0; p < pixels; ++p) {
+         const auto a = static_cast<Offset>(begin + p * perPixel);
+         const auto b = std::clamp(
+            static_cast<Offset>(begin + (p + 1) * perPixel), a + 1, samples);
+         mColumns[p] = QueryRange(level, std::min(a, samples - 1), b);
+         range.Merge(mColumns[p]);
+      }
+
+      Emit(draw, min, max, range, color);
+   }
+
+   draw->PopClipRect();
+   mEmittedVertices = static_cast<Count>(draw->VtxBuffer.Size - vtxBefore);
+}
@@ -0,0 +1,70 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIWidget.hpp"
+#include <vector>
+
+
+///                                                                           
+///   Level-of-detail plot                                                    
+///                                                                           
+/// Keeps a min/max pyramid over the samples, where each level halves the     
+/// resolution of the previous one. Appending a sample only updates the       
+/// levels whose entries got completed by it, which is O(1) amortized.        
+/// When drawn, the level that best matches the zoom is picked, and only      
+/// about two vertices per horizontal pixel are emitted, so the cost of       
+/// drawing doesn't depend on the number of samples                           
+///                                                                           
+struct GUIPlot final : GUIWidget {
+   /// Value range of a block of samples                                      
+   struct MinMax {
+      float mMin;
+      float mMax;
+
+      void Merge(const MinMax& other) noexcept {
+         mMin = std::min(mMin, other.mMin);
+         mMax = std::max(mMax, other.mMax);
+      }
+   };
+
+private:
+   // The raw samples, also the level 0 of the pyramid                  
+   std::vector<float> mSamples;
+   // Level L (starting from 1) is at index L - 1, and each of its entries
+   // covers 2^L samples. An entry that isn't complete yet contains only
+   // its completed children                                            
+   std::vector<std::vector<MinMax>> mLevels;
+
+   // Visible range of samples, end is zero while following all samples 
+   double mViewBegin {};
+   double mViewEnd {};
+
+   // Per-column value ranges, reused between frames                    
+   std::vector<MinMax> mColumns;
+   // Points for the polyline, when zoomed below a sample per pixel     
+   std::vector<ImVec2> mPoints;
+   // Number of vertices emitted in the last frame                      
+   Count mEmittedVertices {};
+
+   void Emit(ImDrawList*, const ImVec2& min, const ImVec2& max, const MinMax& range, ImU32 color);
+
+public:
+   void Append(float);
+   void Append(const float*, Count);
+   void Clear();
+   NOD() MinMax Query(Count level, Offset entry) const;
+   NOD() MinMax QueryRange(Count level, Offset begin, Offset end) const;
+
+   void SetData(const Many&) override;
+   void Submit(GUIItem&) override;
+
+   NOD() Count GetSampleCount() const noexcept { return mSamples.size(); }
+   NOD() Count GetLevelCount() const noexcept { return mLevels.size() + 1; }
+   NOD() Count GetEmittedVertices() const noexcept { return mEmittedVertices; }
+};
+
@@ -0,0 +1,136 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIRecording.hpp"
+#include <algorithm>
+#include <limits>
+
+
+/// Discard the recording                                                     
+void GUIRecording::Reset() noexcept {
+   mSegments.clear();
+   mValid = false;
+}
+
+/// Count all recorded vertices                                               
+///   @return the number of vertices                                          
+Count GUIRecording::GetVertexCount() const noexcept {
+   Count count = 0;
+   for (auto& segment : mSegments)
+      count += segment.mVertices.size();
+   return count;
+}
+
+/// Remember where the content begins in the draw list                        
+/// The last command might still be extended by the content, so recording     
+/// starts from it, but only from the current index onwards                   
+///   @param draw - the draw list that the content will be submitted to       
+void GUIRecording::Begin(const ImDrawList* draw) {
+   Reset();
+   mCommandMark = std::max(draw->CmdBuffer.Size - 1, 0);
+   mIndexMark = draw->IdxBuffer.Size;
+   mVertexMark = draw->VtxBuffer.Size;
+}
+
+/// Capture everything emitted since Begin                                    
+/// Fails if the content used callbacks, or referenced vertices that were     
+/// emitted before recording began - such content can't be replayed           
+///   @param draw - the draw list the content was submitted to                
+///   @param origin - top-left corner of the content                          
+///   @param size - size of the content                                       
+///   @param width - available width at the time of submission                
+///   @return true if recording succeeded                                     
+bool GUIRecording::End(const ImDrawList* draw, ImVec2 origin, ImVec2 size, float width) {
+   for (int c = mCommandMark; c < draw->CmdBuffer.Size; ++c) {
+      const auto& cmd = draw->CmdBuffer[c];
+      if (cmd.UserCallback) {
+         Reset();
+         return false;
+      }
+
+      const int from = std::max(static_cast<int>(cmd.IdxOffset), mIndexMark);
+      const int to = static_cast<int>(cmd.IdxOffset + cmd.ElemCount);
+      if (to <= from)
+         continue;
+
+      // Find the range of vertices the command references              
+      unsigned lowest = std::numeric_limits<unsigned>::max();
+      unsigned highest = 0;
+      for (int i = from; i < to; ++i) {
+         const unsigned v = cmd.VtxOffset + draw->IdxBuffer[i];
+         lowest = std::min(lowest, v);
+         highest = std::max(highest, v);
+      }
+
+      if (lowest < static_cast<unsigned>(mVertexMark)) {
+         Reset();
+         return false;
+      }
+
+      Segment segment {cmd.ClipRect, cmd.TextureId};
+      segment.mVertices.assign(
+         draw->VtxBuffer.Data + lowest,
+         draw->VtxBuffer.Data + highest + 1
+      );
+
+      const auto rebase = lowest - cmd.VtxOffset;
+      segment.mIndices.resize(to - from);
+      for (int i = from; i < to; ++i) {
+         segment.mIndices[i - from] = static_cast<ImDrawIdx>(
+            draw->IdxBuffer[i] - rebase);
+      }
+
+      mSegments.emplace_back(std::move(segment));
+   }
+
+   mOrigin = origin;
+   mSize = size;
+   mWidth = width;
+   mValid = true;
+   return true;
+}
+
+/// Emit the recorded geometry, moved to a new origin                         
+/// Vertices are copied and translated, indices are copied and rebased to     
+/// the draw list's current vertex index - nothing else is generated          
+///   @param draw - the draw list to emit into                                
+///   @param origin - the new top-left corner of the content                  
+void GUIRecording::Replay(ImDrawList* draw, ImVec2 origin) const {
+   const ImVec2 offset {origin.x - mOrigin.x, origin.y - mOrigin.y};
+
+   for (auto& segment : mSegments) {
+      const auto& clip = segment.mClipRect;
+      draw->PushClipRect(
+         {clip.x + offset.x, clip.y + offset.y},
+         {clip.z + offset.x, clip.w + offset.y}, true);
+      draw->PushTextureID(segment.mTexture);
+
+      const auto vtxCount = static_cast<int>(segment.mVertices.size());
+      const auto idxCount = static_cast<int>(segment.mIndices.size());
+      draw->PrimReserve(idxCount, vtxCount);
+
+      auto vtx = draw->_VtxWritePtr;
+      for (auto& v : segment.mVertices) {
+         *vtx = v;
+         vtx->pos.x += offset.x;
+         vtx->pos.y += offset.y;
+         ++vtx;
+      }
+
+      const auto base = static_cast<ImDrawIdx>(draw->_VtxCurrentIdx);
+      auto idx = draw->_IdxWritePtr;
+      for (auto i : segment.mIndices)
+         *idx++ = static_cast<ImDrawIdx>(base + i);
+
+      draw->_VtxWritePtr = vtx;
+      draw->_IdxWritePtr = idx;
+      draw->_VtxCurrentIdx += vtxCount;
+
+      draw->PopTextureID();
+      draw->PopClipRect();
+   }
+}
@@ -0,0 +1,55 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <vector>
+
+
+///                                                                           
+///   Recorded draw commands                                                  
+///                                                                           
+/// Geometry that a static item subtree emitted into an ImDrawList, captured  
+/// once and then replayed with a translation offset, instead of submitting   
+/// the widgets again. Each segment is self-contained - it has its own clip   
+/// rectangle, texture, vertices and indices relative to those vertices       
+///                                                                           
+struct GUIRecording {
+   struct Segment {
+      ImVec4 mClipRect;
+      ImTextureID mTexture;
+      std::vector<ImDrawVert> mVertices;
+      std::vector<ImDrawIdx> mIndices;
+   };
+
+private:
+   std::vector<Segment> mSegments;
+   // Where recording began in the draw list                            
+   int mCommandMark {};
+   int mIndexMark {};
+   int mVertexMark {};
+   // Top-left corner and size of the recorded content                  
+   ImVec2 mOrigin {};
+   ImVec2 mSize {};
+   // Available width at the time of recording - content might wrap     
+   // differently if it changes                                         
+   float mWidth {};
+   bool mValid {};
+
+public:
+   void Begin(const ImDrawList*);
+   bool End(const ImDrawList*, ImVec2 origin, ImVec2 size, float width);
+   void Replay(ImDrawList*, ImVec2 origin) const;
+   void Reset() noexcept;
+
+   NOD() bool IsValid(float width) const noexcept {
+      return mValid and mWidth == width;
+   }
+   NOD() auto GetSize() const noexcept { return mSize; }
+   NOD() Count GetVertexCount() const noexcept;
+};
+
@@ -0,0 +1,425 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUISpatial.hpp"
+#include "GUI.hpp"
+#include <imgui_internal.h>
+#include <algorithm>
+#include <cmath>
+
+
+/// Combine cell coordinates into a key                                       
+///   @param x - column of the cell                                           
+///   @param y - row of the cell                                              
+///   @return the key                                                         
+inline uint64_t CellKey(int x, int y) noexcept {
+   return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+}
+
+/// Get the cell that contains a coordinate                                   
+///   @param v - the coordinate                                               
+///   @return the cell                                                        
+inline int CellOf(float v) noexcept {
+   return static_cast<int>(std::floor(v / GUISpatial::CellSize));
+}
+
+/// Check if a rectangle contains a point                                     
+///   @param r - the rectangle                                                
+///   @param p - the point                                                    
+///   @return true if the point is inside                                     
+inline bool Contains(const ImVec4& r, ImVec2 p) noexcept {
+   return p.x >= r.x and p.y >= r.y and p.x < r.z and p.y < r.w;
+}
+
+/// Start indexing the items of a window - called right after ImGui::Begin    
+///   @param root - the item that is the window                               
+///   @param open - whether the window's contents are displayed               
+void GUISpatial::BeginWindow(GUIItem& root, bool open) {
+   const auto window = ImGui::GetCurrentWindowRead();
+   auto& layer = mLayers[&root];
+   layer.mRoot = &root;
+   layer.mWindow = window;
+   layer.mOpen = open;
+   layer.mOrigin = ImGui::GetCursorScreenPos();
+   layer.mRect = {
+      window->Pos.x, window->Pos.y,
+      window->Pos.x + window->Size.x, window->Pos.y + window->Size.y
+   };
+   layer.mInner = {
+      window->InnerClipRect.Min.x, window->InnerClipRect.Min.y,
+      window->InnerClipRect.Max.x, window->InnerClipRect.Max.y
+   };
+
+   mCurrent = &layer;
+   mOrder = 0;
+}
+
+/// Finish indexing the items of a window - called right before ImGui::End    
+/// Items that weren't submitted in a live window are no longer displayed,    
+/// so their entries are dropped. Replayed windows keep all of their entries  
+///   @param live - whether the window's contents were submitted              
+void GUISpatial::EndWindow(bool live) {
+   const auto layer = mCurrent;
+   mCurrent = nullptr;
+   if (not layer or not live)
+      return;
+
+   mStale.clear();
+   const auto collect = [&](const std::vector<uint32_t>& ids) {
+      for (auto id : ids) {
+         if (mEntries[id].mFrame != mFrame)
+            mStale.push_back(id);
+      }
+   };
+
+   for (const auto& [key, ids] : layer->mCells)
+      collect(ids);
+   collect(layer->mLarge);
+
+   // Items covering several cells are collected more than once         
+   std::sort(mStale.begin(), mStale.end());
+   mStale.erase(std::unique(mStale.begin(), mStale.end()), mStale.end());
+   for (auto id : mStale)
+      Release(id);
+}
+
+/// Put an entry in the cells it covers                                       
+///   @param id - the entry                                                   
+void GUISpatial::Insert(uint32_t id) {
+   auto& entry = mEntries[id];
+   auto& layer = *entry.mLayer;
+   entry.mX0 = CellOf(entry.mRect.x);
+   entry.mY0 = CellOf(entry.mRect.y);
+   entry.mX1 = CellOf(entry.mRect.z);
+   entry.mY1 = CellOf(entry.mRect.w);
+   const auto cells = static_cast<Count>(entry.mX1 - entry.mX0 + 1)
+                    * static_cast<Count>(entry.mY1 - entry.mY0 + 1);
+   entry.mLarge = cells > MaxCells;
+   if (entry.mLarge) {
+      layer.mLarge.push_back(id);
+      return;
+   }
+
+   for (int y = entry.mY0; y <= entry.mY1; ++y) {
+      for (int x = entry.mX0; x <= entry.mX1; ++x)
+         layer.mCells[CellKey(x, y)].push_back(id);
+   }
+}
+
+/// Take an entry out of the cells it covers                                  
+///   @param id - the entry                                                   
+void GUISpatial::Erase(uint32_t id) {
+   const auto& entry = mEntries[id];
+   auto& layer = *entry.mLayer;
+   const auto drop = [id](std::vector<uint32_t>& ids) {
+      const auto found = std::find(ids.begin(), ids.end(), id);
+      if (found != ids.end()) {
+         *found = ids.back();
+         ids.pop_back();
+      }
+   };
+
+   if (entry.mLarge)
+      return drop(layer.mLarge);
+
+   for (int y = entry.mY0; y <= entry.mY1; ++y) {
+      for (int x = entry.mX0; x <= entry.mX1; ++x) {
+         const auto cell = layer.mCells.find(CellKey(x, y));
+         if (cell == layer.mCells.end())
+            continue;
+
+         drop(cell->second);
+         if (cell->second.empty())
+            layer.mCells.erase(cell);
+      }
+   }
+}
+
+/// Free an entry, and forget its item's handle                               
+///   @param id - the entry                                                   
+void GUISpatial::Release(uint32_t id) {
+   Erase(id);
+   mEntries[id].mItem->mSpatial = None;
+   mEntries[id].mItem = nullptr;
+   mFree.push_back(id);
+}
+
+/// Index an item that was just submitted to the current window               
+/// An item that didn't move costs a single comparison                        
+///   @param item - the item                                                  
+///   @param order - the order reserved before the item was submitted         
+///   @param min - top-left corner of the item on screen                      
+///   @param max - bottom-right corner of the item on screen                  
+///   @return true if the item was moved in the grid                          
+bool GUISpatial::Update(GUIItem& item, uint32_t order, ImVec2 min, ImVec2 max) {
+   if (not mCurrent)
+      return false;
+
+   const auto origin = mCurrent->mOrigin;
+   const ImVec4 rect {
+      min.x - origin.x, min.y - origin.y,
+      max.x - origin.x, max.y - origin.y
+   };
+
+   if (item.mSpatial == None) {
+      if (mFree.empty()) {
+         item.mSpatial = static_cast<uint32_t>(mEntries.size());
+         mEntries.emplace_back();
+      }
+      else {
+         item.mSpatial = mFree.back();
+         mFree.pop_back();
+      }
+
+      mEntries[item.mSpatial] = {&item, mCurrent, order, mFrame, rect};
+      Insert(item.mSpatial);
+      ++mMoved;
+      return true;
+   }
+
+   auto& entry = mEntries[item.mSpatial];
+   entry.mOrder = order;
+   entry.mFrame = mFrame;
+   if (entry.mLayer == mCurrent
+   and entry.mRect.x == rect.x and entry.mRect.y == rect.y
+   and entry.mRect.z == rect.z and entry.mRect.w == rect.w)
+      return false;
+
+   Erase(item.mSpatial);
+   entry.mLayer = mCurrent;
+   entry.mRect = rect;
+   Insert(item.mSpatial);
+   ++mMoved;
+   return true;
+}
+
+/// Keep an item indexed where it was, without submitting it - used for       
+/// items inside replayed recordings                                          
+///   @param item - the item                                                  
+void GUISpatial::Keep(const GUIItem& item) noexcept {
+   if (item.mSpatial != None)
+      mEntries[item.mSpatial].mFrame = mFrame;
+}
+
+/// Stop indexing an item, when it's destroyed or becomes a window            
+/// Removing a window also removes all the items indexed inside it            
+///   @param item - the item                                                  
+void GUISpatial::Remove(GUIItem& item) {
+   if (item.mSpatial != None)
+      Release(item.mSpatial);
+
+   const auto layer = mLayers.find(&item);
+   if (layer == mLayers.end())
+      return;
+
+   if (mCurrent == &layer->second)
+      mCurrent = nullptr;
+   if (mFocused == &layer->second)
+      mFocused = nullptr;
+
+   for (uint32_t id = 0; id < mEntries.size(); ++id) {
+      if (mEntries[id].mItem and mEntries[id].mLayer == &layer->second)
+         Release(id);
+   }
+   mLayers.erase(layer);
+}
+
+/// Order the windows as ImGui displays them - called once all windows are    
+/// submitted. Windows that weren't submitted this frame are hidden           
+void GUISpatial::EndFrame() {
+   std::unordered_map<const ImGuiWindow*, int> depths;
+   const auto context = ImGui::GetCurrentContext();
+   const auto& windows = context->Windows;
+   for (int i = 0; i < windows.Size; ++i) {
+      if (windows[i]->Active and not windows[i]->Hidden)
+         depths.emplace(windows[i], i);
+   }
+
+   // Focus may be in a child window of a widget, inside the item's window
+   const auto focused = context->NavWindow
+      ? context->NavWindow->RootWindow : nullptr;
+   mFocused = nullptr;
+   for (auto& [root, layer] : mLayers) {
+      const auto found = depths.find(layer.mWindow);
+      layer.mDepth = found != depths.end() ? found->second : -1;
+      if (focused and layer.mWindow == focused)
+         mFocused = &layer;
+   }
+
+   mCurrent = nullptr;
+   mLastMoved = mMoved;
+   mMoved = 0;
+   ++mFrame;
+}
+
+/// Find the topmost window under a point                                     
+///   @param point - the point, on screen                                     
+///   @return the window, or nullptr if there is none                         
+const GUISpatial::Layer* GUISpatial::Pick(ImVec2 point) const noexcept {
+   const Layer* top = nullptr;
+   for (const auto& [root, layer] : mLayers) {
+      if (layer.mDepth >= 0 and Contains(layer.mRect, point)
+      and (not top or layer.mDepth > top->mDepth))
+         top = &layer;
+   }
+   return top;
+}
+
+/// Find the window an item was last displayed in                             
+///   @param item - the item                                                  
+///   @return the window, or nullptr if the item isn't indexed                
+const GUISpatial::Layer* GUISpatial::Find(const GUIItem& item) const {
+   if (item.mSpatial != None)
+      return mEntries[item.mSpatial].mLayer;
+
+   const auto layer = mLayers.find(&item);
+   return layer != mLayers.end() ? &layer->second : nullptr;
+}
+
+/// Find the topmost item under a point                                       
+/// Windows hide the windows behind them, and the item under the point is     
+/// searched only in the cell that contains it                                
+///   @param point - the point, on screen                                     
+///   @return the item, the window if no item in it is under the point, or    
+///      nullptr if there's no window under the point                         
+GUIItem* GUISpatial::HitTest(ImVec2 point) const {
+   mCandidates = 0;
+   const auto layer = Pick(point);
+   if (not layer)
+      return nullptr;
+   if (not layer->mOpen or not Contains(layer->mInner, point))
+      return layer->mRoot;
+
+   const ImVec2 local {point.x - layer->mOrigin.x, point.y - layer->mOrigin.y};
+   const Entry* best = nullptr;
+   const auto test = [&](uint32_t id) {
+      const auto& entry = mEntries[id];
+      ++mCandidates;
+      if (Contains(entry.mRect, local) and (not best or entry.mOrder > best->mOrder))
+         best = &entry;
+   };
+
+   const auto cell = layer->mCells.find(CellKey(CellOf(local.x), CellOf(local.y)));
+   if (cell != layer->mCells.end()) {
+      for (auto id : cell->second)
+         test(id);
+   }
+   for (auto id : layer->mLarge)
+      test(id);
+
+   return best ? best->mItem : layer->mRoot;
+}
+
+/// Find all displayed items that overlap a rectangle, for automation         
+/// Items are sorted from front to back                                       
+///   @param rect - the rectangle, on screen                                  
+///   @param items - [out] the items                                          
+void GUISpatial::Query(const ImVec4& rect, std::vector<GUIItem*>& items) const {
+   std::vector<const Entry*> found;
+   for (const auto& [root, layer] : mLayers) {
+      if (layer.mDepth < 0 or not layer.mOpen)
+         continue;
+
+      // Only the visible part of the window is searched                
+      const ImVec4 local {
+         std::max(rect.x, layer.mInner.x) - layer.mOrigin.x,
+         std::max(rect.y, layer.mInner.y) - layer.mOrigin.y,
+         std::min(rect.z, layer.mInner.z) - layer.mOrigin.x,
+         std::min(rect.w, layer.mInner.w) - layer.mOrigin.y
+      };
+      if (local.x >= local.z or local.y >= local.w)
+         continue;
+
+      const auto test = [&](uint32_t id) {
+         const auto& entry = mEntries[id];
+         if (entry.mRect.x < local.z and entry.mRect.z > local.x
+         and entry.mRect.y < local.w and entry.mRect.w > local.y)
+            found.push_back(&entry);
+      };
+
+      for (int y = CellOf(local.y); y <= CellOf(local.w); ++y) {
+         for (int x = CellOf(local.x); x <= CellOf(local.z); ++x) {
+            const auto cell = layer.mCells.find(CellKey(x, y));
+            if (cell == layer.mCells.end())
+               continue;
+            for (auto id : cell->second)
+               test(id);
+         }
+      }
+      for (auto id : layer.mLarge)
+         test(id);
+   }
+
+   // Items covering several cells are found more than once             
+   std::sort(found.begin(), found.end(), [](const Entry* a, const Entry* b) {
+      if (a->mLayer != b->mLayer)
+         return a->mLayer->mDepth > b->mLayer->mDepth;
+      return a->mOrder > b->mOrder;
+   });
+   found.erase(std::unique(found.begin(), found.end()), found.end());
+
+   items.clear();
+   for (auto entry : found)
+      items.push_back(entry->mItem);
+}
+
+/// Get where an item was last displayed                                      
+///   @param item - the item                                                  
+///   @param rect - [out] the rectangle of the item, on screen                
+///   @return true if the item is indexed                                     
+bool GUISpatial::GetRect(const GUIItem& item, ImVec4& rect) const {
+   if (const auto layer = mLayers.find(&item); layer != mLayers.end()) {
+      rect = layer->second.mRect;
+      return true;
+   }
+
+   if (item.mSpatial == None)
+      return false;
+
+   const auto& entry = mEntries[item.mSpatial];
+   const auto origin = entry.mLayer->mOrigin;
+   rect = {
+      entry.mRect.x + origin.x, entry.mRect.y + origin.y,
+      entry.mRect.z + origin.x, entry.mRect.w + origin.y
+   };
+   return true;
+}
+
+/// Check if an item was displayed in the last frame, or is a window          
+///   @param item - the item                                                  
+///   @return true if the item is indexed                                     
+bool GUISpatial::IsIndexed(const GUIItem& item) const {
+   return Find(item) != nullptr;
+}
+
+/// Check if any part of an item was visible in the last frame                
+/// Items covered by other windows still count as visible                     
+///   @param item - the item                                                  
+///   @return true if the item is visible                                     
+bool GUISpatial::IsVisible(const GUIItem& item) const {
+   const auto layer = Find(item);
+   if (not layer or layer->mDepth < 0)
+      return false;
+   if (layer->mRoot == &item)
+      return true;
+   if (not layer->mOpen)
+      return false;
+
+   const auto& rect = mEntries[item.mSpatial].mRect;
+   const auto& inner = layer->mInner;
+   const auto origin = layer->mOrigin;
+   return rect.x + origin.x < inner.z and rect.z + origin.x > inner.x
+      and rect.y + origin.y < inner.w and rect.w + origin.y > inner.y;
+}
+
+/// Check if an item is in the window with keyboard focus                     
+///   @param item - the item                                                  
+///   @return true if the item is focused                                     
+bool GUISpatial::IsFocused(const GUIItem& item) const {
+   const auto layer = Find(item);
+   return layer and layer == mFocused;
+}
@@ -0,0 +1,116 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <unordered_map>
+#include <vector>
+
+struct ImGuiWindow;
+
+
+///                                                                           
+///   Spatial index of items                                                  
+///                                                                           
+/// Finds the item under a point without testing every item. Each window      
+/// has a uniform grid of the rectangles of its items, relative to the        
+/// window's content, so that moving or scrolling a window doesn't touch      
+/// its items, and replayed windows keep their items indexed. Items are       
+/// indexed as they're submitted, and only items whose rectangle changed      
+/// are moved in the grid. Entries are stamped with the frame they were       
+/// updated in, and entries of a window submitted live that weren't updated   
+/// are dropped when the window ends. Windows are ordered as ImGui displays   
+/// them, and items inside a window by submission, so children are above      
+/// parents                                                                   
+///                                                                           
+struct GUISpatial {
+   // Side of a grid cell, in pixels                                    
+   static constexpr float CellSize = 128;
+   // Items covering more cells than this are kept apart, and tested with
+   // every query - usually just a few large panels                     
+   static constexpr Count MaxCells = 16;
+   // Items without an entry                                            
+   static constexpr uint32_t None = UINT32_MAX;
+
+private:
+   struct Layer;
+
+   struct Entry {
+      GUIItem* mItem;
+      Layer* mLayer;
+      // Submission order inside the window, later items are on top     
+      uint32_t mOrder;
+      // Last frame the item was submitted or kept                      
+      uint64_t mFrame;
+      // Rectangle relative to the content origin of the window         
+      ImVec4 mRect;
+      // Covered cells, unless the item is large                        
+      int mX0 {}, mY0 {}, mX1 {}, mY1 {};
+      bool mLarge {};
+   };
+
+   struct Layer {
+      GUIItem* mRoot;
+      const ImGuiWindow* mWindow;
+      // Screen position of the content origin                          
+      ImVec2 mOrigin;
+      // The whole window, and the part where its items are visible     
+      ImVec4 mRect;
+      ImVec4 mInner;
+      // Display order of the window, negative if it isn't displayed    
+      int mDepth {-1};
+      // Whether the window's items are displayed, false when collapsed 
+      bool mOpen {};
+      std::unordered_map<uint64_t, std::vector<uint32_t>> mCells;
+      std::vector<uint32_t> mLarge;
+   };
+
+   std::vector<Entry> mEntries;
+   std::vector<uint32_t> mFree;
+   std::unordered_map<const GUIItem*, Layer> mLayers;
+
+   // The window being submitted, and the next order in it              
+   Layer* mCurrent {};
+   uint32_t mOrder {};
+   uint64_t mFrame {1};
+   // Scratch for dropping stale entries                                
+   std::vector<uint32_t> mStale;
+   // The window with keyboard focus                                    
+   const Layer* mFocused {};
+
+   // Statistics                                                        
+   Count mMoved {};
+   Count mLastMoved {};
+   mutable Count mCandidates {};
+
+   void Insert(uint32_t);
+   void Erase(uint32_t);
+   void Release(uint32_t);
+   NOD() const Layer* Pick(ImVec2) const noexcept;
+   NOD() const Layer* Find(const GUIItem&) const;
+
+public:
+   void BeginWindow(GUIItem&, bool open);
+   void EndWindow(bool live);
+   NOD() uint32_t Reserve() noexcept { return mOrder++; }
+   bool Update(GUIItem&, uint32_t order, ImVec2 min, ImVec2 max);
+   void Keep(const GUIItem&) noexcept;
+   void Remove(GUIItem&);
+   void EndFrame();
+
+   NOD() GUIItem* HitTest(ImVec2) const;
+   void Query(const ImVec4&, std::vector<GUIItem*>&) const;
+   NOD() bool GetRect(const GUIItem&, ImVec4&) const;
+   NOD() bool IsIndexed(const GUIItem&) const;
+   NOD() bool IsVisible(const GUIItem&) const;
+   NOD() bool IsFocused(const GUIItem&) const;
+
+   NOD() Count GetCount() const noexcept { return mEntries.size() - mFree.size(); }
+   NOD() Count GetLayerCount() const noexcept { return mLayers.size(); }
+   NOD() Count GetMoved() const noexcept { return mLastMoved; }
+   NOD() Count GetCandidates() const noexcept { return mCandidates; }
+};
@@ -6,6 +6,7 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later                                 
 ///                                                                           
 #include "GUI.hpp"
+#include <imgui_internal.h>
 
 
 /// Function used by ImGui to retrieve current system clipboard               
@@ -33,6 +34,7 @@ void SetClipboardText(void* user_data, const char* text) {
 GUISystem::GUISystem(GUI* producer, Describe descriptor)
    : A::UISystem  {MetaOf<GUISystem>()}
    , ProducedFrom {producer, descriptor}
+   , mIcons {this}
    , mItems {this}
    , mFonts {this} {
    VERBOSE_GUI("Initializing...");
@@ -287,23 +289,379 @@ GUISystem::GUISystem(GUI* producer, Describe descriptor)
          vkCreateGraphicsPipelines(device, pipelineCache, 1, &info, allocator, pipeline);
       }
    }*/
+
+   // Systems sharing a window are composited into one submission -     
+   // attached last, so that a throwing constructor doesn't leave the   
+   // compositor with a dangling system                                 
+   producer->GetCompositor().Attach(mWindow.Get(), this);
    VERBOSE_GUI("Initialized");
 }
 
 /// GUI system destruction                                                    
 GUISystem::~GUISystem() {
+   mProducer->GetCompositor().Detach(mWindow.Get(), this);
    if (mContext)
       ImGui::DestroyContext(mContext);
 }
 
+/// Hand the last draw data to the compositor, if another system draws into   
+/// the same window                                                           
+///   @return true if the compositor took the draw data                       
+bool GUISystem::Composite() {
+   auto& compositor = mProducer->GetCompositor();
+   if (not compositor.IsShared(mWindow.Get()))
+      return false;
+
+   // The window might have become shared after instances were chosen,  
+   // but the compositor only draws triangles                           
+   mOutput = Output::Triangles;
+   const bool rebase =
+      not (mIO->BackendFlags & ImGuiBackendFlags_RendererHasVtxOffset);
+   if (compositor.Submit(mWindow.Get(), this, ImGui::GetDrawData(), &mWorkers, rebase)) {
+      VERBOSE_GUI("Composited ", compositor.GetCommands(mWindow.Get())->size(),
+         " commands with ", compositor.GetBinds(mWindow.Get()), " texture binds");
+   }
+   return true;
+}
+
+/// Change the format of the geometry handed to the renderer                  
+/// Windows shared with other systems are composited from triangles, so       
+/// instances are refused for them                                            
+///   @param output - the format                                              
+///   @return true if the format was changed                                  
+bool GUISystem::SetOutput(Output output) {
+   if (output == Output::Instances
+   and mProducer->GetCompositor().IsShared(mWindow.Get()))
+      return false;
+
+   mOutput = output;
+   return true;
+}
+
+/// Get the registry of images drawn by the system                            
+/// It's shared by all systems, so that systems composited together draw      
+/// from the same texture array                                               
+///   @return the registry                                                    
+GUITextures& GUISystem::GetTextures() {
+   return mProducer->GetTextures();
+}
+
+/// Create an image in the system's context, for atlases                      
+///   @param size - size of the image in pixels                               
+///   @return the image                                                       
+A::Image* GUISystem::CreateImage(ImVec2 size) {
+   Verbs::Create createImage {
+      Construct::From<A::Image>(
+         Traits::Name {"GUI atlas"},
+         Traits::Size {
+            static_cast<int>(size.x),
+            static_cast<int>(size.y)
+         }
+      )
+   };
+
+   return RunIn(createImage)->As<A::Image*>();
+}
+
 /// Produce GUI elements and fonts                                            
 ///   @param verb - creation verb to satisfy                                  
 void GUISystem::Create(Verb& verb) {
+   // When creating a list of items in one verb, reserve the system's   
+   // bookkeeping for all of them at once, instead of growing it for    
+   // every single item - the items themselves are still allocated      
+   // one by one by the factory                                         
+   Count batch = 0;
+   verb->ForEachDeep([&](const Construct& construct) {
+      if (construct.CastsTo<GUIItem>())
+         ++batch;
+   });
+
+   if (batch > 1) {
+      mRoots.reserve(mRoots.size() + batch);
+      mDirtyItems.reserve(mDirtyItems.size() + batch);
+   }
+
    mItems.Create(verb);
    mFonts.Create(verb);
 }
 
+/// Get the compiled template for a descriptor shape, compiling it on the     
+/// first encounter                                                           
+///   @param shape - the collected descriptor                                 
+///   @return the template                                                    
+const GUITemplate& GUISystem::GetTemplate(const GUITemplate::Shape& shape) {
+   const auto [first, last] = mTemplates.equal_range(shape.mHash);
+   for (auto found = first; found != last; ++found) {
+      if (found->second.Matches(shape))
+         return found->second;
+   }
+
+   VERBOSE_GUI("Compiling widget template for shape ", shape.mHash);
+   return mTemplates.emplace(shape.mHash, GUITemplate {shape})->second;
+}
+
+/// Register a newly produced item                                            
+///   @param item - the item to register                                      
+void GUISystem::Attach(GUIItem* item) {
+   if (not item->mParent)
+      mRoots.push_back(item);
+
+   // Items are born dirty, so they're processed on the next refresh    
+   Enqueue(mDirtyItems, GUIItem::QueuedDirty, item);
+}
+
+/// Unregister an item that is being destroyed                                
+///   @param item - the item to unregister                                    
+void GUISystem::Detach(GUIItem* item) {
+   std::erase(mRoots, item);
+   if (item->mLayer) {
+      std::erase_if(mLayerCaptures, [item](const GUILayer::Capture& capture) {
+         return capture.mLayer == item->mLayer.get();
+      });
+   }
+   Dequeue(item);
+   mSpatial.Remove(*item);
+   mTweens.Remove(*item);
+   if (mHovered == item)
+      mHovered = nullptr;
+
+   // Orphaned children become top-level windows, so their subtrees     
+   // move closer to the top                                            
+   const auto rebase = [](auto& self, GUIItem* item, Count depth) -> void {
+      item->mDepth = depth;
+      for (auto child : item->mChildren)
+         self(self, child, depth + 1);
+   };
+
+   for (auto child : item->mChildren) {
+      if (not child->mLayer)
+         child->mLayer = std::make_unique<GUILayer>();
+      rebase(rebase, child, 0);
+      mSpatial.Remove(*child);
+      mRoots.push_back(child);
+   }
+
+   // The schedule is ordered by depth, which has just changed, and the 
+   // children are no longer inside a culled subtree - both are handled 
+   // on the next refresh, so unloading many items costs nothing extra  
+   if (not item->mChildren.empty()) {
+      mReorder = true;
+      mUncovered = true;
+   }
+}
+
+/// Put an item in the refresh queue - called by GUIItem::MarkDirty only      
+/// when the item transitions from clean to dirty, so there are no duplicates 
+///   @param item - the item to enqueue                                       
+void GUISystem::EnqueueDirty(GUIItem* item) {
+   Enqueue(mDirtyItems, GUIItem::QueuedDirty, item);
+}
+
+/// Append an item to one of the refresh queues, remembering where it is      
+///   @param queue - the queue                                                
+///   @param tag - the tag of the queue                                       
+///   @param item - the item to append                                        
+void GUISystem::Enqueue(
+   std::vector<GUIItem*>& queue, GUIItem::Queue tag, GUIItem* item
+) {
+   item->mQueue = tag;
+   item->mQueueIndex = static_cast<uint32_t>(queue.size());
+   queue.push_back(item);
+}
+
+/// Remove an item from the refresh queue it waits in, leaving a hole that    
+/// is compacted on the next refresh                                          
+///   @param item - the item to remove                                        
+void GUISystem::Dequeue(GUIItem* item) {
+   std::vector<GUIItem*>* queue;
+   switch (item->mQueue) {
+   case GUIItem::QueuedDirty:
+      queue = &mDirtyItems;
+      break;
+   case GUIItem::QueuedScheduled:
+      queue = &mScheduled;
+      ++mScheduledHoles;
+      break;
+   case GUIItem::QueuedParked:
+      queue = &mParked;
+      ++mParkedHoles;
+      break;
+   default:
+      return;
+   }
+
+   item->mQueue = GUIItem::Unqueued;
+   (*queue)[item->mQueueIndex] = nullptr;
+}
+
+/// Update the places items have in a refresh queue, after it was reordered   
+///   @param queue - the queue                                                
+///   @param tag - the tag of the queue                                       
+void GUISystem::Reindex(std::vector<GUIItem*>& queue, GUIItem::Queue tag) {
+   for (Offset i = 0; i < queue.size(); ++i) {
+      queue[i]->mQueue = tag;
+      queue[i]->mQueueIndex = static_cast<uint32_t>(i);
+   }
+}
+
+/// Subscribe an item to changes in an entity                                 
+///   @param item - the subscriber                                            
+///   @param source - the entity to observe                                   
+///   @param trait - the trait to observe, or nullptr for any change          
+void GUISystem::Subscribe(GUIItem* item, const Thing* source, TMeta trait) {
+   auto& list = mSubscribers[source];
+   for (auto& sub : list) {
+      if (sub.mItem == item) {
+         // Already subscribed - widen the subscription if needed       
+         if (sub.mTrait != trait)
+            sub.mTrait = {};
+         return;
+      }
+   }
+
+   list.push_back({item, trait});
+}
+
+/// Unsubscribe an item from changes in an entity                             
+///   @param item - the subscriber                                            
+///   @param source - the observed entity                                     
+void GUISystem::Unsubscribe(GUIItem* item, const Thing* source) {
+   const auto found = mSubscribers.find(source);
+   if (found == mSubscribers.end())
+      return;
+
+   std::erase_if(found->second, [item](const Subscription& sub) {
+      return sub.mItem == item;
+   });
+
+   if (found->second.empty())
+      mSubscribers.erase(found);
+}
+
+/// Fonts or the atlas have changed, so measured text and recorded geometry   
+/// can no longer be trusted - every item is laid out again                   
+void GUISystem::FontsChanged() {
+   mTextCache.Invalidate();
+
+   const auto invalidate = [](auto& self, GUIItem* item) -> void {
+      item->MarkDirty(GUIItem::DirtyLayout);
+      for (auto child : item->mChildren)
+         self(self, child);
+   };
+
+   for (auto root : mRoots)
+      invalidate(invalidate, root);
+}
+
+/// Icons were repacked in the atlas, so recorded geometry and captured       
+/// layers refer to old texture coordinates - they are all discarded          
+void GUISystem::IconsMoved() {
+   const auto invalidate = [](auto& self, GUIItem* item) -> void {
+      if (item->mRecording)
+         item->mRecording->Reset();
+      if (item->mLayer)
+         item->mLayer->Invalidate();
+      for (auto child : item->mChildren)
+         self(self, child);
+   };
+
+   for (auto root : mRoots)
+      invalidate(invalidate, root);
+}
+
+/// Notify all subscribed items, that an entity has changed                   
+/// Only the subscribers are marked dirty, nothing else is touched. Called    
+/// by GUIItem::Refresh for the owners of items, and after sending edits of   
+/// bound traits. There is no other change hook, so anything that changes an  
+/// observed entity outside of its owned items must call this itself          
+///   @param source - the entity that has changed                             
+///   @param trait - the trait that has changed, or nullptr if unknown        
+void GUISystem::Notify(const Thing* source, TMeta trait) {
+   const auto found = mSubscribers.find(source);
+   if (found == mSubscribers.end())
+      return;
+
+   for (auto& sub : found->second) {
+      if (trait and sub.mTrait and sub.mTrait != trait)
+         continue;
+
+      sub.mItem->MarkDirty(GUIItem::DirtyContent);
+      if (sub.mItem->mWidget)
+         sub.mItem->mWidget->Changed(source);
+   }
+}
+
+/// Queue an edit of a bound trait, to be sent at the end of the frame        
+/// Repeated edits of the same trait in a frame are merged, last one wins     
+///   @param thing - the entity to change                                     
+///   @param trait - the trait to change                                      
+///   @param value - the new value of the trait                               
+void GUISystem::Commit(Thing* thing, TMeta trait, Many&& value) {
+   for (auto& edit : mEdits) {
+      if (edit.mThing.Get() == thing and edit.mTrait == trait) {
+         edit.mValue = std::move(value);
+         return;
+      }
+   }
+
+   mEdits.push_back({thing, trait, std::move(value)});
+}
+
+/// Send all edits committed during the frame, each as an associate verb      
+/// Subscribers of the edited traits are notified afterwards, which is when   
+/// the bound widgets reread the value that was actually accepted             
+void GUISystem::SendEdits() {
+   mSentEdits = mEdits.size();
+   if (mEdits.empty())
+      return;
+
+   // Verbs may cause notifications that commit edits of their own,     
+   // those are sent on the next frame                                  
+   auto edits = std::move(mEdits);
+   mEdits.clear();
+   for (auto& edit : edits) {
+      Verbs::Associate associate {Trait::From(edit.mTrait, edit.mValue)};
+      edit.mThing->Run(associate);
+      Notify(edit.mThing.Get(), edit.mTrait);
+   }
+   VERBOSE_GUI("Sent ", mSentEdits, " edits");
+}
+
+/// Draw the GUI system                                                       
 void GUISystem::Draw(Verb&) {
+   ImGui::SetCurrentContext(mContext);
+
+   // The renderer has consumed the previous frame's captures by now,   
+   // those it didn't acknowledge are captured again                    
+   for (auto& capture : mLayerCaptures)
+      capture.mLayer->Drop(capture.mSerial);
+   mLayerCaptures.clear();
+
+   // Between UI frames the last draw data is drawn again, as it is -   
+   // it stays valid until the next ImGui::Render, and it's all staged  
+   const auto now = std::chrono::steady_clock::now();
+   if (not IsFrameDue(now)) {
+      if (not Composite())
+         mUpload.Reuse();
+      ++mSkippedFrames;
+      return;
+   }
+
+   // ImGui animates by the time between UI frames, not drawn frames    
+   if (mLastFrame != std::chrono::steady_clock::time_point {}) {
+      const std::chrono::duration<float> delta = now - mLastFrame;
+      mIO->DeltaTime = std::max(delta.count(), 1e-5f);
+   }
+   mLastFrame = now;
+   mWoken = false;
+
+   // The previous frame is drawn, so icons can be moved in the atlas   
+   mIcons.BeginFrame();
+   Refresh();
+
+   // Animated values are written into the items before they're submitted
+   mTweens.Update(mIO->DeltaTime);
+
    //ImGui_ImplGlfw_NewFrame();
    /*{
       ImGuiIO& io = ImGui::GetIO();
@@ -430,14 +788,50 @@ void GUISystem::Draw(Verb&) {
 
    ImGui::NewFrame();
 
-   ImGui::Begin("Hello, world!");                          // Create a window called "Hello, world!" and append into it.
-   ImGui::Text("This is some useful text.");               // Display some text (you can use a format strings too)
-   ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-   ImGui::End();
+   // Submit all top-level items, they will submit their children       
+   mCulledItems = 0;
+   for (auto item : mRoots)
+      item->Submit();
+
+   // Icons that weren't drawn for a while are evicted from the atlas   
+   mIcons.EndFrame();
+
+   // Edits are committed while submitting, and sent all at once        
+   SendEdits();
+
+   // Windows are ordered only once all of them are submitted           
+   mSpatial.EndFrame();
+   mHovered = mSpatial.HitTest(mIO->MousePos);
 
    // Rendering
    ImGui::Render();
-   //ImDrawData* draw_data = ImGui::GetDrawData();
+   CaptureLayers(ImGui::GetDrawData());
+
+   // Layers are captured before culling, because windows that are      
+   // hidden now might be uncovered while their layer is still used     
+   mOcclusion.Cull(ImGui::GetDrawData());
+   VERBOSE_GUI("Culled ", mOcclusion.GetCulledCommands(), " commands, ",
+      mOcclusion.GetCulledArea(), " pixels of overdraw");
+
+   // Systems that share their window leave the staging to the          
+   // compositor, which draws all of them in a single pass              
+   if (Composite())
+      return;
+
+   // Convert the geometry to instances, or stage the triangles - draw  
+   // lists that didn't change since the last frame keep their range    
+   // and aren't copied again                                           
+   if (mOutput == Output::Instances) {
+      mInstances.Build(ImGui::GetDrawData());
+      VERBOSE_GUI("Built ", mInstances.GetOutputBytes(), " bytes of instances from ",
+         mInstances.GetInputBytes(), " bytes of triangles");
+   }
+   else {
+      mUpload.Stage(ImGui::GetDrawData(), &mWorkers,
+         not (mIO->BackendFlags & ImGuiBackendFlags_RendererHasVtxOffset));
+      VERBOSE_GUI("Staged ", mUpload.GetUploadedBytes(), " bytes, saved ",
+         mUpload.GetSavedBytes(), " bytes");
+   }
 
 
    // Record dear imgui primitives into command buffer
@@ -585,9 +979,232 @@ void GUISystem::Draw(Verb&) {
    }*/
 }
 
+/// Set the rate at which the UI is updated, independently of the rate at     
+/// which it's drawn                                                          
+///   @param rate - UI frames per second, zero to update every drawn frame    
+void GUISystem::SetTargetRate(float rate) noexcept {
+   mTargetRate = std::max(rate, 0.0f);
+   mWoken = true;
+}
+
+/// Limit the time spent refreshing items in a frame, so that large changes   
+/// are spread over several frames instead of causing a hitch                 
+///   @param milliseconds - the budget, zero to refresh everything at once    
+void GUISystem::SetRefreshBudget(float milliseconds) noexcept {
+   mRefreshBudget = std::max(milliseconds, 0.0f);
+}
+
+/// Check if a UI frame has to run now                                        
+/// Input and animations never wait for the cadence, so that hover and click  
+/// feedback stays as responsive as the drawn frame rate                      
+///   @param now - the current time                                           
+///   @return true if NewFrame/Render have to run                             
+bool GUISystem::IsFrameDue(std::chrono::steady_clock::time_point now) const {
+   if (mTargetRate <= 0 or mWoken or mTweens.IsRunning())
+      return true;
+
+   // Input events are queued by the platform until the next NewFrame   
+   if (mContext.Get()->InputEventsQueue.Size > 0)
+      return true;
+
+   const std::chrono::duration<float> elapsed = now - mLastFrame;
+   return elapsed.count() >= 1.0f / mTargetRate;
+}
+
+/// Acknowledge that the renderer has drawn a capture into its layer's image  
+/// Until then, the layer isn't composited                                    
+///   @param capture - one of the captures in GetLayerCaptures                
+void GUISystem::AcknowledgeCapture(const GUILayer::Capture& capture) {
+   capture.mLayer->Acknowledge(capture.mSerial);
+}
+
+/// Capture the windows that were drawn live into their layers, and update    
+/// the change frequency of every window                                      
+///   @param data - the rendered draw data                                    
+void GUISystem::CaptureLayers(const ImDrawData* data) {
+   std::vector<const ImDrawList*> windows;
+   windows.reserve(mRoots.size());
+   for (auto root : mRoots) {
+      if (root->mLayer->GetDrawList())
+         windows.push_back(root->mLayer->GetDrawList());
+   }
+
+   for (auto root : mRoots) {
+      root->mLayer->Capture(*root, data, windows, mLayerCaptures);
+      root->mLayer->EndFrame();
+   }
+}
+
 /// React on environmental change                                             
+/// Reprocesses only the items that were marked dirty since the last refresh, 
+/// instead of rereading every item's descriptor and traits. Items that were  
+/// culled are parked, and looked at again only after a culled subtree was    
+/// displayed again. With a refresh budget, focused and visible items are     
+/// reprocessed first, and whatever doesn't fit in the budget is left for the 
+/// next frames                                                               
 void GUISystem::Refresh() {
+   using Clock = std::chrono::steady_clock;
+   const auto start = Clock::now();
+   const auto deeper = [](const GUIItem* a, const GUIItem* b) {
+      return a->mDepth > b->mDepth;
+   };
+
+   // Destroyed items leave holes behind                                
+   if (mScheduledHoles) {
+      std::erase(mScheduled, nullptr);
+      mScheduledHoles = 0;
+   }
+   if (mParkedHoles) {
+      std::erase(mParked, nullptr);
+      Reindex(mParked, GUIItem::QueuedParked);
+      mParkedHoles = 0;
+   }
+
+   // Detached items moved their children closer to the top             
+   if (mReorder) {
+      std::stable_sort(mScheduled.begin(), mScheduled.end(), deeper);
+      mReorder = false;
+   }
+
+   // Processing may dirty more items, so new items are taken out first 
+   auto incoming = std::move(mDirtyItems);
+   mDirtyItems.clear();
+   std::erase(incoming, nullptr);
+
+   // Parked items are looked at only after a culled subtree was        
+   // displayed again, and those that aren't culled anymore rejoin      
+   if (mUncovered) {
+      const auto uncovered = std::stable_partition(
+         mParked.begin(), mParked.end(),
+         [](const GUIItem* item) { return item->IsCulled(); });
+      incoming.insert(incoming.end(), uncovered, mParked.end());
+      mParked.erase(uncovered, mParked.end());
+      Reindex(mParked, GUIItem::QueuedParked);
+      mUncovered = false;
+   }
+
+   // ...and merged into the schedule                                   
+   if (not incoming.empty()) {
+      std::stable_sort(incoming.begin(), incoming.end(), deeper);
+      const auto middle = static_cast<std::ptrdiff_t>(mScheduled.size());
+      mScheduled.insert(mScheduled.end(), incoming.begin(), incoming.end());
+      std::inplace_merge(mScheduled.begin(), mScheduled.begin() + middle,
+         mScheduled.end(), deeper);
+   }
+
+   // Items in culled subtrees are parked until they're submitted again 
+   const auto culled = std::stable_partition(
+      mScheduled.begin(), mScheduled.end(),
+      [](const GUIItem* item) { return not item->IsCulled(); });
+   for (auto item = culled; item != mScheduled.end(); ++item)
+      Enqueue(mParked, GUIItem::QueuedParked, *item);
+   mScheduled.erase(culled, mScheduled.end());
+   Reindex(mScheduled, GUIItem::QueuedScheduled);
+
+   mRefreshedItems = 0;
+   if (mScheduled.empty())
+      return;
+
+   // Without a budget everything is refreshed at once                  
+   constexpr uint8_t Ranks = 3;
+   const bool budgeted = mRefreshBudget > 0;
+   std::vector<uint8_t> urgency(mScheduled.size());
+   if (budgeted) {
+      for (Offset i = 0; i < mScheduled.size(); ++i)
+         urgency[i] = GetUrgency(*mScheduled[i]);
+   }
+
+   // Items are taken in batches, and no batch is started if it's       
+   // expected to take longer than what's left of the budget            
+   const std::chrono::duration<float, std::milli> budget {mRefreshBudget};
+   std::vector<GUIItem*> batch;
+   batch.reserve(RefreshBatch);
+   Clock::duration last {};
+   bool full = false;
+   const auto run = [&] {
+      // A batch can span several ranks, each of them in depth order,   
+      // so it's put back in depth order as a whole                     
+      std::stable_sort(batch.begin(), batch.end(), deeper);
+      const auto before = Clock::now();
+      Reprocess(batch);
+      mRefreshedItems += batch.size();
+      batch.clear();
+
+      const auto after = Clock::now();
+      last = after - before;
+      full = after - start + last > budget;
+   };
+
+   for (uint8_t rank = 0; rank < Ranks and not full; ++rank) {
+      for (Offset i = 0; i < mScheduled.size() and not full; ++i) {
+         if (urgency[i] != rank or not mScheduled[i])
+            continue;
+
+         batch.push_back(mScheduled[i]);
+         mScheduled[i]->mQueue = GUIItem::Unqueued;
+         mScheduled[i] = nullptr;
+         if (budgeted and batch.size() == RefreshBatch)
+            run();
+      }
+   }
+
+   if (not batch.empty())
+      run();
+   std::erase(mScheduled, nullptr);
+   Reindex(mScheduled, GUIItem::QueuedScheduled);
+   mScheduledHoles = 0;
+
+   if (budgeted and Clock::now() - start > budget)
+      ++mOverruns;
+
+   // Keep updating, even if nothing else requests a UI frame - parked  
+   // items don't count, they wait for their subtree to be displayed    
+   if (not mScheduled.empty())
+      mWoken = true;
+   VERBOSE_GUI("Refreshed ", mRefreshedItems, " items, ",
+      mScheduled.size(), " deferred, ", mParked.size(), " parked");
+}
+
+/// Reprocess a group of dirty items                                          
+/// Content is reread first, then layout is recomputed from the deepest       
+/// items upwards, so that every ancestor sees the final size of its children 
+///   @param items - the items, ordered from the deepest                      
+void GUISystem::Reprocess(const std::vector<GUIItem*>& items) {
+   for (auto item : items) {
+      if (item->mDirt & GUIItem::DirtyContent)
+         item->Reprocess(GUIItem::DirtyContent);
+   }
+
+   for (auto item : items) {
+      if (item->mDirt & GUIItem::DirtyLayout)
+         item->Reprocess(GUIItem::DirtyLayout);
+      item->mDirt = GUIItem::Clean;
+
+      // A parent that was laid out in an earlier batch, or in an       
+      // earlier frame, has to see the new size                         
+      if (item->mParent and not item->mParent->mDirt)
+         item->mParent->MarkDirty(GUIItem::DirtyLayout);
+   }
+}
 
+/// Rank a dirty item for the refresh budget                                  
+/// Items that weren't displayed yet are ranked by their closest displayed    
+/// ancestor, and new windows are considered visible                          
+///   @param item - the item                                                  
+///   @return 0 for focused items, 1 for visible items, 2 for the rest        
+uint8_t GUISystem::GetUrgency(const GUIItem& item) const {
+   if (&item == mHovered or item.mEditing)
+      return 0;
+
+   auto displayed = &item;
+   while (displayed and not mSpatial.IsIndexed(*displayed))
+      displayed = displayed->mParent;
+   if (not displayed)
+      return 1;
+
+   if (not mSpatial.IsVisible(*displayed))
+      return 2;
+   return mSpatial.IsFocused(*displayed) ? 0 : 1;
 }
 
 
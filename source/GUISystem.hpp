@@ -8,8 +8,20 @@
 #pragma once
 #include "GUIItem.hpp"
 #include "GUIFont.hpp"
+#include "GUITemplate.hpp"
+#include "GUIWorkers.hpp"
+#include "GUITextCache.hpp"
+#include "GUIUpload.hpp"
+#include "GUIOcclusion.hpp"
+#include "GUIInstances.hpp"
+#include "GUITextures.hpp"
+#include "GUIIcons.hpp"
+#include "GUISpatial.hpp"
+#include "GUITweens.hpp"
 #include <Langulus/Platform.hpp>
 #include <Langulus/Graphics.hpp>
+#include <chrono>
+#include <unordered_map>
 
 
 ///                                                                           
@@ -24,6 +36,17 @@ struct GUISystem final : A::UI::System, ProducedFrom<GUI> {
    LANGULUS_BASES(A::UI::System);
    LANGULUS_VERBS(Verbs::Create);
 
+   /// Formats of the geometry handed to the renderer                         
+   enum class Output : uint8_t {
+      // ImGui's triangles, staged by GUIUpload                         
+      Triangles,
+      // Instanced quads with triangle fallback, built by GUIInstances  
+      Instances
+   };
+
+   // Items refreshed between checks of the refresh budget              
+   static constexpr Count RefreshBatch = 64;
+
 private:
    Ref<A::Window> mWindow;
    Ref<A::Renderer> mRenderer;
@@ -47,10 +70,91 @@ private:
    GLFWcharfun             PrevUserCallbackChar;
    GLFWmonitorfun          PrevUserCallbackMonitor;*/
 
+   // Background workers for sorting, filtering, decoding, etc.         
+   GUIWorkers mWorkers;
+
+   // Items without a parent, submitted as separate windows             
+   std::vector<GUIItem*> mRoots;
+   // Items that have to be reprocessed on the next refresh             
+   std::vector<GUIItem*> mDirtyItems;
+   // Dirty items that didn't fit in the refresh budget, ordered from   
+   // the deepest, so that children are laid out before their parents   
+   std::vector<GUIItem*> mScheduled;
+   // Dirty items inside culled subtrees, looked at again only after a  
+   // subtree is displayed again                                        
+   std::vector<GUIItem*> mParked;
+   // Whether a culled subtree was displayed again since the last refresh
+   bool mUncovered {};
+   // Whether depths changed, so the schedule has to be ordered again   
+   bool mReorder {};
+   // Destroyed items left in the schedule and in the parking           
+   Count mScheduledHoles {};
+   Count mParkedHoles {};
+   // Milliseconds a refresh may take per frame, zero for no limit      
+   float mRefreshBudget {};
+   // Refreshes that took longer than the budget                        
+   Count mOverruns {};
+   // Items skipped by culling during the last frame                    
+   Count mCulledItems {};
+   // Items interested in changes of a given entity, and optionally     
+   // only a specific trait in it                                       
+   struct Subscription {
+      GUIItem* mItem;
+      TMeta mTrait;
+   };
+   std::unordered_map<const Thing*, std::vector<Subscription>> mSubscribers;
+   // Edits of bound traits, sent together at the end of each frame -   
+   // the entities are kept alive until the edits are sent              
+   struct Edit {
+      Ref<Thing> mThing;
+      TMeta mTrait;
+      Many mValue;
+   };
+   std::vector<Edit> mEdits;
+   // Number of edits sent at the end of the last frame                 
+   Count mSentEdits {};
+   // Compiled widget templates, indexed by the hash of their shape     
+   std::unordered_multimap<size_t, GUITemplate> mTemplates;
+   // Measured labels, invalidated when fonts change                    
+   GUITextCache mTextCache;
+   // Number of items reprocessed during the last refresh               
+   Count mRefreshedItems {};
+   // Staged vertices and indices of the last drawn frame               
+   GUIUpload mUpload;
+   // Removes draw commands hidden behind opaque windows                
+   GUIOcclusion mOcclusion;
+   // Geometry format, and the instanced stream if used                 
+   Output mOutput {Output::Triangles};
+   GUIInstances mInstances;
+   // Windows that the renderer has to draw into their layers           
+   std::vector<GUILayer::Capture> mLayerCaptures;
+   // Small images packed into shared pages                             
+   GUIIcons mIcons;
+   // Rectangles of the submitted items, and the item under the mouse   
+   GUISpatial mSpatial;
+   GUIItem* mHovered {};
+   // Running animations of item properties                             
+   GUITweens mTweens;
+
+   // UI frames per second, zero to update on every drawn frame         
+   float mTargetRate {};
+   // Time of the last UI frame                                         
+   std::chrono::steady_clock::time_point mLastFrame {};
+   // Set when something requests an update before the next UI frame    
+   bool mWoken {true};
+   // Drawn frames that reused the last UI frame                        
+   Count mSkippedFrames {};
+
    // List of created GUI items                                         
    TFactory<GUIItem> mItems;
    TFactoryUnique<GUIFont> mFonts;
 
+   void Reprocess(const std::vector<GUIItem*>&);
+   NOD() uint8_t GetUrgency(const GUIItem&) const;
+   void Enqueue(std::vector<GUIItem*>&, GUIItem::Queue, GUIItem*);
+   void Dequeue(GUIItem*);
+   static void Reindex(std::vector<GUIItem*>&, GUIItem::Queue);
+
 public:
    GUISystem(GUI*, Describe);
    ~GUISystem();
@@ -60,6 +164,58 @@ public:
 
    void Refresh();
 
+   const GUITemplate& GetTemplate(const GUITemplate::Shape&);
+   void Attach(GUIItem*);
+   void Detach(GUIItem*);
+   void EnqueueDirty(GUIItem*);
+   void Uncover() noexcept { mUncovered = true; }
+
+   void Subscribe(GUIItem*, const Thing*, TMeta = {});
+   void Unsubscribe(GUIItem*, const Thing*);
+   void Notify(const Thing*, TMeta = {});
+   void Commit(Thing*, TMeta, Many&&);
+   void SendEdits();
+   void FontsChanged();
+   void IconsMoved();
+   void CaptureLayers(const ImDrawData*);
+   bool Composite();
+   NOD() GUITextures& GetTextures();
+   NOD() A::Image* CreateImage(ImVec2);
+   NOD() bool IsFrameDue(std::chrono::steady_clock::time_point) const;
+
+   void SetTargetRate(float) noexcept;
+   void SetRefreshBudget(float) noexcept;
+   void Wake() noexcept { mWoken = true; }
+
+   NOD() auto& GetWorkers() noexcept { return mWorkers; }
+   NOD() Count GetRefreshedCount() const noexcept { return mRefreshedItems; }
+   NOD() Count GetQueueDepth() const noexcept {
+      return mScheduled.size() - mScheduledHoles
+           + mParked.size() - mParkedHoles;
+   }
+   NOD() Count GetOverruns() const noexcept { return mOverruns; }
+   NOD() float GetRefreshBudget() const noexcept { return mRefreshBudget; }
+   NOD() Count GetCulledItems() const noexcept { return mCulledItems; }
+   void AddCulled(Count count) noexcept { mCulledItems += count; }
+   NOD() Count GetPendingEdits() const noexcept { return mEdits.size(); }
+   NOD() Count GetSentEdits() const noexcept { return mSentEdits; }
+   NOD() Count GetTemplateCount() const noexcept { return mTemplates.size(); }
+   NOD() auto& GetTextCache() noexcept { return mTextCache; }
+   NOD() auto& GetUpload() const noexcept { return mUpload; }
+   NOD() auto& GetOcclusion() const noexcept { return mOcclusion; }
+   NOD() auto& GetInstances() const noexcept { return mInstances; }
+   NOD() auto GetOutput() const noexcept { return mOutput; }
+   bool SetOutput(Output);
+   void SetVertexFormat(GUIUpload::Format format) noexcept { mUpload.SetFormat(format); }
+   NOD() auto& GetLayerCaptures() const noexcept { return mLayerCaptures; }
+   void AcknowledgeCapture(const GUILayer::Capture&);
+   NOD() auto& GetIcons() noexcept { return mIcons; }
+   NOD() auto& GetSpatial() noexcept { return mSpatial; }
+   NOD() auto& GetTweens() noexcept { return mTweens; }
+   NOD() auto GetHovered() const noexcept { return mHovered; }
+   NOD() float GetTargetRate() const noexcept { return mTargetRate; }
+   NOD() Count GetSkippedFrames() const noexcept { return mSkippedFrames; }
+
    NOD() auto GetWindow() const noexcept { return mWindow; }
    NOD() auto& GetClipboard() noexcept { return mClipboard; }
    NOD() ImGuiIO* GetIO() const noexcept { return mIO.Get(); }
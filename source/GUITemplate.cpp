@@ -0,0 +1,169 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUITemplate.hpp"
+#include "GUI.hpp"
+#include <functional>
+
+
+/// Map a widget token to a kind                                              
+///   @param token - the token to parse                                       
+///   @param fallback - kind to use if token isn't recognized                 
+///   @return the widget kind                                                 
+GUIItem::Kind ParseWidgetKind(const Text& token, GUIItem::Kind fallback) {
+   const auto lowercase = token.Lowercase();
+   if (lowercase == "window")    return GUIItem::Kind::Window;
+   if (lowercase == "label")     return GUIItem::Kind::Label;
+   if (lowercase == "button")    return GUIItem::Kind::Button;
+   if (lowercase == "checkbox")  return GUIItem::Kind::Checkbox;
+   if (lowercase == "slider")    return GUIItem::Kind::Slider;
+   if (lowercase == "list")      return GUIItem::Kind::List;
+   if (lowercase == "table")     return GUIItem::Kind::Table;
+   if (lowercase == "plot")      return GUIItem::Kind::Plot;
+   if (lowercase == "console")   return GUIItem::Kind::Console;
+   if (lowercase == "inspector") return GUIItem::Kind::Inspector;
+   if (lowercase == "thumbnails") return GUIItem::Kind::Thumbnails;
+   if (lowercase == "editor")    return GUIItem::Kind::Editor;
+   if (lowercase == "input")     return GUIItem::Kind::Input;
+   return fallback;
+}
+
+/// Walk the descriptor once, collecting its traits and hashing its shape     
+/// Only trait types and the widget kind contribute to the shape, so rows     
+/// that differ only in their values share the same template                  
+///   @param descriptor - the descriptor to walk                              
+GUITemplate::Shape::Shape(Describe descriptor) {
+   const auto combine = [this](size_t h) {
+      mHash ^= h + 0x9e3779b97f4a7c15ull + (mHash << 6) + (mHash >> 2);
+   };
+
+   Text kind;
+   descriptor->ForEach([&](const Trait& trait) {
+      const auto meta = trait.GetTrait();
+      if (meta == MetaTraitOf<Traits::Widget>())
+         kind = trait.template AsCast<Text>();
+      else if (meta == MetaTraitOf<Traits::Parent>())
+         mHasParent = true;
+
+      if (mCount < MaxFields)
+         mTraits[mCount++] = &trait;
+      else
+         mExtra.push_back(&trait);
+      combine(std::hash<const void*> {}(meta));
+   });
+
+   mKind = ParseWidgetKind(kind, mHasParent
+      ? GUIItem::Kind::Label : GUIItem::Kind::Window);
+   combine(static_cast<size_t>(mKind));
+}
+
+/// Get the setter that applies a trait type to items                         
+///   @param meta - the trait type                                            
+///   @return the setter, or nullptr if items ignore the trait                
+GUITemplate::Setter GUITemplate::GetSetter(TMeta meta) {
+   if (meta == MetaTraitOf<Traits::Name>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         item.mLabel = trait.template AsCast<Text>().Terminate();
+      };
+   }
+   else if (meta == MetaTraitOf<Traits::Parent>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         item.mParent = trait.template As<GUIItem*>();
+      };
+   }
+   else if (meta == MetaTraitOf<Traits::Data>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         if (item.mWidget)
+            item.mWidget->SetData(trait);
+      };
+   }
+   else if (meta == MetaTraitOf<Traits::Static>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         item.SetStatic(trait.template AsCast<bool>());
+      };
+   }
+   else if (meta == MetaTraitOf<Traits::Layer>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         item.mLayer = std::make_unique<GUILayer>(
+            trait.template AsCast<bool>()
+               ? GUILayer::Mode::Always : GUILayer::Mode::Off);
+      };
+   }
+   else if (meta == MetaTraitOf<Traits::Limits>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         item.mMin = trait.template AsCast<float>(0);
+         if (trait.GetCount() > 1)
+            item.mMax = trait.template AsCast<float>(1);
+      };
+   }
+   else if (meta == MetaTraitOf<Traits::Size>()) {
+      return [](GUIItem& item, const Trait& trait) {
+         item.mRequestedSize.x = trait.template AsCast<float>(0);
+         if (trait.GetCount() > 1)
+            item.mRequestedSize.y = trait.template AsCast<float>(1);
+      };
+   }
+   return nullptr;
+}
+
+/// Compile a template from the first descriptor of a given shape             
+///   @param shape - the collected descriptor                                 
+GUITemplate::GUITemplate(const Shape& shape)
+   : mKind {shape.mKind}
+   , mFieldCount {shape.mCount} {
+   for (Offset i = 0; i < shape.mCount; ++i) {
+      mTraits[i] = shape.mTraits[i]->GetTrait();
+      mSetters[i] = GetSetter(mTraits[i]);
+   }
+
+   // Defaults for the kind                                             
+   if (mKind == GUIItem::Kind::Window)
+      mSize = {320, 240};
+   else if (mKind == GUIItem::Kind::List or mKind == GUIItem::Kind::Table
+        or mKind == GUIItem::Kind::Console
+        or mKind == GUIItem::Kind::Inspector)
+      mSize = {0, 300};
+   else if (mKind == GUIItem::Kind::Plot)
+      mSize = {0, 150};
+   else if (mKind == GUIItem::Kind::Thumbnails
+        or mKind == GUIItem::Kind::Editor)
+      mSize = {0, 400};
+}
+
+/// Check if a descriptor has exactly the shape this template was compiled    
+/// from - different shapes may have the same hash                            
+///   @param shape - the collected descriptor                                 
+///   @return true if the template can configure items from the descriptor    
+bool GUITemplate::Matches(const Shape& shape) const noexcept {
+   if (mKind != shape.mKind or mFieldCount != shape.mCount)
+      return false;
+
+   for (Offset i = 0; i < mFieldCount; ++i) {
+      if (mTraits[i] != shape.mTraits[i]->GetTrait())
+         return false;
+   }
+   return true;
+}
+
+/// Configure an item from a descriptor of this template's shape              
+///   @param item - the item to configure                                     
+///   @param shape - the collected descriptor                                 
+void GUITemplate::Instantiate(GUIItem& item, const Shape& shape) const {
+   item.mKind = mKind;
+   item.mRequestedSize = mSize;
+   item.CreateWidget();
+   for (Offset i = 0; i < mFieldCount; ++i) {
+      if (mSetters[i])
+         mSetters[i](item, *shape.mTraits[i]);
+   }
+
+   // Traits beyond the template are looked up for each item            
+   for (auto trait : shape.mExtra) {
+      if (const auto setter = GetSetter(trait->GetTrait()))
+         setter(item, *trait);
+   }
+}
@@ -0,0 +1,61 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIItem.hpp"
+
+
+///                                                                           
+///   Compiled widget template                                                
+///                                                                           
+/// Descriptors of identical shape (same widget kind, same traits in the      
+/// same order) are parsed only once. The result is a compact list of         
+/// setters, one for each trait position in the descriptor, so that any       
+/// later descriptor of that shape is applied by walking it once, instead     
+/// of seeking each trait with SeekValueAux/SeekTraitAux                      
+///                                                                           
+struct GUITemplate {
+   // Applies a single trait from the descriptor to an item             
+   using Setter = void(*)(GUIItem&, const Trait&);
+
+   // Maximum number of traits in a templated descriptor - descriptors  
+   // with more traits still work, but the extra traits are applied to  
+   // each item separately, without the benefit of the template         
+   static constexpr Count MaxFields = 16;
+
+   /// Traits of a descriptor, collected in a single walk                     
+   struct Shape {
+      const Trait* mTraits[MaxFields] {};
+      Count mCount {};
+      // Traits that didn't fit in mTraits                              
+      std::vector<const Trait*> mExtra;
+      GUIItem::Kind mKind {GUIItem::Kind::Label};
+      bool mHasParent {};
+      size_t mHash {};
+
+      Shape(Describe);
+   };
+
+   // Kind of widget the template produces                              
+   GUIItem::Kind mKind {GUIItem::Kind::Label};
+   // Trait type and setter for each trait position, the setter is      
+   // nullptr for ignored traits                                        
+   TMeta mTraits[MaxFields] {};
+   Setter mSetters[MaxFields] {};
+   Count mFieldCount {};
+   // Default requested size for the kind                               
+   ImVec2 mSize {};
+
+   NOD() static Setter GetSetter(TMeta);
+
+   GUITemplate() = default;
+   GUITemplate(const Shape&);
+
+   void Instantiate(GUIItem&, const Shape&) const;
+   NOD() bool Matches(const Shape&) const noexcept;
+};
+
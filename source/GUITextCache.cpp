@@ -0,0 +1,242 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUITextCache.hpp"
+#include <algorithm>
+#include <functional>
+
+
+/// Combine all parts of the key into a single hash                           
+///   @param key - the key to hash                                            
+///   @return the hash                                                        
+size_t GUITextCache::KeyHash::operator () (const Key& key) const noexcept {
+   size_t result = key.mHash;
+   const auto combine = [&result](size_t h) {
+      result ^= h + 0x9e3779b97f4a7c15ull + (result << 6) + (result >> 2);
+   };
+
+   combine(key.mLength);
+   combine(std::hash<const void*> {}(key.mFont));
+   combine(std::hash<float> {}(key.mSize));
+   combine(std::hash<float> {}(key.mWrapWidth));
+   return result;
+}
+
+/// Cache construction                                                        
+///   @param capacity - maximum number of cached layouts                      
+GUITextCache::GUITextCache(Count capacity)
+   : mCapacity {std::max<Count>(capacity, 1)} {}
+
+/// Forget everything - fonts or the atlas have changed                       
+void GUITextCache::Invalidate() {
+   mEntries.clear();
+   mIndex.clear();
+   mMonospace.clear();
+}
+
+/// Check if a font is monospace for printable ASCII characters               
+/// Checked only once per font, until the cache is invalidated                
+///   @param font - the font to check                                         
+///   @return the advance of a character at the font's size, or zero          
+float GUITextCache::GetMonospaceAdvance(const ImFont* font) {
+   const auto found = mMonospace.find(font);
+   if (found != mMonospace.end())
+      return found->second;
+
+   float advance = 0;
+   if (font->IndexAdvanceX.Size > 0x7E) {
+      advance = font->IndexAdvanceX[0x20];
+      for (int c = 0x21; c <= 0x7E; ++c) {
+         if (font->IndexAdvanceX[c] != advance) {
+            advance = 0;
+            break;
+         }
+      }
+   }
+
+   mMonospace.emplace(font, advance);
+   return advance;
+}
+
+/// Measure printable ASCII text with a fixed advance, by counting characters 
+/// Wraps at spaces like ImGui does, falling back to breaking words that      
+/// don't fit on a line by themselves                                         
+///   @param layout - [out] the layout                                        
+///   @param text - the text                                                  
+///   @param advance - width of a character                                   
+///   @param lineHeight - height of a line                                    
+///   @param wrapWidth - width to wrap at, or zero                            
+void GUITextCache::MeasureMonospace(Layout& layout, std::string_view text, float advance, float lineHeight, float wrapWidth) const {
+   const auto perLine = wrapWidth > 0
+      ? std::max<size_t>(1, static_cast<size_t>(wrapWidth / advance))
+      : SIZE_MAX;
+
+   size_t widest = 0;
+   size_t lineStart = 0;
+   size_t lastSpace = SIZE_MAX;
+   Count lines = 1;
+
+   for (size_t i = 0; i < text.size(); ++i) {
+      const char c = text[i];
+      if (c == '\n') {
+         widest = std::max(widest, i - lineStart);
+         lineStart = i + 1;
+         lastSpace = SIZE_MAX;
+         layout.mBreaks.push_back(static_cast<uint32_t>(lineStart));
+         ++lines;
+         continue;
+      }
+
+      if (c == ' ')
+         lastSpace = i;
+
+      if (i - lineStart >= perLine) {
+         // Break after the last space, or inside the word if none      
+         const size_t at = lastSpace != SIZE_MAX and lastSpace > lineStart
+            ? lastSpace + 1 : i;
+         widest = std::max(widest, at - lineStart);
+         lineStart = at;
+         lastSpace = SIZE_MAX;
+         layout.mBreaks.push_back(static_cast<uint32_t>(lineStart));
+         ++lines;
+      }
+   }
+
+   widest = std::max(widest, text.size() - lineStart);
+   layout.mSize = {widest * advance, lines * lineHeight};
+}
+
+/// Measure text glyph by glyph, using ImGui's own word wrapping              
+///   @param layout - [out] the layout                                        
+///   @param font - the font                                                  
+///   @param size - the font size                                             
+///   @param text - the text                                                  
+///   @param wrapWidth - width to wrap at, or zero                            
+void GUITextCache::MeasureGlyphs(Layout& layout, const ImFont* font, float size, std::string_view text, float wrapWidth) const {
+   const auto begin = text.data();
+   const auto end = begin + text.size();
+   layout.mSize = font->CalcTextSizeA(size, FLT_MAX, wrapWidth, begin, end);
+
+   const float scale = size / font->FontSize;
+   auto line = begin;
+   while (line < end) {
+      const char* next = end;
+      if (wrapWidth > 0)
+         next = font->CalcWordWrapPositionA(scale, line, end, wrapWidth);
+
+      const auto newline = std::find(line, next, '\n');
+      if (newline != next)
+         next = newline + 1;
+      else if (next == line)
+         ++next;
+
+      if (next >= end)
+         break;
+
+      // Skip the spaces that ImGui skips after a wrap                  
+      if (next[-1] != '\n') {
+         while (next < end and (*next == ' ' or *next == '\t'))
+            ++next;
+      }
+
+      layout.mBreaks.push_back(static_cast<uint32_t>(next - begin));
+      line = next;
+   }
+}
+
+/// Measure text, or get the cached result                                    
+///   @param font - the font                                                  
+///   @param size - the font size                                             
+///   @param text - the text                                                  
+///   @param wrapWidth - width to wrap at, or zero to not wrap                
+///   @return the layout, valid until the next Measure or Invalidate          
+const GUITextCache::Layout& GUITextCache::Measure(const ImFont* font, float size, std::string_view text, float wrapWidth) {
+   const Key key {
+      std::hash<std::string_view> {}(text), text.size(),
+      font, size, wrapWidth > 0 ? wrapWidth : 0
+   };
+
+   const auto found = mIndex.find(key);
+   if (found != mIndex.end()) {
+      // Move to front, without reallocating                            
+      mEntries.splice(mEntries.begin(), mEntries, found->second);
+      if (found->second->mText == text) {
+         ++mHits;
+         return found->second->mLayout;
+      }
+
+      // Another text with the same hash - its entry is reused          
+      mIndex.erase(found);
+   }
+   else if (mEntries.size() >= mCapacity) {
+      // Reuse the least recently used entry                            
+      mIndex.erase(mEntries.back().mKey);
+      mEntries.splice(mEntries.begin(), mEntries, std::prev(mEntries.end()));
+   }
+   else mEntries.push_front({});
+
+   ++mMisses;
+   auto& entry = mEntries.front();
+   entry.mKey = key;
+   entry.mText.assign(text);
+   entry.mLayout.mBreaks.clear();
+
+   auto& layout = entry.mLayout;
+   const float advance = GetMonospaceAdvance(font);
+   // Only the characters checked by GetMonospaceAdvance have the same  
+   // advance - control characters such as tabs don't                   
+   const bool printable = std::all_of(text.begin(), text.end(), [](char c) {
+      return (c >= 0x20 and c <= 0x7E) or c == '\n';
+   });
+
+   if (advance > 0 and printable) {
+      const float scale = size / font->FontSize;
+      MeasureMonospace(layout, text, advance * scale, size, key.mWrapWidth);
+   }
+   else MeasureGlyphs(layout, font, size, text, key.mWrapWidth);
+
+   mIndex.emplace(key, mEntries.begin());
+   return layout;
+}
+
+/// Submit a text label, measured through the cache                           
+/// Equivalent to ImGui::TextUnformatted, but lines are rendered from the     
+/// cached wrap positions, so ImGui never measures or wraps them again        
+///   @param text - the text                                                  
+///   @param wrapWidth - width to wrap at, or zero to not wrap                
+void GUITextCache::Label(std::string_view text, float wrapWidth) {
+   const auto font = ImGui::GetFont();
+   const float size = ImGui::GetFontSize();
+   const auto& layout = Measure(font, size, text, wrapWidth);
+
+   const auto origin = ImGui::GetCursorScreenPos();
+   ImGui::Dummy(layout.mSize);
+   if (not ImGui::IsItemVisible())
+      return;
+
+   auto draw = ImGui::GetWindowDrawList();
+   const auto color = ImGui::GetColorU32(ImGuiCol_Text);
+   const auto begin = text.data();
+   uint32_t line = 0;
+   float y = origin.y;
+
+   for (Offset i = 0; i <= layout.mBreaks.size(); ++i) {
+      const uint32_t next = i < layout.mBreaks.size()
+         ? layout.mBreaks[i] : static_cast<uint32_t>(text.size());
+
+      // Trim the new line character and any trailing spaces            
+      auto end = next;
+      while (end > line and (begin[end - 1] == '\n' or begin[end - 1] == ' '))
+         --end;
+
+      if (end > line)
+         draw->AddText(font, size, {origin.x, y}, color, begin + line, begin + end);
+
+      line = next;
+      y += size;
+   }
+}
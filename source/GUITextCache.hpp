@@ -0,0 +1,88 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+///                                                                           
+///   Text measurement and layout cache                                       
+///                                                                           
+/// Remembers the extents and wrap positions of text, keyed by the text's     
+/// hash, the font, the font size and the wrap width, so that unchanged       
+/// labels aren't measured and wrapped again every frame. Entries keep a      
+/// copy of their text, which is compared on lookup, so texts that happen     
+/// to have the same hash never share a layout. Bounded by an                 
+/// LRU, and invalidated whenever fonts or the atlas change. Printable ASCII  
+/// text in monospace fonts is measured by counting characters, without any   
+/// glyph lookups                                                             
+///                                                                           
+struct GUITextCache {
+   /// Measured text                                                          
+   struct Layout {
+      // Extents of the whole text                                      
+      ImVec2 mSize;
+      // Offsets where each line after the first begins, either after   
+      // a new line character or after a wrap                           
+      std::vector<uint32_t> mBreaks;
+   };
+
+private:
+   struct Key {
+      size_t mHash;
+      size_t mLength;
+      const ImFont* mFont;
+      float mSize;
+      float mWrapWidth;
+
+      bool operator == (const Key&) const noexcept = default;
+   };
+
+   struct KeyHash {
+      size_t operator () (const Key&) const noexcept;
+   };
+
+   struct Entry {
+      Key mKey;
+      std::string mText;
+      Layout mLayout;
+   };
+
+   // Most recently used entries are at the front                       
+   std::list<Entry> mEntries;
+   std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mIndex;
+   Count mCapacity;
+
+   // Advance of each font, if it's monospace for ASCII, zero otherwise 
+   std::unordered_map<const ImFont*, float> mMonospace;
+
+   // Statistics since the last reset                                   
+   Count mHits {};
+   Count mMisses {};
+
+   NOD() float GetMonospaceAdvance(const ImFont*);
+   void MeasureMonospace(Layout&, std::string_view, float advance, float lineHeight, float wrapWidth) const;
+   void MeasureGlyphs(Layout&, const ImFont*, float size, std::string_view, float wrapWidth) const;
+
+public:
+   GUITextCache(Count capacity = 4096);
+
+   NOD() const Layout& Measure(const ImFont*, float size, std::string_view, float wrapWidth = 0);
+   void Label(std::string_view, float wrapWidth = 0);
+   void Invalidate();
+   void ResetStatistics() noexcept { mHits = mMisses = 0; }
+
+   NOD() Count GetCount() const noexcept { return mEntries.size(); }
+   NOD() Count GetHits() const noexcept { return mHits; }
+   NOD() Count GetMisses() const noexcept { return mMisses; }
+};
+
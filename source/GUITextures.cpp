@@ -0,0 +1,123 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUITextures.hpp"
+
+
+/// Get the texture identifier of an image, registering it if needed          
+/// Every registration has to be paired with a release                        
+///   @param image - the image to register                                    
+///   @return the identifier to pass to ImGui, null if image is null          
+ImTextureID GUITextures::Register(const A::Image* image) {
+   if (not image)
+      return ToID(0);
+
+   const auto found = mIndices.find(image);
+   if (found != mIndices.end()) {
+      ++mTable[found->second].mReferences;
+      return ToID(found->second);
+   }
+
+   // Reuse released slots first, to keep the array small               
+   uint32_t index;
+   if (not mFree.empty()) {
+      index = mFree.back();
+      mFree.pop_back();
+   }
+   else {
+      index = static_cast<uint32_t>(mTable.size());
+      mTable.push_back({});
+   }
+
+   mTable[index] = {image, 1};
+   mIndices.emplace(image, index);
+   mDirty.push_back(index);
+   return ToID(index);
+}
+
+/// Release a registration of an image                                        
+/// The slot is freed once all registrations are released                     
+///   @param image - the image to release                                     
+void GUITextures::Release(const A::Image* image) {
+   const auto found = mIndices.find(image);
+   if (found == mIndices.end())
+      return;
+
+   const auto index = found->second;
+   if (--mTable[index].mReferences)
+      return;
+
+   mTable[index].mImage = nullptr;
+   mIndices.erase(found);
+   mFree.push_back(index);
+   mDirty.push_back(index);
+}
+
+/// Get the image behind a texture identifier                                 
+///   @param id - the identifier                                              
+///   @return the image, or nullptr if the identifier isn't registered        
+const A::Image* GUITextures::Resolve(ImTextureID id) const noexcept {
+   const auto index = ToIndex(id);
+   return index < mTable.size() ? mTable[index].mImage : nullptr;
+}
+
+/// Count the binds and draw calls a renderer would issue for draw data       
+/// Without bindless textures, every texture change is a descriptor bind      
+/// and every command is a draw call. With them, the array is bound once,     
+/// and consecutive commands of a list that share a clip rectangle are a      
+/// single multi-draw, with the texture index in each indirect record         
+/// Callbacks might change any state, so they end a batch either way          
+///   @param data - the draw data                                             
+///   @param bindless - whether to count as a bindless renderer would         
+///   @return the counts                                                      
+GUITextures::Stats GUITextures::Simulate(const ImDrawData* data, bool bindless) const {
+   Stats stats {};
+   if (not data)
+      return stats;
+
+   ImTextureID bound {};
+   bool batching = false;
+   ImVec4 clip {};
+   for (int n = 0; n < data->CmdListsCount; ++n) {
+      const auto list = data->CmdLists[n];
+      batching = false;
+
+      for (auto& cmd : list->CmdBuffer) {
+         if (cmd.UserCallback) {
+            bound = {};
+            batching = false;
+            continue;
+         }
+
+         if (not cmd.ElemCount)
+            continue;
+         ++stats.mCommands;
+
+         if (bindless) {
+            stats.mBinds = 1;
+
+            const bool sameClip = cmd.ClipRect.x == clip.x
+               and cmd.ClipRect.y == clip.y
+               and cmd.ClipRect.z == clip.z
+               and cmd.ClipRect.w == clip.w;
+            if (not batching or not sameClip)
+               ++stats.mDraws;
+            batching = true;
+            clip = cmd.ClipRect;
+            continue;
+         }
+
+         if (not bound or bound != cmd.TextureId) {
+            bound = cmd.TextureId;
+            ++stats.mBinds;
+         }
+         ++stats.mDraws;
+      }
+   }
+
+   return stats;
+}
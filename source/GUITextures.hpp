@@ -0,0 +1,63 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <unordered_map>
+#include <vector>
+
+
+///                                                                           
+///   Texture registry                                                        
+///                                                                           
+/// Maps images to small integer indices, that are handed to ImGui as         
+/// texture identifiers. The renderer mirrors the table in a single           
+/// descriptor-indexed texture array, bound once per frame, and draws index   
+/// into it - so texture changes no longer break batches. Index zero is       
+/// never used, so that a null identifier remains invalid                     
+///                                                                           
+struct GUITextures {
+   /// Bind and draw call counts of a frame, as a renderer would issue them   
+   struct Stats {
+      Count mCommands;
+      Count mBinds;
+      Count mDraws;
+   };
+
+private:
+   struct Entry {
+      const A::Image* mImage;
+      Count mReferences;
+   };
+
+   // Indexed by texture identifier, null images are free slots         
+   std::vector<Entry> mTable {{nullptr, 0}};
+   std::unordered_map<const A::Image*, uint32_t> mIndices;
+   std::vector<uint32_t> mFree;
+   // Slots that changed since the renderer last updated its array      
+   std::vector<uint32_t> mDirty;
+
+public:
+   NOD() ImTextureID Register(const A::Image*);
+   void Release(const A::Image*);
+   void ClearDirty() noexcept { mDirty.clear(); }
+
+   NOD() const A::Image* Resolve(ImTextureID) const noexcept;
+   NOD() Stats Simulate(const ImDrawData*, bool bindless) const;
+
+   NOD() static ImTextureID ToID(uint32_t index) noexcept {
+      return (ImTextureID) static_cast<uintptr_t>(index);
+   }
+
+   NOD() static uint32_t ToIndex(ImTextureID id) noexcept {
+      return static_cast<uint32_t>((uintptr_t) id);
+   }
+
+   NOD() Count GetCount() const noexcept { return mIndices.size(); }
+   NOD() Count GetCapacity() const noexcept { return mTable.size(); }
+   NOD() auto& GetDirty() const noexcept { return mDirty; }
+};
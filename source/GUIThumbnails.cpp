@@ -0,0 +1,321 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIThumbnails.hpp"
+#include "GUI.hpp"
+#include <Langulus/Image.hpp>
+#include <algorithm>
+#include <cmath>
+
+
+/// Thumbnail grid construction                                               
+///   @param system - the system that owns the background workers             
+GUIThumbnails::GUIThumbnails(GUISystem* system)
+   : mSystem {system}
+   , mShared {std::make_shared<Shared>()} {}
+
+/// Thumbnail grid destruction                                                
+/// Jobs still in progress find their generation stale, and bail out          
+GUIThumbnails::~GUIThumbnails() {
+   ++mShared->mGeneration;
+   Release();
+}
+
+/// Release all pages, every thumbnail has to be decoded again                
+void GUIThumbnails::Release() {
+   for (auto& page : mPages)
+      mSystem->GetTextures().Release(page.Get());
+   mPages.clear();
+   mPageTextures.clear();
+   mSlots.clear();
+   mResident.clear();
+   mUploads.clear();
+}
+
+/// Bind a new image source, discarding all thumbnails of the previous one    
+///   @param source - the source to bind                                      
+void GUIThumbnails::SetSource(std::shared_ptr<const Source> source) {
+   mSource = std::move(source);
+   ++mShared->mGeneration;
+   Release();
+   mRequested.clear();
+   mFailed.clear();
+}
+
+/// Change the memory available for the pages                                 
+/// Shrinking the budget below what's resident releases everything            
+///   @param bytes - the budget, at least a single page is always kept        
+void GUIThumbnails::SetBudget(size_t bytes) {
+   mBudget = std::max(bytes, PageBytes);
+   if (mSlots.size() > GetSlotCapacity())
+      Release();
+}
+
+/// Change the size thumbnails are drawn at                                   
+/// Thumbnails that are already resident aren't decoded again                 
+///   @param size - the size in pixels, at most SlotSize                      
+void GUIThumbnails::SetThumbnailSize(float size) noexcept {
+   mThumbnailSize = std::clamp(size, 16.0f, static_cast<float>(SlotSize));
+}
+
+/// Get the number of thumbnails that fit in the budget                       
+///   @return the number of slots                                             
+Count GUIThumbnails::GetSlotCapacity() const noexcept {
+   return (mBudget / PageBytes) * SlotsPerPage;
+}
+
+/// Queue a thumbnail for decoding, unless it's resident or already queued    
+/// Jobs check if the thumbnail is still wanted before doing anything, so     
+/// that fast scrolling doesn't leave a long tail of useless decoding         
+///   @param index - the thumbnail                                            
+void GUIThumbnails::Request(Offset index) {
+   if (mRequested.size() >= MaxInFlight
+   or mRequested.size() >= mFreeSlots
+   or mResident.contains(index)
+   or mRequested.contains(index)
+   or mFailed.contains(index))
+      return;
+
+   mRequested.insert(index);
+   mSystem->GetWorkers().Push([
+      shared = mShared, source = mSource, index,
+      generation = mShared->mGeneration.load(),
+      size = static_cast<int>(std::ceil(mThumbnailSize))
+   ] {
+      Result result {generation, index, Status::Cancelled, {}};
+      const bool wanted =
+         shared->mGeneration.load(std::memory_order_relaxed) == generation
+         and index >= shared->mWantedBegin.load(std::memory_order_relaxed)
+         and index < shared->mWantedEnd.load(std::memory_order_relaxed);
+
+      if (wanted) {
+         result.mStatus = source->Decode(index, size, result.mPixels)
+            ? Status::Decoded : Status::Failed;
+      }
+
+      std::lock_guard lock {shared->mMutex};
+      shared->mResults.emplace_back(std::move(result));
+   });
+}
+
+/// Take the finished jobs, and store the decoded thumbnails                  
+void GUIThumbnails::Consume() {
+   {
+      std::lock_guard lock {mShared->mMutex};
+      mResults.swap(mShared->mResults);
+   }
+
+   const auto generation = mShared->mGeneration.load();
+   for (auto& result : mResults) {
+      if (result.mGeneration != generation)
+         continue;
+
+      mRequested.erase(result.mIndex);
+      switch (result.mStatus) {
+      case Status::Decoded:
+         Store(result.mIndex, std::move(result.mPixels));
+         break;
+      case Status::Failed:
+         mFailed.insert(result.mIndex);
+         break;
+      case Status::Cancelled:
+         ++mCancelled;
+         break;
+      }
+   }
+
+   mResults.clear();
+}
+
+/// Find a slot for a new thumbnail, evicting the least recently drawn one    
+/// if the budget is exhausted. Called before the cells are submitted, so     
+/// thumbnails drawn in the last frame are still on screen, and are kept      
+///   @return the slot, or UINT32_MAX if all slots were drawn last frame      
+uint32_t GUIThumbnails::AcquireSlot() {
+   if (mSlots.size() < GetSlotCapacity()) {
+      mSlots.push_back({});
+      return static_cast<uint32_t>(mSlots.size() - 1);
+   }
+
+   uint32_t oldest = UINT32_MAX;
+   for (uint32_t i = 0; i < mSlots.size(); ++i) {
+      if (mSlots[i].mUsed + 1 < mFrame
+      and (oldest == UINT32_MAX or mSlots[i].mUsed < mSlots[oldest].mUsed))
+         oldest = i;
+   }
+
+   if (oldest != UINT32_MAX) {
+      mResident.erase(mSlots[oldest].mIndex);
+      ++mEvictions;
+   }
+   return oldest;
+}
+
+/// Place a decoded thumbnail in a slot, and schedule its upload              
+///   @param index - the thumbnail                                            
+///   @param pixels - the decoded pixels                                      
+void GUIThumbnails::Store(Offset index, Pixels&& pixels) {
+   if (pixels.mWidth <= 0 or pixels.mHeight <= 0
+   or pixels.mWidth > SlotSize or pixels.mHeight > SlotSize
+   or pixels.mData.size() != size_t(pixels.mWidth) * pixels.mHeight) {
+      mFailed.insert(index);
+      return;
+   }
+
+   const auto slot = AcquireSlot();
+   if (slot == UINT32_MAX)
+      return;
+
+   // Pages are created only once their first slot is needed            
+   const auto page = slot / SlotsPerPage;
+   while (mPages.size() <= page) {
+      mPages.emplace_back(mSystem->CreateImage({PageSize, PageSize}));
+      mPageTextures.push_back(mSystem->GetTextures().Register(mPages.back().Get()));
+   }
+
+   constexpr int Columns = PageSize / SlotSize;
+   const int local = static_cast<int>(slot % SlotsPerPage);
+   mSlots[slot] = {index, mFrame, pixels.mWidth, pixels.mHeight};
+   mResident[index] = slot;
+   if (mFreeSlots)
+      --mFreeSlots;
+   mUploads.push_back({
+      mPages[page].Get(),
+      (local % Columns) * SlotSize,
+      (local / Columns) * SlotSize,
+      std::move(pixels)
+   });
+}
+
+/// Submit a single cell - the thumbnail if it's resident, or a placeholder   
+///   @param index - the thumbnail                                            
+///   @param cell - size of the cell, including the name                      
+void GUIThumbnails::SubmitCell(Offset index, ImVec2 cell) {
+   const auto pos = ImGui::GetCursorScreenPos();
+   const float size = mThumbnailSize;
+   const ImVec2 min {pos.x + (cell.x - size) * 0.5f, pos.y};
+   const ImVec2 max {min.x + size, min.y + size};
+   auto draw = ImGui::GetWindowDrawList();
+
+   if (const auto found = mResident.find(index); found != mResident.end()) {
+      // Keep the aspect ratio, centered in the thumbnail's box         
+      auto& slot = mSlots[found->second];
+      slot.mUsed = mFrame;
+      const float scale = size / std::max(slot.mWidth, slot.mHeight);
+      const ImVec2 extent {slot.mWidth * scale, slot.mHeight * scale};
+      const ImVec2 at {
+         min.x + (size - extent.x) * 0.5f,
+         min.y + (size - extent.y) * 0.5f
+      };
+
+      constexpr int Columns = PageSize / SlotSize;
+      constexpr float Texel = 1.0f / PageSize;
+      const int local = static_cast<int>(found->second % SlotsPerPage);
+      const float u = (local % Columns) * SlotSize * Texel;
+      const float v = (local / Columns) * SlotSize * Texel;
+      draw->AddImage(
+         mPageTextures[found->second / SlotsPerPage],
+         at, {at.x + extent.x, at.y + extent.y},
+         {u, v}, {u + slot.mWidth * Texel, v + slot.mHeight * Texel}
+      );
+      ++mDrawn;
+   }
+   else {
+      draw->AddRectFilled(min, max, ImGui::GetColorU32(ImGuiCol_FrameBg), 4.0f);
+      if (mFailed.contains(index)) {
+         const auto color = ImGui::GetColorU32(ImGuiCol_TextDisabled);
+         draw->AddLine(min, max, color);
+         draw->AddLine({min.x, max.y}, {max.x, min.y}, color);
+      }
+      else {
+         ++mPlaceholders;
+         Request(index);
+      }
+   }
+
+   // Sources without names leave the output as it is, so the name of   
+   // the previous cell must not carry over                             
+   mName.Clear();
+   mSource->GetName(index, mName);
+   if (mName) {
+      const Token token {mName};
+      draw->PushClipRect(pos, {pos.x + cell.x, pos.y + cell.y}, true);
+      draw->AddText({pos.x, max.y + ImGui::GetStyle().ItemInnerSpacing.y},
+         ImGui::GetColorU32(ImGuiCol_Text),
+         token.data(), token.data() + token.size());
+      draw->PopClipRect();
+   }
+
+   ImGui::Dummy(cell);
+}
+
+/// Submit the visible rows of the grid                                       
+///   @param item - the item that owns the grid                               
+void GUIThumbnails::Submit(GUIItem& item) {
+   // Every slot drawn in the last frame is taken, decoding more than   
+   // the rest would only evict thumbnails that are still visible       
+   const auto capacity = GetSlotCapacity();
+   mFreeSlots = capacity - std::min(capacity, mDrawn);
+   Consume();
+   mPlaceholders = mDrawn = 0;
+   ImGui::PushID(this);
+
+   if (not mSource) {
+      ImGui::TextDisabled("No data");
+      ImGui::PopID();
+      return;
+   }
+
+   if (ImGui::BeginChild("##thumbnails", item.GetRequestedSize())) {
+      const auto& style = ImGui::GetStyle();
+      const ImVec2 cell {
+         mThumbnailSize + style.ItemSpacing.x,
+         mThumbnailSize + ImGui::GetTextLineHeightWithSpacing()
+      };
+      const float rowHeight = cell.y + style.ItemSpacing.y;
+      const int columns = std::max(1, static_cast<int>(
+         (ImGui::GetContentRegionAvail().x + style.ItemSpacing.x)
+         / (cell.x + style.ItemSpacing.x)));
+      const auto count = GetCount();
+      const int rows = static_cast<int>((count + columns - 1) / columns);
+
+      // Publish the wanted range before requesting anything, so that   
+      // no job for a visible thumbnail is cancelled                    
+      const int first = static_cast<int>(ImGui::GetScrollY() / rowHeight);
+      const int visible = static_cast<int>(ImGui::GetWindowHeight() / rowHeight) + 1;
+      const int begin = std::max(0, first - PrefetchRows);
+      const int end = std::min(rows, first + visible + PrefetchRows);
+      const auto wantedBegin = std::min<Offset>(Offset(begin) * columns, count);
+      const auto wantedEnd = std::min<Offset>(Offset(end) * columns, count);
+      mShared->mWantedBegin.store(wantedBegin);
+      mShared->mWantedEnd.store(wantedEnd);
+
+      ImGuiListClipper clipper;
+      clipper.Begin(rows, rowHeight);
+      while (clipper.Step()) {
+         for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            for (int c = 0; c < columns; ++c) {
+               const auto index = Offset(row) * columns + c;
+               if (index >= count)
+                  break;
+               if (c)
+                  ImGui::SameLine();
+               SubmitCell(index, cell);
+            }
+         }
+      }
+
+      // Visible thumbnails were requested first, the prefetched ones   
+      // get what's left of the queue                                   
+      for (auto index = wantedBegin; index < wantedEnd; ++index)
+         Request(index);
+   }
+   ImGui::EndChild();
+
+   ImGui::PopID();
+   ++mFrame;
+}
@@ -0,0 +1,163 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "GUIWidget.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+///                                                                           
+///   Thumbnail grid                                                          
+///                                                                           
+/// An asset browser for any number of images. Only the visible rows are      
+/// submitted, and only the visible thumbnails, plus a few rows around        
+/// them, are decoded - on the system's background workers, so that           
+/// submission never waits for image I/O. Decoded thumbnails are written      
+/// into fixed size slots of a few shared atlas pages, instead of creating    
+/// an image per thumbnail. The pages fit in a memory budget, and once        
+/// it's exhausted, the least recently drawn thumbnails are evicted.          
+/// Placeholders are drawn while thumbnails are loading                       
+///                                                                           
+struct GUIThumbnails final : GUIWidget {
+   /// Decoded RGBA pixels                                                    
+   struct Pixels {
+      int mWidth {};
+      int mHeight {};
+      std::vector<uint32_t> mData;
+   };
+
+   ///                                                                        
+   ///   Provider of the images                                               
+   ///                                                                        
+   /// Decode is called from the background workers, so the source must       
+   /// be safe to use from multiple threads at once, and must not change      
+   /// after it is bound - bind a new source to change the images             
+   ///                                                                        
+   struct Source {
+      virtual ~Source() = default;
+      NOD() virtual Count GetCount() const = 0;
+      virtual void GetName(Offset, Text&) const {}
+      /// Decode an image, downscaled to at most size pixels on each side     
+      virtual bool Decode(Offset, int size, Pixels&) const = 0;
+   };
+
+   /// Decoded pixels to write into a page, for the renderer to do            
+   struct Upload {
+      A::Image* mPage;
+      int mX, mY;
+      Pixels mPixels;
+   };
+
+   // Thumbnails are decoded to fit in a slot                           
+   static constexpr int SlotSize = 128;
+   static constexpr int PageSize = 1024;
+   static constexpr int SlotsPerPage = (PageSize / SlotSize) * (PageSize / SlotSize);
+   static constexpr size_t PageBytes = size_t(PageSize) * PageSize * 4;
+   // Rows decoded ahead of scrolling, above and below the visible ones 
+   static constexpr int PrefetchRows = 2;
+   // Decoding jobs queued at once                                      
+   static constexpr Count MaxInFlight = 32;
+
+private:
+   enum class Status : uint8_t {
+      Decoded,
+      Failed,
+      // Scrolled away before the job started, has to be requested again
+      Cancelled
+   };
+
+   struct Result {
+      uint64_t mGeneration;
+      Offset mIndex;
+      Status mStatus;
+      Pixels mPixels;
+   };
+
+   /// State shared with the background jobs, so that jobs can outlive        
+   /// the widget safely                                                      
+   struct Shared {
+      // Incremented when the source changes, stale jobs bail out       
+      std::atomic<uint64_t> mGeneration {};
+      // Range of thumbnails still wanted, jobs outside of it bail out  
+      std::atomic<Offset> mWantedBegin {};
+      std::atomic<Offset> mWantedEnd {};
+      std::mutex mMutex;
+      std::vector<Result> mResults;
+   };
+
+   struct Slot {
+      Offset mIndex;
+      // Last frame the thumbnail was drawn in                          
+      uint64_t mUsed;
+      int mWidth, mHeight;
+   };
+
+   GUISystem* mSystem;
+   std::shared_ptr<const Source> mSource;
+   std::shared_ptr<Shared> mShared;
+
+   // Atlas pages, created as slots are needed                          
+   std::vector<Ref<A::Image>> mPages;
+   std::vector<ImTextureID> mPageTextures;
+   std::vector<Slot> mSlots;
+   // Resident thumbnails by index, and those being decoded or broken   
+   std::unordered_map<Offset, uint32_t> mResident;
+   std::unordered_set<Offset> mRequested;
+   std::unordered_set<Offset> mFailed;
+   std::vector<Upload> mUploads;
+   std::vector<Result> mResults;
+   // Reused for the name of each submitted thumbnail                   
+   Text mName;
+
+   size_t mBudget {64 * 1024 * 1024};
+   // Slots that weren't drawn in the last frame, so that new thumbnails
+   // can take them - nothing more is requested, or it would be decoded 
+   // only to be thrown away                                            
+   Count mFreeSlots {};
+   float mThumbnailSize {96};
+   uint64_t mFrame {1};
+
+   // Statistics                                                        
+   Count mPlaceholders {};
+   Count mDrawn {};
+   Count mEvictions {};
+   Count mCancelled {};
+
+   NOD() Count GetSlotCapacity() const noexcept;
+   void Request(Offset);
+   void Consume();
+   void Store(Offset, Pixels&&);
+   NOD() uint32_t AcquireSlot();
+   void SubmitCell(Offset, ImVec2 cell);
+   void Release();
+
+public:
+   GUIThumbnails(GUISystem*);
+   ~GUIThumbnails();
+
+   void SetSource(std::shared_ptr<const Source>);
+   void SetBudget(size_t bytes);
+   void SetThumbnailSize(float) noexcept;
+   void Submit(GUIItem&) override;
+   void ClearUploads() noexcept { mUploads.clear(); }
+
+   NOD() Count GetCount() const noexcept { return mSource ? mSource->GetCount() : 0; }
+   NOD() Count GetResidentCount() const noexcept { return mResident.size(); }
+   NOD() size_t GetResidentBytes() const noexcept { return mPages.size() * PageBytes; }
+   NOD() Count GetPendingCount() const noexcept { return mRequested.size(); }
+   NOD() Count GetPlaceholders() const noexcept { return mPlaceholders; }
+   NOD() Count GetDrawnCount() const noexcept { return mDrawn; }
+   NOD() Count GetEvictions() const noexcept { return mEvictions; }
+   NOD() Count GetCancelled() const noexcept { return mCancelled; }
+   NOD() size_t GetBudget() const noexcept { return mBudget; }
+   NOD() auto& GetUploads() const noexcept { return mUploads; }
+};
@@ -0,0 +1,183 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUITweens.hpp"
+#include "GUI.hpp"
+#include <algorithm>
+
+
+/// Coefficients of t, t^2 and t^3 for each easing                            
+static constexpr float EasingCurves[][3] {
+   { 1,  0,  0},  // Linear
+   { 0,  1,  0},  // InQuad
+   { 2, -1,  0},  // OutQuad
+   { 0,  0,  1},  // InCubic
+   { 3, -3,  1},  // OutCubic
+   { 0,  3, -2},  // InOut
+};
+
+/// Get the item state a property is written to                               
+///   @param item - the item                                                  
+///   @param property - the property                                          
+///   @return the value of the property inside the item                       
+float* GUITweens::GetTarget(GUIItem& item, Property property) noexcept {
+   switch (property) {
+   case Property::Alpha:
+      return &item.mAlpha;
+   case Property::OffsetX:
+      return &item.mOffset.x;
+   case Property::OffsetY:
+      return &item.mOffset.y;
+   case Property::Value:
+      return &item.mValue;
+   }
+   return nullptr;
+}
+
+/// Animate a property of an item, from its current value                     
+/// Starting a tween on an animated property retargets it, so reversed        
+/// hover transitions continue from where they are                            
+///   @param item - the item                                                  
+///   @param property - the property to animate                               
+///   @param to - the final value                                             
+///   @param duration - seconds the animation takes                           
+///   @param easing - the easing curve                                        
+void GUITweens::Start(GUIItem& item, Property property, float to, float duration, Easing easing) {
+   const auto target = GetTarget(item, property);
+   if (duration <= 0) {
+      Stop(item, property);
+      *target = to;
+      item.Invalidate();
+      return;
+   }
+
+   auto& slot = item.mTweens[static_cast<Offset>(property)];
+   if (slot == None) {
+      slot = static_cast<uint32_t>(mTarget.size());
+      mFrom.emplace_back();
+      mTo.emplace_back();
+      mElapsed.emplace_back();
+      mDuration.emplace_back();
+      mA.emplace_back();
+      mB.emplace_back();
+      mC.emplace_back();
+      mTarget.push_back(target);
+      mItem.push_back(&item);
+      mProperty.push_back(property);
+   }
+
+   const auto& curve = EasingCurves[static_cast<Offset>(easing)];
+   mFrom[slot] = *target;
+   mTo[slot] = to;
+   mElapsed[slot] = 0;
+   mDuration[slot] = duration;
+   mA[slot] = curve[0];
+   mB[slot] = curve[1];
+   mC[slot] = curve[2];
+}
+
+/// Stop animating a property, leaving it at its current value                
+///   @param item - the item                                                  
+///   @param property - the property                                          
+void GUITweens::Stop(GUIItem& item, Property property) {
+   const auto slot = item.mTweens[static_cast<Offset>(property)];
+   if (slot != None)
+      RemoveAt(slot);
+}
+
+/// Stop all animations of an item that is being destroyed                    
+///   @param item - the item                                                  
+void GUITweens::Remove(GUIItem& item) {
+   for (Offset p = 0; p < PropertyCount; ++p)
+      Stop(item, static_cast<Property>(p));
+}
+
+/// Remove a tween by moving the last one in its place                        
+///   @param i - the tween                                                    
+void GUITweens::RemoveAt(Offset i) {
+   mItem[i]->mTweens[static_cast<Offset>(mProperty[i])] = None;
+
+   const auto last = mTarget.size() - 1;
+   if (i != last) {
+      mFrom[i] = mFrom[last];
+      mTo[i] = mTo[last];
+      mElapsed[i] = mElapsed[last];
+      mDuration[i] = mDuration[last];
+      mA[i] = mA[last];
+      mB[i] = mB[last];
+      mC[i] = mC[last];
+      mTarget[i] = mTarget[last];
+      mItem[i] = mItem[last];
+      mProperty[i] = mProperty[last];
+      mItem[i]->mTweens[static_cast<Offset>(mProperty[i])] =
+         static_cast<uint32_t>(i);
+   }
+
+   mFrom.pop_back();
+   mTo.pop_back();
+   mElapsed.pop_back();
+   mDuration.pop_back();
+   mA.pop_back();
+   mB.pop_back();
+   mC.pop_back();
+   mTarget.pop_back();
+   mItem.pop_back();
+   mProperty.pop_back();
+}
+
+/// Advance all tweens, and write their values into the items                 
+///   @param delta - seconds since the last update                            
+void GUITweens::Update(float delta) {
+   mFinished = 0;
+   const Count count = mTarget.size();
+   if (not count)
+      return;
+
+   mValues.resize(count);
+   Offset i = 0;
+
+#if GUI_SSE2
+   const auto vDelta = _mm_set1_ps(delta);
+   const auto vOne = _mm_set1_ps(1.0f);
+   for (; i + 4 <= count; i += 4) {
+      const auto elapsed = _mm_add_ps(_mm_loadu_ps(&mElapsed[i]), vDelta);
+      _mm_storeu_ps(&mElapsed[i], elapsed);
+      const auto t = _mm_min_ps(
+         _mm_div_ps(elapsed, _mm_loadu_ps(&mDuration[i])), vOne);
+
+      // Ease with Horner's scheme: t * (a + t * (b + t * c))           
+      auto e = _mm_add_ps(_mm_loadu_ps(&mB[i]),
+         _mm_mul_ps(t, _mm_loadu_ps(&mC[i])));
+      e = _mm_add_ps(_mm_loadu_ps(&mA[i]), _mm_mul_ps(t, e));
+      e = _mm_mul_ps(t, e);
+
+      const auto from = _mm_loadu_ps(&mFrom[i]);
+      const auto to = _mm_loadu_ps(&mTo[i]);
+      _mm_storeu_ps(&mValues[i],
+         _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), e)));
+   }
+#endif
+
+   for (; i < count; ++i) {
+      mElapsed[i] += delta;
+      const float t = std::min(mElapsed[i] / mDuration[i], 1.0f);
+      const float e = t * (mA[i] + t * (mB[i] + t * mC[i]));
+      mValues[i] = mFrom[i] + (mTo[i] - mFrom[i]) * e;
+   }
+
+   // Scatter the results, in reverse, so that finished tweens are      
+   // replaced by ones that are already written                         
+   for (i = count; i-- > 0;) {
+      const bool finished = mElapsed[i] >= mDuration[i];
+      *mTarget[i] = finished ? mTo[i] : mValues[i];
+      mItem[i]->Invalidate();
+      if (finished) {
+         RemoveAt(i);
+         ++mFinished;
+      }
+   }
+}
@@ -0,0 +1,82 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <vector>
+
+
+///                                                                           
+///   Animated item properties                                                
+///                                                                           
+/// Tweens interpolate properties of items over time, such as fades, slides   
+/// and hover transitions. All running tweens are kept in parallel arrays,    
+/// and evaluated four at a time, once per UI frame, writing the results      
+/// straight into the items. Finished tweens are replaced by the last one,    
+/// so the arrays stay dense. Items remember the index of their tweens, so    
+/// that starting a tween on an animated property retargets it in place       
+///                                                                           
+struct GUITweens {
+   /// Properties of items that can be animated                               
+   enum class Property : uint8_t {
+      // Opacity of the item and its children                           
+      Alpha,
+      // Displacement of the item, without moving the items after it    
+      OffsetX,
+      OffsetY,
+      // Value of sliders                                               
+      Value
+   };
+   static constexpr Count PropertyCount = 4;
+
+   /// Easing curves, all of them cubic polynomials                           
+   enum class Easing : uint8_t {
+      Linear,
+      InQuad,
+      OutQuad,
+      InCubic,
+      OutCubic,
+      // Slow at both ends, smoothstep                                  
+      InOut
+   };
+
+   // Properties that aren't animated                                   
+   static constexpr uint32_t None = UINT32_MAX;
+
+private:
+   // Values are interpolated from mFrom to mTo by the eased time       
+   std::vector<float> mFrom;
+   std::vector<float> mTo;
+   std::vector<float> mElapsed;
+   std::vector<float> mDuration;
+   // Easing as coefficients of t, t^2 and t^3                          
+   std::vector<float> mA;
+   std::vector<float> mB;
+   std::vector<float> mC;
+   // Where results are written, and what they're written to            
+   std::vector<float*> mTarget;
+   std::vector<GUIItem*> mItem;
+   std::vector<Property> mProperty;
+   // Results of the last update, before they're scattered to items     
+   std::vector<float> mValues;
+
+   // Statistics of the last update                                     
+   Count mFinished {};
+
+   void RemoveAt(Offset);
+   NOD() static float* GetTarget(GUIItem&, Property) noexcept;
+
+public:
+   void Start(GUIItem&, Property, float to, float duration, Easing);
+   void Stop(GUIItem&, Property);
+   void Remove(GUIItem&);
+   void Update(float delta);
+
+   NOD() bool IsRunning() const noexcept { return not mTarget.empty(); }
+   NOD() Count GetCount() const noexcept { return mTarget.size(); }
+   NOD() Count GetFinished() const noexcept { return mFinished; }
+};
@@ -0,0 +1,576 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIUpload.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+
+inline uint64_t Rotate(uint64_t x, int r) noexcept {
+   return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t Read(const uint8_t* p) noexcept {
+   uint64_t v;
+   std::memcpy(&v, p, sizeof(v));
+   return v;
+}
+
+/// Fast non-cryptographic hash in the spirit of XXH64 - four                 
+/// independent lanes consume 32 bytes per iteration                          
+///   @param data - bytes to hash                                             
+///   @param size - number of bytes                                           
+///   @param seed - the hash to continue from                                 
+///   @return the hash                                                        
+static uint64_t HashBytes(const void* data, size_t size, uint64_t seed) noexcept {
+   auto p = static_cast<const uint8_t*>(data);
+   const auto end = p + size;
+   uint64_t h;
+
+   if (size >= 32) {
+      uint64_t lane[4] {
+         seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1
+      };
+
+      for (; p + 32 <= end; p += 32) {
+         for (int i = 0; i < 4; ++i)
+            lane[i] = Rotate(lane[i] + Read(p + i * 8) * Prime2, 31) * Prime1;
+      }
+
+      h = Rotate(lane[0], 1) + Rotate(lane[1], 7)
+        + Rotate(lane[2], 12) + Rotate(lane[3], 18);
+   }
+   else h = seed + Prime3;
+
+   h += size;
+   for (; p + 8 <= end; p += 8)
+      h = Rotate(h ^ (Rotate(Read(p) * Prime2, 31) * Prime1), 27) * Prime1 + Prime3;
+   for (; p < end; ++p)
+      h = Rotate(h ^ (*p * Prime3), 11) * Prime1;
+
+   // Final avalanche                                                   
+   h ^= h >> 33;
+   h *= Prime2;
+   h ^= h >> 29;
+   h *= Prime3;
+   h ^= h >> 32;
+   return h;
+}
+
+/// Hash the vertex and index payload of a draw list                          
+///   @param list - the draw list                                             
+///   @return the hash                                                        
+uint64_t GUIUpload::Hash(const ImDrawList* list) noexcept {
+   const auto h = HashBytes(list->VtxBuffer.Data,
+      list->VtxBuffer.Size * sizeof(ImDrawVert), 0);
+   return HashBytes(list->IdxBuffer.Data,
+      list->IdxBuffer.Size * sizeof(ImDrawIdx), h);
+}
+
+/// Add a span to a list of dirty spans, merging it with the last one if      
+/// they touch                                                                
+///   @param spans - the list of spans                                        
+///   @param offset - first element                                           
+///   @param count - number of elements                                       
+void GUIUpload::MarkDirty(std::vector<Span>& spans, uint32_t offset, uint32_t count) {
+   if (not count)
+      return;
+
+   if (not spans.empty()) {
+      auto& last = spans.back();
+      if (last.mOffset + last.mCount == offset) {
+         last.mCount += count;
+         return;
+      }
+   }
+
+   spans.push_back({offset, count});
+}
+
+/// Size of a vertex in staging                                               
+///   @param format - the vertex format                                       
+///   @return the size in bytes                                               
+inline size_t VertexSize(GUIUpload::Format format) noexcept {
+   return format == GUIUpload::Format::Packed
+      ? sizeof(GUIUpload::PackedVert) : sizeof(ImDrawVert);
+}
+
+/// Quantize a single vertex to the packed format                             
+///   @param from - the vertex to convert                                     
+///   @param to - [out] the converted vertex                                  
+///   @param origin - display position, positions are relative to it          
+///   @return false if the position is out of range                           
+inline bool PackOne(const ImDrawVert& from, GUIUpload::PackedVert& to, ImVec2 origin) noexcept {
+   const float x = std::round((from.pos.x - origin.x) * GUIUpload::PackedScale);
+   const float y = std::round((from.pos.y - origin.y) * GUIUpload::PackedScale);
+   if (x < -32768.0f or x > 32767.0f or y < -32768.0f or y > 32767.0f)
+      return false;
+
+   to.mPos[0] = static_cast<int16_t>(x);
+   to.mPos[1] = static_cast<int16_t>(y);
+   to.mUV[0] = static_cast<uint16_t>(std::round(std::clamp(from.uv.x, 0.0f, 1.0f) * 65535.0f));
+   to.mUV[1] = static_cast<uint16_t>(std::round(std::clamp(from.uv.y, 0.0f, 1.0f) * 65535.0f));
+   to.mColor = from.col;
+   return true;
+}
+
+/// Copy bytes with non-temporal stores, bypassing the cache - staging is     
+/// written once and then only read by the upload                             
+///   @param to - destination                                                 
+///   @param from - source                                                    
+///   @param bytes - number of bytes to copy                                  
+static void StreamCopy(void* to, const void* from, size_t bytes) noexcept {
+   auto d = static_cast<uint8_t*>(to);
+   auto s = static_cast<const uint8_t*>(from);
+
+#if GUI_SSE2
+   const size_t head = std::min(bytes,
+      (16 - (reinterpret_cast<uintptr_t>(d) & 15)) & 15);
+   std::memcpy(d, s, head);
+   d += head;
+   s += head;
+   bytes -= head;
+
+   for (; bytes >= 64; bytes -= 64, d += 64, s += 64) {
+      const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+      const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+      const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+      const auto e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+      _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+   }
+
+   for (; bytes >= 16; bytes -= 16, d += 16, s += 16) {
+      _mm_stream_si128(reinterpret_cast<__m128i*>(d),
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+   }
+
+   _mm_sfence();
+#endif
+
+   std::memcpy(d, s, bytes);
+}
+
+/// Copy indices, widening them and adding the list's vertex offset, for      
+/// renderers that can't offset vertices per command                          
+///   @param from - indices to copy                                           
+///   @param to - [out] rebased indices                                       
+///   @param count - number of indices                                        
+///   @param base - offset of the list's vertices in staging                  
+static void Rebase(const ImDrawIdx* from, uint32_t* to, uint32_t count, uint32_t base) noexcept {
+   uint32_t i = 0;
+
+#if GUI_SSE2
+   if constexpr (sizeof(ImDrawIdx) == 2) {
+      while (i < count and (reinterpret_cast<uintptr_t>(to + i) & 15))
+         to[i] = from[i] + base, ++i;
+
+      const auto zero = _mm_setzero_si128();
+      const auto offset = _mm_set1_epi32(static_cast<int>(base));
+      for (; i + 8 <= count; i += 8) {
+         const auto narrow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+         _mm_stream_si128(reinterpret_cast<__m128i*>(to + i),
+            _mm_add_epi32(_mm_unpacklo_epi16(narrow, zero), offset));
+         _mm_stream_si128(reinterpret_cast<__m128i*>(to + i + 4),
+            _mm_add_epi32(_mm_unpackhi_epi16(narrow, zero), offset));
+      }
+
+      _mm_sfence();
+   }
+#endif
+
+   for (; i < count; ++i)
+      to[i] = from[i] + base;
+}
+
+/// Quantize vertices to the packed format                                    
+/// Positions out of the fixed point range make the whole conversion fail,    
+/// texture coordinates are clamped to [0;1]. Aligned blocks of four          
+/// vertices are written with non-temporal stores                             
+///   @param from - vertices to convert                                       
+///   @param to - [out] converted vertices                                    
+///   @param count - number of vertices                                       
+///   @param origin - display position, positions are relative to it          
+///   @return false if a position is out of range                             
+bool GUIUpload::Pack(const ImDrawVert* from, PackedVert* to, int count, ImVec2 origin) noexcept {
+   static_assert(sizeof(PackedVert) == 12, "PackedVert must be 12 bytes");
+   int i = 0;
+
+#if GUI_SSE2
+   // Four packed vertices are 48 bytes - three aligned stores          
+   while (i < count and (reinterpret_cast<uintptr_t>(to + i) & 15)) {
+      if (not PackOne(from[i], to[i], origin))
+         return false;
+      ++i;
+   }
+
+   // Texture coordinates are biased by -32768, so that signed saturated
+   // packing can be used for them too, and the bias is flipped back    
+   // in the packed integers                                            
+   const auto scale = _mm_setr_ps(PackedScale, PackedScale, 65535.0f, 65535.0f);
+   const auto offset = _mm_setr_ps(
+      origin.x * PackedScale, origin.y * PackedScale, 32768.0f, 32768.0f);
+   const auto lo = _mm_set1_ps(-32768.0f);
+   const auto hi = _mm_set1_ps(32767.0f);
+   const auto positions = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, 0, 0));
+   const auto flip = _mm_setr_epi16(0, 0, -32768, -32768, 0, 0, -32768, -32768);
+   auto outside = _mm_setzero_ps();
+
+   const auto convert = [&](const ImDrawVert* v) {
+      // Each load takes pos and uv of a vertex, skipping the color     
+      auto a = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&v[0].pos.x), scale), offset);
+      auto b = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&v[1].pos.x), scale), offset);
+      outside = _mm_or_ps(outside, _mm_and_ps(positions, _mm_or_ps(
+         _mm_or_ps(_mm_cmplt_ps(a, lo), _mm_cmpgt_ps(a, hi)),
+         _mm_or_ps(_mm_cmplt_ps(b, lo), _mm_cmpgt_ps(b, hi)))));
+      a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+      b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+      return _mm_xor_si128(flip,
+         _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+   };
+
+   for (; i + 4 <= count; i += 4) {
+      alignas(16) PackedVert block[4];
+      const auto p01 = convert(from + i);
+      const auto p23 = convert(from + i + 2);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(block + 0), p01);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(block + 1), _mm_srli_si128(p01, 8));
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(block + 2), p23);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(block + 3), _mm_srli_si128(p23, 8));
+      for (int j = 0; j < 4; ++j)
+         block[j].mColor = from[i + j].col;
+
+      const auto src = reinterpret_cast<const __m128i*>(block);
+      const auto dst = reinterpret_cast<__m128i*>(to + i);
+      _mm_stream_si128(dst + 0, _mm_load_si128(src + 0));
+      _mm_stream_si128(dst + 1, _mm_load_si128(src + 1));
+      _mm_stream_si128(dst + 2, _mm_load_si128(src + 2));
+   }
+
+   _mm_sfence();
+   if (_mm_movemask_ps(outside))
+      return false;
+#endif
+
+   for (; i < count; ++i) {
+      if (not PackOne(from[i], to[i], origin))
+         return false;
+   }
+
+   return true;
+}
+
+/// Make sure a slot has room for a number of vertices in a format            
+/// Lists that outgrow their range, or change format, are moved to the end    
+/// of the buffer, twice as big as needed, so that growing lists rarely move  
+///   @param slot - the slot to allocate for                                  
+///   @param format - the vertex format                                       
+///   @param count - number of vertices needed                                
+void GUIUpload::AllocateVertices(Slot& slot, Format format, uint32_t count) {
+   if (slot.mVertexCapacity and slot.mRange.mFormat == format
+   and count <= slot.mVertexCapacity)
+      return;
+
+   mGarbage += slot.mVertexCapacity;
+   slot.mVertexCapacity = std::max(count * 2, 64u);
+   slot.mRange.mFormat = format;
+
+   // Reallocation moves everything, so the GPU copy has to be redone   
+   const auto grow = [&](auto& buffer) {
+      const auto capacity = buffer.capacity();
+      slot.mRange.mVertexOffset = static_cast<uint32_t>(buffer.size());
+      buffer.resize(buffer.size() + slot.mVertexCapacity);
+      if (capacity != buffer.capacity())
+         mReallocated = true;
+   };
+
+   if (format == Format::Packed)
+      grow(mPackedVertices);
+   else
+      grow(mVertices);
+}
+
+/// Make sure a slot has room for a number of indices                         
+///   @param slot - the slot to allocate for                                  
+///   @param count - number of indices needed                                 
+void GUIUpload::AllocateIndices(Slot& slot, uint32_t count) {
+   if (slot.mIndexCapacity and count <= slot.mIndexCapacity)
+      return;
+
+   mGarbage += slot.mIndexCapacity;
+   slot.mIndexCapacity = std::max(count * 2, 64u);
+
+   const auto grow = [&](auto& buffer) {
+      const auto capacity = buffer.capacity();
+      slot.mRange.mIndexOffset = static_cast<uint32_t>(buffer.size());
+      buffer.resize(buffer.size() + slot.mIndexCapacity);
+      if (capacity != buffer.capacity())
+         mReallocated = true;
+   };
+
+   if (mRebase)
+      grow(mWideIndices);
+   else
+      grow(mIndices);
+}
+
+/// Size of a staged index                                                    
+size_t GUIUpload::IndexSize() const noexcept {
+   return mRebase ? sizeof(uint32_t) : sizeof(ImDrawIdx);
+}
+
+/// Release the ranges of draw lists that weren't drawn this frame            
+void GUIUpload::Collect() {
+   for (auto it = mSlots.begin(); it != mSlots.end();) {
+      if (it->second.mFrame != mFrame) {
+         mGarbage += it->second.mVertexCapacity + it->second.mIndexCapacity;
+         it = mSlots.erase(it);
+      }
+      else ++it;
+   }
+}
+
+/// Forget all ranges - everything is restaged from scratch                   
+void GUIUpload::Clear() {
+   mSlots.clear();
+   mVertices.clear();
+   mPackedVertices.clear();
+   mIndices.clear();
+   mWideIndices.clear();
+   mGarbage = 0;
+   mReallocated = true;
+}
+
+/// Forget all ranges once most of the buffers is garbage                     
+void GUIUpload::Compact() {
+   if (mGarbage * 2 >= mVertices.size() + mPackedVertices.size()
+                     + mIndices.size() + mWideIndices.size())
+      Clear();
+}
+
+/// Change the vertex format of staging                                       
+/// Everything is restaged on the next frame                                  
+///   @param format - the new format                                          
+void GUIUpload::SetFormat(Format format) noexcept {
+   if (mFormat == format)
+      return;
+   mFormat = format;
+   Clear();
+}
+
+/// Keep everything staged as it is, because the same draw data is drawn      
+/// again - nothing is uploaded, and all ranges remain valid                  
+void GUIUpload::Reuse() noexcept {
+   mDirtyVertices.clear();
+   mDirtyPackedVertices.clear();
+   mDirtyIndices.clear();
+   mFullUpload = false;
+   mUploadedBytes = mSavedBytes = 0;
+   for (auto& range : mRanges) {
+      mSavedBytes += range.mVertexCount * VertexSize(range.mFormat)
+                   + range.mIndexCount * IndexSize();
+   }
+}
+
+/// Run a function for a number of draw lists, on the workers if there's      
+/// enough data to be worth waking them                                       
+///   @param workers - the workers to use, nullptr to run in place            
+///   @param bytes - the amount of data that will be processed                
+///   @param count - number of draw lists                                     
+///   @param body - the function to run for each list                         
+void GUIUpload::Run(GUIWorkers* workers, size_t bytes, Count count, const std::function<void(Offset)>& body) {
+   // Below this, waking threads costs more than the copy itself        
+   constexpr size_t ParallelBytes = 256 * 1024;
+
+   if (workers and count > 1 and bytes >= ParallelBytes)
+      workers->ForEach(count, body);
+   else for (Offset i = 0; i < count; ++i)
+      body(i);
+}
+
+/// Copy a changed draw list into the ranges of its slot                      
+/// Lists write only to their own ranges, so this is safe to do for many      
+/// lists in parallel, as long as nothing is allocated in the meantime        
+///   @param job - the list to copy, mFailed is set if packing failed         
+void GUIUpload::Copy(Job& job) {
+   const auto list = job.mList;
+   const auto& range = job.mSlot->mRange;
+
+   if (range.mFormat == Format::Packed) {
+      job.mFailed = not Pack(list->VtxBuffer.Data,
+         mPackedVertices.data() + range.mVertexOffset,
+         static_cast<int>(range.mVertexCount), mOrigin);
+   }
+   else {
+      StreamCopy(mVertices.data() + range.mVertexOffset,
+         list->VtxBuffer.Data, range.mVertexCount * sizeof(ImDrawVert));
+   }
+
+   if (mRebase) {
+      Rebase(list->IdxBuffer.Data, mWideIndices.data() + range.mIndexOffset,
+         range.mIndexCount, range.mVertexOffset);
+   }
+   else {
+      StreamCopy(mIndices.data() + range.mIndexOffset,
+         list->IdxBuffer.Data, range.mIndexCount * sizeof(ImDrawIdx));
+   }
+}
+
+/// Stage the draw data of a frame                                            
+///   @param data - the draw data to stage                                    
+///   @param workers - threads to copy on, nullptr to copy in place           
+///   @param rebase - whether the renderer lacks RendererHasVtxOffset, so     
+///      indices must be staged with their base vertex added                  
+void GUIUpload::Stage(const ImDrawData* data, GUIWorkers* workers, bool rebase) {
+   // CmdLists is indexed, because it's an array or an ImVector,        
+   // depending on the ImGui version                                    
+   if (not data or not data->CmdListsCount)
+      Stage(nullptr, 0, data ? data->DisplayPos : mOrigin, workers, rebase);
+   else
+      Stage(&data->CmdLists[0], static_cast<Count>(data->CmdListsCount),
+         data->DisplayPos, workers, rebase);
+}
+
+/// Stage a sequence of draw lists, possibly from many ImGui contexts         
+/// Draw lists are identified by their address, which ImGui keeps stable      
+/// for the lifetime of each window. Hashing and copying are done in          
+/// parallel, while the ranges are allocated in between, in draw order        
+///   @param lists - the draw lists to stage                                  
+///   @param count - number of draw lists                                     
+///   @param origin - display position, packed vertices are relative to it    
+///   @param workers - threads to copy on, nullptr to copy in place           
+///   @param rebase - whether the renderer lacks RendererHasVtxOffset, so     
+///      indices must be staged with their base vertex added                  
+void GUIUpload::Stage(const ImDrawList* const* lists, Count count, ImVec2 origin, GUIWorkers* workers, bool rebase) {
+   ++mFrame;
+   mRanges.clear();
+   mDirtyVertices.clear();
+   mDirtyPackedVertices.clear();
+   mDirtyIndices.clear();
+   mFullUpload = false;
+   mUploadedBytes = mSavedBytes = 0;
+   Compact();
+
+   if (rebase != mRebase) {
+      mRebase = rebase;
+      Clear();
+   }
+
+   if (not count) {
+      Collect();
+      return;
+   }
+
+   // Packed positions are relative to the display position, so they    
+   // are all invalid if it moves                                       
+   if (mFormat == Format::Packed
+   and (origin.x != mOrigin.x or origin.y != mOrigin.y)) {
+      mOrigin = origin;
+      Clear();
+   }
+
+   // Hash all lists                                                    
+   size_t total = 0;
+   for (Offset n = 0; n < count; ++n) {
+      total += lists[n]->VtxBuffer.Size * sizeof(ImDrawVert)
+             + lists[n]->IdxBuffer.Size * sizeof(ImDrawIdx);
+   }
+
+   mHashes.resize(count);
+   Run(workers, total, count, [&](Offset n) {
+      mHashes[n] = Hash(lists[n]);
+   });
+
+   // Find the unchanged lists, and reserve ranges for the changed ones 
+   // in draw order - everything that follows only writes to them       
+   mListSlots.resize(count);
+   mJobs.clear();
+   size_t changed = 0;
+   for (Offset n = 0; n < count; ++n) {
+      const auto list = lists[n];
+      const auto vertices = static_cast<uint32_t>(list->VtxBuffer.Size);
+      const auto indices = static_cast<uint32_t>(list->IdxBuffer.Size);
+
+      auto [found, fresh] = mSlots.try_emplace(list, Slot {});
+      auto& slot = found->second;
+      slot.mFrame = mFrame;
+      mListSlots[n] = &slot;
+
+      if (not fresh and slot.mHash == mHashes[n]
+      and slot.mRange.mVertexCount == vertices
+      and slot.mRange.mIndexCount == indices) {
+         // Unchanged - keep the range from the previous frame          
+         mSavedBytes += vertices * VertexSize(slot.mRange.mFormat)
+                      + indices * IndexSize();
+         continue;
+      }
+
+      slot.mHash = mHashes[n];
+      slot.mRange.mVertexCount = vertices;
+      slot.mRange.mIndexCount = indices;
+      AllocateIndices(slot, indices);
+      AllocateVertices(slot,
+         slot.mUnpackable ? Format::Full : mFormat, vertices);
+      mJobs.push_back({list, &slot, false});
+      changed += vertices * sizeof(ImDrawVert) + indices * sizeof(ImDrawIdx);
+   }
+
+   // Copy and convert the changed lists                                
+   Run(workers, changed, mJobs.size(), [&](Offset n) {
+      Copy(mJobs[n]);
+   });
+
+   for (auto& job : mJobs) {
+      auto& range = job.mSlot->mRange;
+      if (job.mFailed) {
+         // Lists that don't fit the fixed point range fall back to     
+         // full - this moves the vertices, so rebased indices are      
+         // copied again too. The list isn't packed again, or it would  
+         // be allocated twice on every change                          
+         job.mSlot->mUnpackable = true;
+         AllocateVertices(*job.mSlot, Format::Full, range.mVertexCount);
+         Copy(job);
+         job.mFailed = false;
+      }
+
+      if (range.mFormat == Format::Packed)
+         MarkDirty(mDirtyPackedVertices, range.mVertexOffset, range.mVertexCount);
+      else
+         MarkDirty(mDirtyVertices, range.mVertexOffset, range.mVertexCount);
+      MarkDirty(mDirtyIndices, range.mIndexOffset, range.mIndexCount);
+      mUploadedBytes += range.mVertexCount * VertexSize(range.mFormat)
+                      + range.mIndexCount * IndexSize();
+   }
+
+   mRanges.reserve(count);
+   for (auto slot : mListSlots)
+      mRanges.push_back(slot->mRange);
+
+   Collect();
+
+   if (mReallocated) {
+      // Buffers were reallocated - everything goes up, regardless of   
+      // what changed                                                   
+      mDirtyVertices.assign(1, {0, static_cast<uint32_t>(mVertices.size())});
+      mDirtyPackedVertices.assign(1, {0, static_cast<uint32_t>(mPackedVertices.size())});
+      mDirtyIndices.assign(1, {0, static_cast<uint32_t>(
+         mRebase ? mWideIndices.size() : mIndices.size())});
+      mUploadedBytes = mVertices.size() * sizeof(ImDrawVert)
+                     + mPackedVertices.size() * sizeof(PackedVert)
+                     + mIndices.size() * sizeof(ImDrawIdx)
+                     + mWideIndices.size() * sizeof(uint32_t);
+      mSavedBytes = 0;
+      mFullUpload = true;
+      mReallocated = false;
+   }
+}
@@ -0,0 +1,152 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include "GUIWorkers.hpp"
+#include <unordered_map>
+#include <vector>
+
+
+///                                                                           
+///   Draw data staging                                                       
+///                                                                           
+/// Copies the vertices and indices of all ImDrawLists into a persistent      
+/// pair of staging buffers, that the renderer mirrors on the GPU. Every      
+/// draw list keeps its range in the buffers across frames, and its payload   
+/// is hashed, so that lists identical to the previous frame aren't copied    
+/// at all. Only the changed spans are reported for uploading. Changed lists  
+/// are copied in parallel on the workers, once all of them have their ranges 
+///                                                                           
+struct GUIUpload {
+   /// Vertex formats in staging                                              
+   enum class Format : uint8_t {
+      // ImDrawVert as it is, 20 bytes                                  
+      Full,
+      // PackedVert, 12 bytes                                           
+      Packed
+   };
+
+   /// Quantized vertex - positions are in fixed point, relative to the       
+   /// display position, texture coordinates are normalized to 16 bits        
+   struct PackedVert {
+      int16_t mPos[2];
+      uint16_t mUV[2];
+      ImU32 mColor;
+   };
+
+   // Fixed point positions have 2 fractional bits, so they cover       
+   // [-8192; 8192) pixels around the display position                  
+   static constexpr float PackedScale = 4.0f;
+
+   /// Where a draw list's geometry is in the staging buffers                 
+   /// Commands are drawn with base vertex mVertexOffset + ImDrawCmd::VtxOffset
+   /// and first index mIndexOffset + ImDrawCmd::IdxOffset. Vertices are in   
+   /// the buffer of their format. Rebased indices already include the base   
+   /// vertex mVertexOffset, but not ImDrawCmd::VtxOffset                     
+   struct Range {
+      uint32_t mVertexOffset;
+      uint32_t mVertexCount;
+      uint32_t mIndexOffset;
+      uint32_t mIndexCount;
+      Format mFormat;
+   };
+
+   /// A span of elements in one of the staging buffers                       
+   struct Span {
+      uint32_t mOffset;
+      uint32_t mCount;
+   };
+
+private:
+   struct Slot {
+      uint64_t mHash;
+      Range mRange;
+      // Reserved elements, a list can grow in place up to these        
+      uint32_t mVertexCapacity;
+      uint32_t mIndexCapacity;
+      // Last frame the draw list was staged in                         
+      uint64_t mFrame;
+      // Set once the list didn't fit the packed format, so that it's   
+      // staged in full until everything is restaged                    
+      bool mUnpackable;
+   };
+
+   /// A changed draw list, waiting to be copied into its range               
+   struct Job {
+      const ImDrawList* mList;
+      Slot* mSlot;
+      // Set if the vertices didn't fit the packed format               
+      bool mFailed;
+   };
+
+   std::unordered_map<const ImDrawList*, Slot> mSlots;
+   std::vector<ImDrawVert> mVertices;
+   std::vector<PackedVert> mPackedVertices;
+   std::vector<ImDrawIdx> mIndices;
+   // Indices with the base vertex added, for renderers that can't offset
+   // vertices - used instead of mIndices                               
+   std::vector<uint32_t> mWideIndices;
+   bool mRebase {};
+   // Format to stage in - lists that can't be packed stay in full      
+   Format mFormat {Format::Full};
+   // Display position the packed vertices are relative to              
+   ImVec2 mOrigin {};
+   // Elements used by the ranges of lists that no longer exist         
+   size_t mGarbage {};
+   uint64_t mFrame {};
+   // Scratch for a frame - hashes of all lists, and the changed ones   
+   std::vector<uint64_t> mHashes;
+   std::vector<Slot*> mListSlots;
+   std::vector<Job> mJobs;
+
+   // Output for the current frame, in draw list order                  
+   std::vector<Range> mRanges;
+   std::vector<Span> mDirtyVertices;
+   std::vector<Span> mDirtyPackedVertices;
+   std::vector<Span> mDirtyIndices;
+   // Whether the buffers were reallocated since the last frame         
+   bool mReallocated {true};
+   // Whether this frame's buffers must be uploaded whole               
+   bool mFullUpload {};
+   size_t mUploadedBytes {};
+   size_t mSavedBytes {};
+
+   void Collect();
+   void Compact();
+   void Clear();
+   void AllocateVertices(Slot&, Format, uint32_t count);
+   void AllocateIndices(Slot&, uint32_t count);
+   void Copy(Job&);
+   void Run(GUIWorkers*, size_t bytes, Count, const std::function<void(Offset)>&);
+   NOD() size_t IndexSize() const noexcept;
+   static void MarkDirty(std::vector<Span>&, uint32_t offset, uint32_t count);
+
+public:
+   void Stage(const ImDrawData*, GUIWorkers* = nullptr, bool rebase = false);
+   void Stage(const ImDrawList* const*, Count, ImVec2 origin, GUIWorkers* = nullptr, bool rebase = false);
+   void Reuse() noexcept;
+   void SetFormat(Format) noexcept;
+
+   NOD() static bool Pack(const ImDrawVert*, PackedVert*, int count, ImVec2 origin) noexcept;
+   NOD() static uint64_t Hash(const ImDrawList*) noexcept;
+
+   NOD() auto& GetVertices() const noexcept { return mVertices; }
+   NOD() auto& GetPackedVertices() const noexcept { return mPackedVertices; }
+   NOD() auto& GetIndices() const noexcept { return mIndices; }
+   NOD() auto& GetWideIndices() const noexcept { return mWideIndices; }
+   NOD() bool IsRebased() const noexcept { return mRebase; }
+   NOD() auto& GetRanges() const noexcept { return mRanges; }
+   NOD() auto& GetDirtyVertices() const noexcept { return mDirtyVertices; }
+   NOD() auto& GetDirtyPackedVertices() const noexcept { return mDirtyPackedVertices; }
+   NOD() auto& GetDirtyIndices() const noexcept { return mDirtyIndices; }
+   NOD() bool IsFullUpload() const noexcept { return mFullUpload; }
+   NOD() auto GetFormat() const noexcept { return mFormat; }
+   NOD() size_t GetUploadedBytes() const noexcept { return mUploadedBytes; }
+   NOD() size_t GetSavedBytes() const noexcept { return mSavedBytes; }
+};
+
@@ -0,0 +1,33 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+
+
+///                                                                           
+///   GUI widget                                                              
+///                                                                           
+/// Heavy widget state, owned by GUIItems of the more complex kinds, such     
+/// as lists and tables. Simple widgets don't need one                        
+///                                                                           
+struct GUIWidget {
+   virtual ~GUIWidget() = default;
+
+   /// Bind the data the widget displays, coming from the descriptor          
+   virtual void SetData(const Many&) {}
+
+   /// React on the item being marked dirty                                   
+   virtual void Refresh(GUIItem&) {}
+
+   /// React on a change notification for an observed entity                  
+   virtual void Changed(const Thing*) {}
+
+   /// Submit the widget to the current ImGui frame                           
+   virtual void Submit(GUIItem&) = 0;
+};
+
@@ -0,0 +1,118 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "GUIWorkers.hpp"
+#include <algorithm>
+#include <memory>
+
+
+/// Worker pool construction                                                  
+///   @param threads - number of threads, or zero to pick one less than       
+///      the number of hardware threads (the main thread stays free)          
+GUIWorkers::GUIWorkers(Count threads) {
+   if (not threads) {
+      const Count hardware = std::thread::hardware_concurrency();
+      threads = hardware > 1 ? hardware - 1 : 1;
+   }
+
+   mThreadCount = threads;
+}
+
+/// Worker pool destruction - waits for tasks in progress, drops the rest     
+GUIWorkers::~GUIWorkers() {
+   {
+      std::lock_guard lock {mMutex};
+      mStop = true;
+      mTasks.clear();
+   }
+
+   mCondition.notify_all();
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+/// Push a task to be executed on any of the worker threads                   
+///   @param task - the task to execute                                       
+void GUIWorkers::Push(Task&& task) {
+   {
+      std::lock_guard lock {mMutex};
+      mTasks.push_back(std::move(task));
+
+      // Start the threads on first use                                 
+      if (mThreads.empty()) {
+         mThreads.reserve(mThreadCount);
+         for (Count i = 0; i < mThreadCount; ++i)
+            mThreads.emplace_back(&GUIWorkers::Work, this);
+      }
+   }
+
+   mCondition.notify_one();
+}
+
+/// Run a function for a range of indices, on the workers and on the calling  
+/// thread at the same time, and wait for all of them to finish               
+/// Indices are claimed one by one, so the calling thread never waits for     
+/// workers busy with long tasks - those simply don't claim anything          
+///   @param count - number of indices                                        
+///   @param body - the function to run for each index                        
+void GUIWorkers::ForEach(Count count, const std::function<void(Offset)>& body) {
+   if (not count)
+      return;
+
+   struct State {
+      std::atomic<Offset> mNext {};
+      std::atomic<Count> mDone {};
+      std::mutex mMutex;
+      std::condition_variable mFinished;
+   };
+
+   // Shared, because helpers might start after everything is done      
+   auto state = std::make_shared<State>();
+   const auto run = [state, count, &body] {
+      Offset i;
+      while ((i = state->mNext.fetch_add(1)) < count) {
+         body(i);
+         if (state->mDone.fetch_add(1) + 1 == count) {
+            std::lock_guard lock {state->mMutex};
+            state->mFinished.notify_all();
+         }
+      }
+   };
+
+   const auto helpers = std::min(mThreadCount, count - 1);
+   for (Count i = 0; i < helpers; ++i)
+      Push(run);
+
+   run();
+
+   std::unique_lock lock {state->mMutex};
+   state->mFinished.wait(lock, [&] {
+      return state->mDone.load() == count;
+   });
+}
+
+/// Thread loop - executes tasks until the pool is destroyed                  
+void GUIWorkers::Work() {
+   while (true) {
+      Task task;
+
+      {
+         std::unique_lock lock {mMutex};
+         mCondition.wait(lock, [this] {
+            return mStop or not mTasks.empty();
+         });
+
+         if (mStop)
+            return;
+
+         task = std::move(mTasks.front());
+         mTasks.pop_front();
+      }
+
+      task();
+   }
+}
@@ -0,0 +1,48 @@
+///                                                                           
+/// Langulus::Module::ImGui                                                   
+/// Copyright (c) 2022 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+///                                                                           
+///   Background workers                                                      
+///                                                                           
+/// A small thread pool, owned by each GUI system, for work that must never   
+/// block building the UI - sorting, filtering, decoding. Threads are         
+/// started lazily on the first pushed task                                   
+///                                                                           
+struct GUIWorkers {
+   using Task = std::function<void()>;
+
+private:
+   std::vector<std::thread> mThreads;
+   std::deque<Task> mTasks;
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   Count mThreadCount {};
+   bool mStop {};
+
+   void Work();
+
+public:
+   GUIWorkers(Count = 0);
+   ~GUIWorkers();
+
+   void Push(Task&&);
+   void ForEach(Count, const std::function<void(Offset)>&);
+
+   NOD() Count GetThreadCount() const noexcept { return mThreadCount; }
+};
+
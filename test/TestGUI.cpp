@@ -10,6 +10,13 @@
 #include <Langulus/Graphics.hpp>
 #include <Langulus/UI.hpp>
 #include <catch2/catch.hpp>
+#include "GUI.hpp"
+#include "GUIList.hpp"
+#include "GUIPlot.hpp"
+#include "GUIDocument.hpp"
+#include "GUIConsole.hpp"
+#include "GUIInspector.hpp"
+#include "GUIThumbnails.hpp"
 
 
 /// See https://github.com/catchorg/Catch2/blob/devel/docs/tostring.md        
@@ -18,6 +25,25 @@ CATCH_TRANSLATE_EXCEPTION(::Langulus::Exception const& ex) {
    return ::std::string {Token {serialized}};
 }
 
+/// Create a GUI system, along with the window and renderer it requires       
+///   @param root - the entity to create the system in                        
+///   @return the GUI system                                                  
+GUISystem* CreateSystem(Thing& root) {
+   root.CreateUnit<A::Window>(Traits::Size(640, 480));
+   root.CreateUnit<A::Renderer>();
+   auto gui = root.CreateUnit<A::UI::System>();
+   return static_cast<GUISystem*>(gui.template As<A::UI::System*>());
+}
+
+/// Get the item inside a container, produced by creating it via token        
+/// Items are created via tokens, so that module types aren't reflected by    
+/// the test itself                                                           
+///   @param unit - the created unit                                          
+///   @return the item                                                        
+GUIItem* AsItem(const Many& unit) {
+   return static_cast<GUIItem*>(unit.template As<A::UIUnit*>());
+}
+
 SCENARIO("GUI creation", "[gui]") {
    static Allocator::State memoryState;
 
@@ -82,3 +108,1720 @@ SCENARIO("GUI creation", "[gui]") {
    }
 }
 
+#if LANGULUS_FEATURE(MANAGED_REFLECTION)
+SCENARIO("Incremental refresh of dirty items", "[gui]") {
+   GIVEN("A window with two labels, refreshed once") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      auto first = root.CreateUnitToken("GUIItem",
+         Traits::Parent {window}, Traits::Name {"First"});
+      auto second = root.CreateUnitToken("GUIItem",
+         Traits::Parent {window}, Traits::Name {"Second"});
+
+      system->Refresh();
+      REQUIRE(system->GetRefreshedCount() == 3);
+      REQUIRE_FALSE(AsItem(window)->IsDirty());
+
+      WHEN("Nothing changes") {
+         system->Refresh();
+
+         THEN("Nothing is reprocessed") {
+            REQUIRE(system->GetRefreshedCount() == 0);
+         }
+      }
+
+      WHEN("A label is marked dirty") {
+         AsItem(first)->MarkDirty();
+
+         THEN("Only the label and its ancestors are reprocessed") {
+            REQUIRE(AsItem(window)->IsDirty());
+            REQUIRE_FALSE(AsItem(second)->IsDirty());
+            system->Refresh();
+            REQUIRE(system->GetRefreshedCount() == 2);
+         }
+      }
+
+      WHEN("An observed entity notifies about a change") {
+         auto entity = Thing::Root<false>();
+         AsItem(second)->Observe(&entity);
+         system->Notify(&entity);
+
+         THEN("Only the observer and its ancestors are reprocessed") {
+            REQUIRE(AsItem(second)->IsDirty());
+            REQUIRE_FALSE(AsItem(first)->IsDirty());
+            system->Refresh();
+            REQUIRE(system->GetRefreshedCount() == 2);
+         }
+
+         AsItem(second)->Unobserve(&entity);
+      }
+   }
+}
+#endif
+
+#if LANGULUS_FEATURE(MANAGED_REFLECTION)
+SCENARIO("Widget templates are compiled once per descriptor shape", "[gui]") {
+   GIVEN("A GUI system") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      const auto before = system->GetTemplateCount();
+
+      WHEN("Many labels of the same shape are created") {
+         for (int i = 0; i < 100; ++i) {
+            root.CreateUnitToken("GUIItem",
+               Traits::Parent {window}, Traits::Name {"Label"});
+         }
+
+         THEN("They share a single template") {
+            REQUIRE(system->GetTemplateCount() == before + 1);
+         }
+      }
+
+      WHEN("Items differ in the order of their traits") {
+         auto a = root.CreateUnitToken("GUIItem",
+            Traits::Parent {window}, Traits::Name {"A"});
+         auto b = root.CreateUnitToken("GUIItem",
+            Traits::Name {"B"}, Traits::Parent {window});
+
+         THEN("Each shape gets its own template, that configures it") {
+            REQUIRE(system->GetTemplateCount() == before + 2);
+            REQUIRE(AsItem(a)->GetParent() == AsItem(window));
+            REQUIRE(AsItem(b)->GetParent() == AsItem(window));
+            REQUIRE(AsItem(b)->GetLabel() == "B");
+         }
+      }
+
+      WHEN("An item has more traits than a template holds") {
+         const Traits::Static s {false};
+         auto item = root.CreateUnitToken("GUIItem",
+            s, s, s, s, s, s, s, s, s, s, s, s, s, s, s, s,
+            Traits::Parent {window}, Traits::Name {"Overflow"});
+
+         THEN("The traits beyond the template are still applied") {
+            REQUIRE(AsItem(item)->GetParent() == AsItem(window));
+            REQUIRE(AsItem(item)->GetLabel() == "Overflow");
+         }
+      }
+
+      WHEN("Another window is created") {
+         auto other = root.CreateUnitToken("GUIItem", Traits::Name {"Other"});
+
+         THEN("It reuses the template of the first window") {
+            REQUIRE(system->GetTemplateCount() == before);
+            REQUIRE(AsItem(other)->GetKind() == GUIItem::Kind::Window);
+         }
+      }
+   }
+}
+#endif
+
+SCENARIO("Sorting list cells", "[gui]") {
+   GIVEN("Numbers and text in the same column") {
+      std::vector<GUIList::SortKey> keys {
+         Token {"1a"}, Token {"10"}, Token {"b"},
+         Token {"9"}, Token {"-2.5"}, Token {"nan"}
+      };
+
+      WHEN("The cells are sorted") {
+         std::sort(keys.begin(), keys.end());
+
+         THEN("Numbers come first by value, followed by text") {
+            std::vector<std::string> sorted;
+            for (auto& key : keys)
+               sorted.push_back(key.mText);
+
+            REQUIRE(sorted == std::vector<std::string> {
+               "-2.5", "9", "10", "1a", "b", "nan"
+            });
+         }
+      }
+
+      THEN("The order is strict and transitive") {
+         for (auto& a : keys) {
+            REQUIRE_FALSE(a < a);
+            for (auto& b : keys) {
+               if (a < b)
+                  REQUIRE_FALSE(b < a);
+               for (auto& c : keys) {
+                  if (a < b and b < c)
+                     REQUIRE(a < c);
+               }
+            }
+         }
+      }
+   }
+}
+
+SCENARIO("Publishing row indices from background jobs", "[gui]") {
+   GIVEN("State shared with two jobs, the second of them being newer") {
+      GUIList::Shared shared;
+      shared.mGeneration = 2;
+
+      WHEN("The stale job finishes after the newer one") {
+         GUIList::Publish(shared, new GUIList::Result {2, {1, 0}});
+         GUIList::Publish(shared, new GUIList::Result {1, {0, 1}});
+
+         THEN("The newer result is kept") {
+            const auto pending = shared.mPending.load();
+            REQUIRE(pending);
+            REQUIRE(pending->mGeneration == 2);
+            REQUIRE(pending->mRows == std::vector<uint32_t> {1, 0});
+         }
+      }
+
+      WHEN("The jobs finish in order") {
+         GUIList::Publish(shared, new GUIList::Result {1, {0, 1}});
+         GUIList::Publish(shared, new GUIList::Result {2, {1, 0}});
+
+         THEN("The newer result replaces the older one") {
+            REQUIRE(shared.mPending.load()->mGeneration == 2);
+         }
+      }
+
+      WHEN("The stale job finishes after the result was consumed") {
+         GUIList::Publish(shared, new GUIList::Result {2, {1, 0}});
+         delete shared.mPending.exchange(nullptr);
+         GUIList::Publish(shared, new GUIList::Result {1, {0, 1}});
+
+         THEN("It's published, and dropped by the list as stale") {
+            REQUIRE(shared.mPending.load()->mGeneration == 1);
+         }
+      }
+   }
+}
+
+SCENARIO("Level-of-detail pyramid of plots", "[gui]") {
+   GIVEN("A plot") {
+      GUIPlot plot;
+      std::vector<float> samples;
+
+      WHEN("Samples are appended one by one") {
+         for (int i = 0; i < 1000; ++i) {
+            samples.push_back(static_cast<float>((i * 7919) % 1013) - 500);
+            plot.Append(samples.back());
+         }
+
+         THEN("Every level reports the range of the samples it covers") {
+            REQUIRE(plot.GetSampleCount() == 1000);
+            REQUIRE(plot.GetLevelCount() == 11);
+
+            for (Count level = 0; level < plot.GetLevelCount(); ++level) {
+               const Count span = Count {1} << level;
+               for (Offset entry = 0; entry * span < samples.size(); ++entry) {
+                  const auto first = samples.begin() + entry * span;
+                  const auto last = samples.begin()
+                     + std::min(samples.size(), (entry + 1) * span);
+                  const auto [min, max] = std::minmax_element(first, last);
+                  const auto range = plot.Query(level, entry);
+                  REQUIRE(range.mMin == *min);
+                  REQUIRE(range.mMax == *max);
+               }
+            }
+         }
+
+         THEN("Ranges are extended to the entries of the level") {
+            const auto range = plot.QueryRange(3, 10, 30);
+            const auto [min, max] = std::minmax_element(
+               samples.begin() + 8, samples.begin() + 32);
+            REQUIRE(range.mMin == *min);
+            REQUIRE(range.mMax == *max);
+         }
+      }
+   }
+}
+
+SCENARIO("Text measurement cache", "[gui]") {
+   GIVEN("A cache and the default font, which is monospace") {
+      ImFontAtlas atlas;
+      const auto font = atlas.AddFontDefault();
+      atlas.Build();
+      GUITextCache cache;
+      const float size = font->FontSize;
+
+      WHEN("The same label is measured twice") {
+         const auto first = cache.Measure(font, size, "Hello world").mSize;
+         const auto second = cache.Measure(font, size, "Hello world").mSize;
+
+         THEN("It is measured only once") {
+            REQUIRE(cache.GetMisses() == 1);
+            REQUIRE(cache.GetHits() == 1);
+            REQUIRE(first.x == second.x);
+            REQUIRE(first.y == second.y);
+         }
+      }
+
+      WHEN("Text is measured, with or without the monospace path") {
+         THEN("The result matches ImGui's own measurement") {
+            for (std::string_view text : {"Hello world", "two\nlines", "tab\tseparated"}) {
+               const auto measured = cache.Measure(font, size, text).mSize;
+               const auto expected = font->CalcTextSizeA(size, FLT_MAX, 0,
+                  text.data(), text.data() + text.size());
+               REQUIRE(measured.x == Approx(expected.x));
+               REQUIRE(measured.y == Approx(expected.y));
+            }
+         }
+      }
+
+      WHEN("Fonts change") {
+         (void)cache.Measure(font, size, "Hello world");
+         cache.Invalidate();
+
+         THEN("Everything is measured again") {
+            REQUIRE(cache.GetCount() == 0);
+         }
+      }
+   }
+}
+
+/// Fill a draw list with a single quad, without an ImGui context             
+///   @param list - the list to fill                                          
+///   @param x, y - top left corner of the quad                               
+///   @param texture - the texture the quad is drawn with                     
+void FillQuad(ImDrawList& list, float x, float y, ImTextureID texture = {}) {
+   ImDrawCmd cmd;
+   cmd.ClipRect = {0, 0, 640, 480};
+   cmd.TextureId = texture;
+   cmd.ElemCount = 6;
+   list.CmdBuffer.clear();
+   list.CmdBuffer.push_back(cmd);
+   list.VtxBuffer.clear();
+   list.IdxBuffer.clear();
+   for (int i = 0; i < 4; ++i) {
+      list.VtxBuffer.push_back({
+         {x + (i & 1) * 10.0f, y + (i >> 1) * 10.0f}, {0, 0}, IM_COL32_WHITE
+      });
+   }
+   for (ImDrawIdx i : {0, 1, 2, 1, 3, 2})
+      list.IdxBuffer.push_back(i);
+}
+
+SCENARIO("Staging draw lists for upload", "[gui]") {
+   GIVEN("Two draw lists") {
+      ImDrawList a {nullptr};
+      ImDrawList b {nullptr};
+      FillQuad(a, 0, 0);
+      FillQuad(b, 20, 0);
+      const ImDrawList* lists[] {&a, &b};
+      GUIUpload upload;
+
+      WHEN("They are staged for the first time") {
+         upload.Stage(lists, 2, {});
+
+         THEN("The buffers are uploaded whole") {
+            REQUIRE(upload.IsFullUpload());
+            REQUIRE(upload.GetRanges().size() == 2);
+            REQUIRE(upload.GetDirtyVertices().size() == 1);
+         }
+      }
+
+      WHEN("They are staged again, unchanged") {
+         upload.Stage(lists, 2, {});
+         upload.Stage(lists, 2, {});
+
+         THEN("Nothing is uploaded") {
+            REQUIRE_FALSE(upload.IsFullUpload());
+            REQUIRE(upload.GetDirtyVertices().empty());
+            REQUIRE(upload.GetDirtyIndices().empty());
+            REQUIRE(upload.GetUploadedBytes() == 0);
+            REQUIRE(upload.GetSavedBytes() > 0);
+         }
+      }
+
+      WHEN("Only one of them changes") {
+         upload.Stage(lists, 2, {});
+         FillQuad(b, 40, 0);
+         upload.Stage(lists, 2, {});
+
+         THEN("Only its range is uploaded") {
+            const auto& range = upload.GetRanges()[1];
+            REQUIRE_FALSE(upload.IsFullUpload());
+            REQUIRE(upload.GetDirtyVertices().size() == 1);
+            REQUIRE(upload.GetDirtyVertices()[0].mOffset == range.mVertexOffset);
+            REQUIRE(upload.GetDirtyVertices()[0].mCount == 4);
+            REQUIRE(upload.GetVertices()[range.mVertexOffset].pos.x == 40);
+         }
+      }
+
+      WHEN("They are staged in the packed format") {
+         upload.SetFormat(GUIUpload::Format::Packed);
+         FillQuad(b, 10000, 0);
+         upload.Stage(lists, 2, {});
+
+         THEN("Lists in range are packed, the rest stay in full") {
+            const auto& ranges = upload.GetRanges();
+            REQUIRE(ranges[0].mFormat == GUIUpload::Format::Packed);
+            REQUIRE(ranges[1].mFormat == GUIUpload::Format::Full);
+            REQUIRE(upload.GetPackedVertices()[ranges[0].mVertexOffset + 3].mPos[0] == 40);
+            REQUIRE(upload.GetVertices()[ranges[1].mVertexOffset].pos.x == 10000);
+         }
+      }
+
+      WHEN("A list that didn't fit the packed format changes") {
+         upload.SetFormat(GUIUpload::Format::Packed);
+         FillQuad(b, 10000, 0);
+         upload.Stage(lists, 2, {});
+         const auto packed = upload.GetPackedVertices().size();
+         const auto full = upload.GetVertices().size();
+         FillQuad(b, 10000, 10);
+         upload.Stage(lists, 2, {});
+
+         THEN("It is updated in full, in place") {
+            const auto& ranges = upload.GetRanges();
+            REQUIRE(ranges[1].mFormat == GUIUpload::Format::Full);
+            REQUIRE(upload.GetPackedVertices().size() == packed);
+            REQUIRE(upload.GetVertices().size() == full);
+            REQUIRE(upload.GetVertices()[ranges[1].mVertexOffset].pos.y == 10);
+         }
+      }
+   }
+}
+
+SCENARIO("Compositing systems that share a window", "[gui]") {
+   GIVEN("Two systems drawing into the same window") {
+      // Windows and systems are only used as keys                      
+      const auto window = reinterpret_cast<const A::Window*>(1);
+      const auto back = reinterpret_cast<const GUISystem*>(2);
+      const auto front = reinterpret_cast<const GUISystem*>(3);
+      GUICompositor compositor;
+      compositor.SetDeadline(std::chrono::hours {1});
+      compositor.Attach(window, back);
+      compositor.Attach(window, front);
+
+      ImDrawList a {nullptr};
+      ImDrawList b {nullptr};
+      FillQuad(a, 0, 0, ImTextureID(1));
+      FillQuad(b, 20, 0, ImTextureID(1));
+      ImDrawData backData;
+      ImDrawData frontData;
+      for (auto [data, list] : {std::pair {&backData, &a}, std::pair {&frontData, &b}}) {
+         data->Valid = true;
+         data->CmdLists.push_back(list);
+         data->CmdListsCount = 1;
+      }
+
+      WHEN("Both submit their frame") {
+         const bool first = compositor.Submit(window, back, &backData);
+         const bool second = compositor.Submit(window, front, &frontData);
+
+         THEN("They are composited once, in attach order, binding the texture once") {
+            REQUIRE(compositor.IsShared(window));
+            REQUIRE_FALSE(first);
+            REQUIRE(second);
+
+            const auto& commands = *compositor.GetCommands(window);
+            const auto& ranges = compositor.GetUpload(window)->GetRanges();
+            REQUIRE(commands.size() == 2);
+            REQUIRE(commands[0].mVertexOffset == ranges[0].mVertexOffset);
+            REQUIRE(commands[1].mVertexOffset == ranges[1].mVertexOffset);
+            REQUIRE(commands[0].mBind);
+            REQUIRE_FALSE(commands[1].mBind);
+            REQUIRE(compositor.GetBinds(window) == 1);
+         }
+      }
+
+      WHEN("Both submit their frame for a renderer without vertex offsets") {
+         compositor.Submit(window, back, &backData, nullptr, true);
+         compositor.Submit(window, front, &frontData, nullptr, true);
+
+         THEN("Indices are staged with their base vertex added") {
+            const auto& upload = *compositor.GetUpload(window);
+            const auto& commands = *compositor.GetCommands(window);
+            const auto& ranges = upload.GetRanges();
+            REQUIRE(upload.IsRebased());
+            REQUIRE(commands.size() == 2);
+            REQUIRE(commands[0].mVertexOffset == 0);
+            REQUIRE(commands[1].mVertexOffset == 0);
+            REQUIRE(commands[1].mIndexOffset == ranges[1].mIndexOffset);
+            REQUIRE(upload.GetWideIndices()[commands[1].mIndexOffset] == ranges[1].mVertexOffset);
+         }
+      }
+
+      WHEN("One of them submits twice, before the other") {
+         const bool first = compositor.Submit(window, back, &backData);
+         const bool second = compositor.Submit(window, back, &backData);
+
+         THEN("The window is composited without waiting") {
+            REQUIRE_FALSE(first);
+            REQUIRE(second);
+            REQUIRE(compositor.GetCommands(window)->size() == 1);
+         }
+      }
+
+      WHEN("The other one misses the deadline") {
+         compositor.SetDeadline({});
+         const bool composited = compositor.Submit(window, back, &backData);
+
+         THEN("The window is composited without it") {
+            REQUIRE(composited);
+            REQUIRE(compositor.GetCommands(window)->size() == 1);
+         }
+      }
+
+      WHEN("One of them is detached") {
+         compositor.Detach(window, front);
+
+         THEN("The window is no longer composited") {
+            REQUIRE_FALSE(compositor.IsShared(window));
+         }
+      }
+   }
+}
+
+SCENARIO("Registering textures and counting binds", "[gui]") {
+   GIVEN("A texture registry") {
+      // Images are only used as keys                                   
+      const auto image = reinterpret_cast<const A::Image*>(16);
+      const auto other = reinterpret_cast<const A::Image*>(32);
+      GUITextures textures;
+
+      WHEN("An image is registered twice, and released once") {
+         const auto id = textures.Register(image);
+         const auto again = textures.Register(image);
+         textures.Release(image);
+
+         THEN("It keeps a single identifier, that is never null") {
+            REQUIRE(GUITextures::ToIndex(id) != 0);
+            REQUIRE(id == again);
+            REQUIRE(textures.Resolve(id) == image);
+            REQUIRE(textures.GetCount() == 1);
+         }
+      }
+
+      WHEN("An image is released completely, and another is registered") {
+         const auto id = textures.Register(image);
+         textures.Release(image);
+         const auto reused = textures.Register(other);
+
+         THEN("The freed slot is reused") {
+            REQUIRE(reused == id);
+            REQUIRE(textures.Resolve(reused) == other);
+            REQUIRE(textures.GetCapacity() == 2);
+         }
+      }
+
+      WHEN("Commands alternating between two textures are simulated") {
+         ImDrawList list {nullptr};
+         for (auto drawn : {image, other, image}) {
+            ImDrawCmd cmd;
+            cmd.ClipRect = {0, 0, 640, 480};
+            cmd.TextureId = textures.Register(drawn);
+            cmd.ElemCount = 6;
+            list.CmdBuffer.push_back(cmd);
+         }
+
+         ImDrawData data;
+         data.Valid = true;
+         data.CmdLists.push_back(&list);
+         data.CmdListsCount = 1;
+
+         const auto bound = textures.Simulate(&data, false);
+         const auto bindless = textures.Simulate(&data, true);
+
+         THEN("Every change is a bind, unless the array is bound once") {
+            REQUIRE(bound.mCommands == 3);
+            REQUIRE(bound.mBinds == 3);
+            REQUIRE(bound.mDraws == 3);
+            REQUIRE(bindless.mCommands == 3);
+            REQUIRE(bindless.mBinds == 1);
+            REQUIRE(bindless.mDraws == 1);
+         }
+      }
+   }
+}
+
+SCENARIO("Packing icons into atlas pages", "[gui]") {
+   GIVEN("A GUI system, and enough images to fill a page") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto& icons = system->GetIcons();
+
+      constexpr int Side = GUIIcons::MaxSize + GUIIcons::Padding;
+      constexpr Count PerPage = (GUIIcons::PageSize / Side) * (GUIIcons::PageSize / Side);
+      std::vector<A::Image*> images;
+      for (Offset i = 0; i < PerPage; ++i)
+         images.push_back(system->CreateImage({1, 1}));
+
+      WHEN("Two icons are drawn in a frame") {
+         const auto a = *icons.Use(images[0], {64, 32});
+         const auto b = *icons.Use(images[1], {32, 64});
+         icons.EndFrame();
+
+         THEN("They share a page, without overlapping") {
+            REQUIRE(icons.GetPageCount() == 1);
+            REQUIRE(icons.GetBlits().size() == 2);
+            REQUIRE(icons.GetBlits()[0].mSource.Get() == images[0]);
+            REQUIRE(a.mTexture == b.mTexture);
+            REQUIRE((a.mUV1.x <= b.mUV0.x or b.mUV1.x <= a.mUV0.x
+                  or a.mUV1.y <= b.mUV0.y or b.mUV1.y <= a.mUV0.y));
+            REQUIRE(icons.GetDrawnIcons() == 2);
+            REQUIRE(icons.GetBinds() == 1);
+            REQUIRE(icons.GetSavedBinds() == 1);
+         }
+      }
+
+      WHEN("Most of a full page is evicted") {
+         for (Offset i = 0; i < PerPage; ++i)
+            REQUIRE(icons.Use(images[i], {GUIIcons::MaxSize, GUIIcons::MaxSize}));
+         for (Offset i = 0; i < 16; ++i)
+            icons.Remove(images[i]);
+         icons.EndFrame();
+         icons.ClearBlits();
+
+         THEN("It isn't repacked before the next frame begins") {
+            REQUIRE(icons.GetRepacks() == 0);
+            REQUIRE(icons.GetBlits().empty());
+
+            icons.BeginFrame();
+            REQUIRE(icons.GetRepacks() == 1);
+            REQUIRE(icons.GetIconCount() == PerPage - 16);
+            REQUIRE(icons.GetBlits().size() == PerPage - 16);
+            REQUIRE(icons.GetOccupancy(0) == Approx(
+               float((PerPage - 16) * Side * Side) / (GUIIcons::PageSize * GUIIcons::PageSize)));
+         }
+      }
+
+      WHEN("A button is given an icon, and drawn") {
+         auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+         auto button = AsItem(root.CreateUnitToken("GUIItem",
+            Traits::Parent {window}, Traits::Widget {"Button"}, Traits::Size(32, 32)));
+         button->SetIcon(images[0]);
+
+         // New windows might be hidden in their first frame            
+         Verbs::Create verb;
+         system->Draw(verb);
+         system->Draw(verb);
+
+         THEN("The icon is drawn from an atlas page") {
+            REQUIRE(icons.GetIconCount() == 1);
+            REQUIRE(icons.GetDrawnIcons() == 1);
+            REQUIRE(icons.GetBlits().front().mSource.Get() == images[0]);
+         }
+      }
+   }
+}
+
+/// Read the whole text of a document                                         
+///   @param document - the document                                          
+///   @return the text                                                        
+std::string ReadAll(const GUIDocument& document) {
+   std::string text;
+   document.Read(0, document.GetSize(), text);
+   return text;
+}
+
+SCENARIO("Editing a text document", "[gui]") {
+   GIVEN("A document with two lines") {
+      GUIDocument document;
+      document.Assign("hello\nworld");
+
+      WHEN("Text is inserted and erased") {
+         document.BeginGroup();
+         document.Insert(5, ", there");
+         document.BeginGroup();
+         document.Erase(0, 7);
+
+         THEN("The text and the line index follow the edits") {
+            REQUIRE(ReadAll(document) == "there\nworld");
+            REQUIRE(document.GetLineCount() == 2);
+            REQUIRE(document.GetLineStart(1) == 6);
+            REQUIRE(document.GetLineEnd(0) == 5);
+            REQUIRE(document.GetLineOf(7) == 1);
+            REQUIRE(document.At(6) == 'w');
+         }
+
+         THEN("Edits are undone and redone one group at a time") {
+            Offset cursor = 0;
+            REQUIRE(document.Undo(cursor));
+            REQUIRE(ReadAll(document) == "hello, there\nworld");
+            REQUIRE(cursor == 7);
+            REQUIRE(document.Undo(cursor));
+            REQUIRE(ReadAll(document) == "hello\nworld");
+            REQUIRE(cursor == 5);
+            REQUIRE_FALSE(document.Undo(cursor));
+
+            REQUIRE(document.Redo(cursor));
+            REQUIRE(ReadAll(document) == "hello, there\nworld");
+            REQUIRE(cursor == 12);
+            REQUIRE(document.Redo(cursor));
+            REQUIRE(ReadAll(document) == "there\nworld");
+            REQUIRE_FALSE(document.CanRedo());
+            REQUIRE(document.GetLineStart(1) == 6);
+         }
+      }
+
+      WHEN("Text is typed one character at a time") {
+         document.BeginGroup();
+         for (Offset i = 0; i < 3; ++i)
+            document.Insert(5 + i, std::string_view {"abc"}.substr(i, 1), true);
+
+         THEN("The characters extend a single piece, undone together") {
+            REQUIRE(ReadAll(document) == "helloabc\nworld");
+            REQUIRE(document.GetPieceCount() == 3);
+
+            Offset cursor = 0;
+            REQUIRE(document.Undo(cursor));
+            REQUIRE(ReadAll(document) == "hello\nworld");
+            REQUIRE_FALSE(document.CanUndo());
+         }
+      }
+
+      WHEN("An undone edit is followed by a new one") {
+         Offset cursor = 0;
+         document.BeginGroup();
+         document.Insert(0, "x");
+         (void)document.Undo(cursor);
+         document.BeginGroup();
+         document.Insert(11, "!");
+
+         THEN("It can no longer be redone") {
+            REQUIRE(ReadAll(document) == "hello\nworld!");
+            REQUIRE_FALSE(document.CanRedo());
+         }
+      }
+
+      WHEN("Many lines are inserted all over the document") {
+         std::string expected = "hello\nworld";
+         for (Offset i = 0; i < 3 * GUIDocument::NodeCapacity; ++i) {
+            const Offset at = (i * 7919) % (expected.size() + 1);
+            const std::string_view text = i % 3 ? "ab" : "\n";
+            document.BeginGroup();
+            document.Insert(at, text);
+            expected.insert(at, text);
+         }
+
+         THEN("Nodes are split, and lines are still found") {
+            REQUIRE(document.GetNodeCount() > 1);
+            REQUIRE(ReadAll(document) == expected);
+
+            Offset line = 0;
+            for (Offset i = 0; i < expected.size(); ++i) {
+               REQUIRE(document.GetLineOf(i) == line);
+               if (expected[i] == '\n') {
+                  REQUIRE(document.GetLineEnd(line) == i);
+                  REQUIRE(document.GetLineStart(++line) == i + 1);
+               }
+            }
+            REQUIRE(document.GetLineCount() == line + 1);
+         }
+      }
+   }
+}
+
+SCENARIO("Spatial index of submitted items", "[gui]") {
+   GIVEN("A window with two items, indexed in a separate ImGui context") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      auto a = root.CreateUnitToken("GUIItem", Traits::Parent {window});
+      auto b = root.CreateUnitToken("GUIItem", Traits::Parent {window});
+      GUIItem* items[] {AsItem(a), AsItem(b)};
+
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+      ImGui::GetIO().DisplaySize = {640, 480};
+      ImGui::GetIO().Fonts->Build();
+
+      // Submit the window, with the first count items, or replay it    
+      GUISpatial spatial;
+      const auto frame = [&](Count count, bool live) {
+         ImGui::NewFrame();
+         ImGui::SetNextWindowPos({0, 0});
+         ImGui::SetNextWindowSize({320, 240});
+         ImGui::Begin("Window");
+         spatial.BeginWindow(*AsItem(window), true);
+         for (Offset i = 0; live and i < count; ++i) {
+            const auto order = spatial.Reserve();
+            ImGui::Button(i ? "B" : "A", {100, 20});
+            spatial.Update(*items[i], order,
+               ImGui::GetItemRectMin(), ImGui::GetItemRectMax());
+         }
+         spatial.EndWindow(live);
+         ImGui::End();
+         spatial.EndFrame();
+         ImGui::Render();
+      };
+
+      // New windows might be hidden in their first frame               
+      frame(2, true);
+      frame(2, true);
+      REQUIRE(spatial.GetCount() == 2);
+
+      ImVec4 rect;
+      REQUIRE(spatial.GetRect(*items[1], rect));
+      const ImVec2 center {(rect.x + rect.z) / 2, (rect.y + rect.w) / 2};
+      REQUIRE(spatial.HitTest(center) == items[1]);
+
+      WHEN("An item is no longer submitted") {
+         frame(1, true);
+
+         THEN("Its entry is dropped") {
+            REQUIRE(spatial.GetCount() == 1);
+            REQUIRE(spatial.IsIndexed(*items[0]));
+            REQUIRE_FALSE(spatial.IsIndexed(*items[1]));
+            REQUIRE(spatial.HitTest(center) == AsItem(window));
+         }
+      }
+
+      WHEN("The window is replayed") {
+         frame(0, false);
+
+         THEN("All entries are kept") {
+            REQUIRE(spatial.GetCount() == 2);
+            REQUIRE(spatial.HitTest(center) == items[1]);
+         }
+      }
+
+      // Entries must not outlive this index                            
+      spatial.Remove(*AsItem(window));
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+#if LANGULUS_FEATURE(MANAGED_REFLECTION)
+SCENARIO("Spreading refreshes over frames", "[gui]") {
+   GIVEN("A window with more labels than fit in one refresh batch") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      std::vector<Many> labels;
+      for (Offset i = 0; i < GUISystem::RefreshBatch + 16; ++i) {
+         labels.emplace_back(root.CreateUnitToken("GUIItem",
+            Traits::Parent {window}, Traits::Name {"Label"}));
+      }
+      const Count total = labels.size() + 1;
+      REQUIRE(system->GetRefreshBudget() == 0);
+
+      WHEN("Refreshed without a budget") {
+         system->Refresh();
+
+         THEN("Everything is reprocessed at once") {
+            REQUIRE(system->GetRefreshedCount() == total);
+            REQUIRE(system->GetQueueDepth() == 0);
+            REQUIRE(system->GetOverruns() == 0);
+            REQUIRE_FALSE(AsItem(window)->IsDirty());
+         }
+      }
+
+      WHEN("Refreshed with a budget that fits a single batch") {
+         system->SetRefreshBudget(0.000001f);
+         system->Refresh();
+
+         THEN("One batch is reprocessed, and the rest is deferred") {
+            REQUIRE(system->GetRefreshedCount() == GUISystem::RefreshBatch);
+            REQUIRE(system->GetQueueDepth()
+               == total - GUISystem::RefreshBatch);
+            REQUIRE(system->GetOverruns() == 1);
+
+            // Children are laid out before their parent                
+            REQUIRE(AsItem(window)->IsDirty());
+            REQUIRE_FALSE(AsItem(labels.front())->IsDirty());
+         }
+
+         THEN("The following refreshes catch up") {
+            Count refreshed = system->GetRefreshedCount();
+            for (int frame = 0; frame < 8 and system->GetQueueDepth(); ++frame) {
+               system->Refresh();
+               refreshed += system->GetRefreshedCount();
+            }
+
+            REQUIRE(system->GetQueueDepth() == 0);
+            REQUIRE(refreshed == total);
+            REQUIRE_FALSE(AsItem(window)->IsDirty());
+         }
+      }
+
+      WHEN("The budget is negative") {
+         system->SetRefreshBudget(-1);
+
+         THEN("It's clamped to no limit") {
+            REQUIRE(system->GetRefreshBudget() == 0);
+            system->Refresh();
+            REQUIRE(system->GetRefreshedCount() == total);
+         }
+      }
+   }
+}
+#endif
+
+#if LANGULUS_FEATURE(MANAGED_REFLECTION)
+SCENARIO("Animating item properties", "[gui]") {
+   GIVEN("A window with several labels") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      std::vector<GUIItem*> labels;
+      for (int i = 0; i < 5; ++i) {
+         labels.push_back(AsItem(root.CreateUnitToken("GUIItem",
+            Traits::Parent {window}, Traits::Name {"Label"})));
+      }
+
+      using Property = GUITweens::Property;
+      using Easing = GUITweens::Easing;
+      auto& tweens = system->GetTweens();
+      REQUIRE_FALSE(tweens.IsRunning());
+
+      WHEN("All labels fade out linearly, and one slides with an easing") {
+         for (auto label : labels)
+            label->Animate(Property::Alpha, 0, 1, Easing::Linear);
+         labels[0]->Animate(Property::OffsetX, 10, 1, Easing::OutQuad);
+         REQUIRE(tweens.GetCount() == labels.size() + 1);
+
+         tweens.Update(0.5f);
+
+         THEN("Halfway through, values follow their curves") {
+            // Five fades cover a group of four and the remainder       
+            for (auto label : labels)
+               REQUIRE(label->GetAlpha() == Approx(0.5f));
+            REQUIRE(labels[0]->GetOffset().x == Approx(7.5f));
+            REQUIRE(tweens.GetFinished() == 0);
+         }
+
+         THEN("Retargeting continues from the current value") {
+            labels[1]->Animate(Property::Alpha, 1, 1, Easing::Linear);
+            REQUIRE(tweens.GetCount() == labels.size() + 1);
+            tweens.Update(0.5f);
+            REQUIRE(labels[1]->GetAlpha() == Approx(0.75f));
+            REQUIRE(labels[2]->GetAlpha() == 0);
+         }
+
+         THEN("Finished tweens land on their target and are removed") {
+            tweens.Update(0.5f);
+            REQUIRE(tweens.GetFinished() == labels.size() + 1);
+            REQUIRE_FALSE(tweens.IsRunning());
+            for (auto label : labels)
+               REQUIRE(label->GetAlpha() == 0);
+            REQUIRE(labels[0]->GetOffset().x == 10);
+         }
+
+         THEN("Stopped tweens leave the value where it is") {
+            tweens.Stop(*labels[0], Property::Alpha);
+            REQUIRE(tweens.GetCount() == labels.size());
+            tweens.Update(0.5f);
+            REQUIRE(labels[0]->GetAlpha() == Approx(0.5f));
+            REQUIRE(labels[1]->GetAlpha() == 0);
+         }
+      }
+
+      WHEN("A property is animated without a duration") {
+         labels[0]->Animate(Property::Value, 3, 0);
+
+         THEN("It's set immediately") {
+            REQUIRE_FALSE(tweens.IsRunning());
+            REQUIRE(labels[0]->GetValue() == 3);
+         }
+      }
+   }
+}
+#endif
+
+SCENARIO("Streaming lines into a console", "[gui]") {
+   GIVEN("A console with the smallest arena") {
+      GUIConsole console {0};
+
+      WHEN("Text is written in pieces") {
+         console.Write("first");
+         console.Write(" line\nsecond");
+         REQUIRE(console.GetLineCount() == 1);
+         console.NewLine();
+
+         THEN("Lines are split at new line characters") {
+            REQUIRE(console.GetLineCount() == 2);
+         }
+      }
+
+      WHEN("More lines are written than fit in the arena") {
+         for (int i = 0; i < 200; ++i) {
+            console.Write("line 000");
+            console.NewLine();
+         }
+
+         THEN("The oldest lines are dropped") {
+            REQUIRE(console.GetLineCount() < 200);
+            REQUIRE(console.GetLineCount() >= 1024 / 8 - 1);
+         }
+      }
+
+      WHEN("The console is cleared") {
+         console.Write("a\nb\n");
+         REQUIRE(console.GetLineCount() == 2);
+         console.Clear();
+
+         THEN("No lines remain") {
+            REQUIRE(console.GetLineCount() == 0);
+         }
+      }
+   }
+
+   GIVEN("A wrapping console, submitted in a separate ImGui context") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      auto item = root.CreateUnitToken("GUIItem", Traits::Parent {window});
+
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+      ImGui::GetIO().DisplaySize = {640, 480};
+      ImGui::GetIO().Fonts->Build();
+
+      GUIConsole console;
+      console.SetWrap(true);
+      for (int i = 0; i < 100; ++i) {
+         console.Write("a line that is long enough to be wrapped when narrow");
+         console.NewLine();
+      }
+
+      const auto frame = [&](float width) {
+         ImGui::NewFrame();
+         ImGui::SetNextWindowPos({0, 0});
+         ImGui::SetNextWindowSize({width, 240});
+         ImGui::Begin("Console");
+         console.Submit(*AsItem(item));
+         ImGui::End();
+         ImGui::Render();
+      };
+
+      // New windows might be hidden in their first frame               
+      frame(320);
+      frame(320);
+      REQUIRE(console.GetVisibleLineCount() == 100);
+      REQUIRE(console.GetSubmittedLines() > 0);
+      REQUIRE(console.GetSubmittedLines() < 100);
+
+      WHEN("The console is resized on every frame") {
+         Count remeasured = 0;
+         for (int i = 1; i < GUIConsole::ResizeSettleFrames; ++i) {
+            frame(320.0f + 10 * i);
+            remeasured += console.GetRemeasuredLines();
+         }
+
+         THEN("Nothing is measured again until the width settles") {
+            REQUIRE(remeasured == 0);
+            for (int i = 0; i <= GUIConsole::ResizeSettleFrames; ++i) {
+               frame(400);
+               remeasured += console.GetRemeasuredLines();
+            }
+            REQUIRE(remeasured == 100);
+         }
+      }
+
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+SCENARIO("Inspecting a hierarchy with a long list of children", "[gui]") {
+   GIVEN("A thing with a thousand children, in a separate ImGui context") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      auto item = root.CreateUnitToken("GUIItem", Traits::Parent {window});
+
+      auto inspected = Thing::Root<false>();
+      auto list = inspected.CreateChild();
+      for (int i = 0; i < 1000; ++i)
+         list->CreateChild();
+
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+      ImGui::GetIO().DisplaySize = {640, 480};
+      ImGui::GetIO().Fonts->Build();
+
+      GUIInspector inspector;
+      inspector.SetData(Many {static_cast<Thing*>(&inspected)});
+      const auto frame = [&] {
+         ImGui::NewFrame();
+         ImGui::SetNextWindowPos({0, 0});
+         ImGui::SetNextWindowSize({320, 240});
+         ImGui::Begin("Inspector");
+         inspector.Submit(*AsItem(item));
+         ImGui::End();
+         ImGui::Render();
+      };
+
+      inspector.Expand(&inspected);
+      inspector.Expand(list.Get());
+      frame();
+      frame();
+      REQUIRE(inspector.GetSubmittedNodes() > 2);
+      REQUIRE(inspector.GetSubmittedNodes() < 100);
+
+      WHEN("One of the children is expanded") {
+         const Thing* first {};
+         for (auto& child : list->GetChildren()) {
+            first = &*child;
+            break;
+         }
+
+         inspector.Expand(first);
+         frame();
+         frame();
+
+         THEN("The collapsed children around it are still clipped") {
+            REQUIRE(inspector.GetSubmittedNodes() > 2);
+            REQUIRE(inspector.GetSubmittedNodes() < 100);
+         }
+      }
+
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+SCENARIO("Recording and replaying static geometry", "[gui]") {
+   GIVEN("Two buttons recorded in a separate ImGui context") {
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+      ImGui::GetIO().DisplaySize = {640, 480};
+      ImGui::GetIO().Fonts->Build();
+
+      ImGui::NewFrame();
+      ImGui::SetNextWindowPos({0, 0});
+      ImGui::SetNextWindowSize({320, 240});
+      ImGui::Begin("Window");
+      const auto draw = ImGui::GetWindowDrawList();
+      const auto origin = ImGui::GetCursorScreenPos();
+      const auto mark = draw->VtxBuffer.Size;
+
+      GUIRecording recording;
+      recording.Begin(draw);
+      ImGui::BeginGroup();
+      ImGui::Button("A", {100, 20});
+      ImGui::Button("B", {100, 20});
+      ImGui::EndGroup();
+      REQUIRE(recording.End(draw, origin, ImGui::GetItemRectSize(), 300));
+      REQUIRE(recording.GetVertexCount() > 0);
+      REQUIRE(recording.IsValid(300));
+      REQUIRE_FALSE(recording.IsValid(200));
+
+      WHEN("The recording is replayed somewhere else") {
+         const auto before = draw->VtxBuffer.Size;
+         recording.Replay(draw, {origin.x + 10, origin.y + 50});
+
+         THEN("The same geometry is emitted, moved by the difference") {
+            REQUIRE(draw->VtxBuffer.Size - before
+               == static_cast<int>(recording.GetVertexCount()));
+            const auto& recorded = draw->VtxBuffer[mark].pos;
+            const auto& replayed = draw->VtxBuffer[before].pos;
+            REQUIRE(replayed.x == Approx(recorded.x + 10));
+            REQUIRE(replayed.y == Approx(recorded.y + 50));
+         }
+      }
+
+      WHEN("Content with a callback is recorded") {
+         recording.Begin(draw);
+         draw->AddCallback([](const ImDrawList*, const ImDrawCmd*) {}, nullptr);
+
+         THEN("It can't be replayed") {
+            REQUIRE_FALSE(recording.End(draw, origin, {}, 300));
+            REQUIRE_FALSE(recording.IsValid(300));
+         }
+      }
+
+      WHEN("The recording is reset") {
+         recording.Reset();
+
+         THEN("It's invalid, and empty") {
+            REQUIRE_FALSE(recording.IsValid(300));
+            REQUIRE(recording.GetVertexCount() == 0);
+         }
+      }
+
+      ImGui::End();
+      ImGui::Render();
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+SCENARIO("Capturing windows into layers", "[gui]") {
+   GIVEN("A window with a layer, drawn in a separate ImGui context") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+      REQUIRE(AsItem(window)->GetLayer()->GetMode() == GUILayer::Mode::Auto);
+
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+      ImGui::GetIO().DisplaySize = {640, 480};
+      ImGui::GetIO().Fonts->Build();
+
+      // Draw the window, from the layer if possible, and capture it    
+      GUILayer layer {GUILayer::Mode::Always};
+      std::vector<GUILayer::Capture> captures;
+      const auto frame = [&] {
+         ImGui::NewFrame();
+         ImGui::SetNextWindowPos({0, 0});
+         ImGui::SetNextWindowSize({320, 240});
+         ImGui::Begin("Window");
+         layer.Begin(false);
+         const bool replayed = layer.Replay();
+         if (not replayed) {
+            layer.BeginCapture();
+            ImGui::Button("A", {100, 20});
+            layer.EndCapture();
+         }
+         ImGui::End();
+         ImGui::Render();
+
+         const std::vector<const ImDrawList*> windows {layer.GetDrawList()};
+         layer.Capture(*AsItem(window), ImGui::GetDrawData(), windows, captures);
+         layer.EndFrame();
+         return replayed;
+      };
+
+      // New windows might be hidden in their first frame               
+      frame();
+      frame();
+      REQUIRE(captures.size() == 1);
+      REQUIRE(captures[0].mLayer == &layer);
+      REQUIRE_FALSE(captures[0].mLists.empty());
+      REQUIRE(layer.IsPending());
+      REQUIRE_FALSE(layer.IsValid());
+
+      WHEN("The renderer hasn't drawn the capture yet") {
+         const bool replayed = frame();
+
+         THEN("The window is drawn live, and not captured again") {
+            REQUIRE_FALSE(replayed);
+            REQUIRE(captures.size() == 1);
+         }
+      }
+
+      WHEN("The renderer acknowledges the capture") {
+         layer.Acknowledge(captures[0].mSerial);
+
+         THEN("The layer is valid, and replayed") {
+            REQUIRE(layer.IsValid());
+            REQUIRE_FALSE(layer.IsPending());
+            REQUIRE(frame());
+         }
+      }
+
+      WHEN("The window changes before the capture is acknowledged") {
+         layer.Invalidate();
+         layer.Acknowledge(captures[0].mSerial);
+
+         THEN("The outdated capture doesn't make the layer valid") {
+            REQUIRE_FALSE(layer.IsValid());
+            REQUIRE_FALSE(frame());
+            REQUIRE(captures.size() == 2);
+         }
+      }
+
+      WHEN("The capture is dropped without being drawn") {
+         layer.Drop(captures[0].mSerial);
+         frame();
+
+         THEN("The window is captured again") {
+            REQUIRE(captures.size() == 2);
+            REQUIRE(captures[1].mSerial != captures[0].mSerial);
+         }
+      }
+
+      captures.clear();
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+SCENARIO("Updating the UI at a lower rate than it's drawn", "[gui]") {
+   GIVEN("A system that updates the UI ten times per second") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem", Traits::Name {"Window"});
+
+      // Draw ignores its verb                                          
+      Verbs::Create verb;
+      system->SetTargetRate(10);
+      system->Draw(verb);
+      const auto skipped = system->GetSkippedFrames();
+      const auto now = std::chrono::steady_clock::now;
+
+      WHEN("Drawn again right away") {
+         REQUIRE_FALSE(system->IsFrameDue(now()));
+         system->Draw(verb);
+
+         THEN("The last UI frame is drawn again") {
+            REQUIRE(system->GetSkippedFrames() == skipped + 1);
+         }
+      }
+
+      WHEN("The system is woken") {
+         system->Wake();
+
+         THEN("A UI frame runs immediately") {
+            REQUIRE(system->IsFrameDue(now()));
+            system->Draw(verb);
+            REQUIRE(system->GetSkippedFrames() == skipped);
+         }
+      }
+
+      WHEN("Input is queued by the platform") {
+         ImGui::GetIO().AddMousePosEvent(10, 10);
+
+         THEN("A UI frame runs immediately") {
+            REQUIRE(system->IsFrameDue(now()));
+            system->Draw(verb);
+            REQUIRE(system->GetSkippedFrames() == skipped);
+         }
+      }
+
+      WHEN("An item is animated") {
+         AsItem(window)->Animate(GUITweens::Property::Alpha, 0, 1);
+
+         THEN("UI frames run for as long as the animation does") {
+            REQUIRE(system->IsFrameDue(now()));
+            system->Draw(verb);
+            REQUIRE(system->GetSkippedFrames() == skipped);
+            REQUIRE(system->GetTweens().IsRunning());
+            REQUIRE(system->IsFrameDue(now()));
+         }
+      }
+
+      WHEN("The rate is removed") {
+         system->SetTargetRate(0);
+         system->Draw(verb);
+         system->Draw(verb);
+
+         THEN("Every drawn frame is a UI frame") {
+            REQUIRE(system->GetSkippedFrames() == skipped);
+         }
+      }
+   }
+}
+
+SCENARIO("Culling commands hidden behind opaque windows", "[gui]") {
+   GIVEN("Opaque windows in a separate ImGui context") {
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+      ImGui::GetIO().DisplaySize = {640, 480};
+      ImGui::GetIO().Fonts->Build();
+      ImGui::GetStyle().Colors[ImGuiCol_WindowBg].w = 1;
+      ImGui::GetStyle().Colors[ImGuiCol_ChildBg].w = 1;
+
+      ImDrawList* back {};
+      ImDrawList* front {};
+      GUIOcclusion occlusion;
+
+      WHEN("A window is drawn over another one") {
+         // New windows might be hidden in their first frame            
+         for (int i = 0; i < 2; ++i) {
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos({20, 40});
+            ImGui::SetNextWindowSize({150, 100});
+            ImGui::Begin("Back");
+            back = ImGui::GetWindowDrawList();
+            ImGui::Button("Hidden");
+            ImGui::End();
+
+            ImGui::SetNextWindowPos({0, 0});
+            ImGui::SetNextWindowSize({300, 240});
+            ImGui::Begin("Front");
+            front = ImGui::GetWindowDrawList();
+            ImGui::Button("Visible");
+            ImGui::End();
+            ImGui::Render();
+         }
+
+         const auto backCommands = back->CmdBuffer.Size;
+         const auto frontCommands = front->CmdBuffer.Size;
+         occlusion.Cull(ImGui::GetDrawData());
+
+         THEN("Only the contents of the window behind are culled") {
+            REQUIRE(occlusion.GetCulledCommands() > 0);
+            REQUIRE(back->CmdBuffer.Size < backCommands);
+            REQUIRE(front->CmdBuffer.Size == frontCommands);
+         }
+      }
+
+      WHEN("A tall child is scrolled inside a short window") {
+         for (int i = 0; i < 2; ++i) {
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos({20, 150});
+            ImGui::SetNextWindowSize({150, 80});
+            ImGui::Begin("Back");
+            back = ImGui::GetWindowDrawList();
+            ImGui::Button("Below");
+            ImGui::End();
+
+            // The child extends far below its parent, but only the     
+            // part of it inside the parent is visible                  
+            ImGui::SetNextWindowPos({0, 0});
+            ImGui::SetNextWindowSize({300, 100});
+            ImGui::Begin("Front");
+            ImGui::BeginChild("Tall", {0, 1000});
+            ImGui::Button("Inside");
+            ImGui::EndChild();
+            ImGui::End();
+            ImGui::Render();
+         }
+
+         const auto backCommands = back->CmdBuffer.Size;
+         occlusion.Cull(ImGui::GetDrawData());
+
+         THEN("The window below the parent isn't culled") {
+            REQUIRE(back->CmdBuffer.Size == backCommands);
+         }
+      }
+
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+/// Append a quad the way ImGui's PrimRect does, as its own command           
+///   @param list - the list to append to                                     
+///   @param x, y - top-left corner of the quad                               
+void RectQuad(ImDrawList& list, float x, float y) {
+   ImDrawCmd cmd;
+   cmd.ClipRect = {0, 0, 640, 480};
+   cmd.IdxOffset = static_cast<unsigned>(list.IdxBuffer.Size);
+   cmd.VtxOffset = static_cast<unsigned>(list.VtxBuffer.Size);
+   cmd.ElemCount = 6;
+   list.CmdBuffer.push_back(cmd);
+   for (auto corner : {ImVec2 {x, y}, ImVec2 {x + 10, y}, ImVec2 {x + 10, y + 10}, ImVec2 {x, y + 10}})
+      list.VtxBuffer.push_back({corner, {0, 0}, IM_COL32(255, 0, 0, 255)});
+   for (ImDrawIdx i : {0, 1, 2, 0, 2, 3})
+      list.IdxBuffer.push_back(i);
+}
+
+/// Corners of all triangles in a list, in drawing order                      
+///   @param list - the list to walk                                          
+///   @return the corners, with callbacks as a corner at -1,-1                
+std::vector<std::pair<float, float>> Corners(const ImDrawList& list) {
+   std::vector<std::pair<float, float>> corners;
+   for (auto& cmd : list.CmdBuffer) {
+      if (cmd.UserCallback) {
+         corners.emplace_back(-1.0f, -1.0f);
+         continue;
+      }
+
+      for (unsigned i = 0; i < cmd.ElemCount; ++i) {
+         const auto& v = list.VtxBuffer[cmd.VtxOffset + list.IdxBuffer[cmd.IdxOffset + i]];
+         corners.emplace_back(v.pos.x, v.pos.y);
+      }
+   }
+   return corners;
+}
+
+SCENARIO("Converting draw lists to instances and back", "[gui]") {
+   GIVEN("A draw list, and a list to expand into") {
+      // Expanding requires the shared data of a context                
+      const auto previous = ImGui::GetCurrentContext();
+      const auto context = ImGui::CreateContext();
+      ImGui::SetCurrentContext(context);
+
+      ImDrawList in {nullptr};
+      ImDrawList out {ImGui::GetDrawListSharedData()};
+      out._ResetForNewFrame();
+      out.Flags |= ImDrawListFlags_AllowVtxOffset;
+      ImDrawData data;
+      data.Valid = true;
+      data.CmdLists.push_back(&in);
+      data.CmdListsCount = 1;
+      GUIInstances instances;
+
+      WHEN("Quads, triangles and a callback are converted") {
+         // A quad, followed by two triangles that aren't one, in the   
+         // same command, then a callback, then another quad            
+         RectQuad(in, 0, 0);
+         ImDrawList triangles {nullptr};
+         FillQuad(triangles, 20, 0);
+         for (auto& v : triangles.VtxBuffer)
+            in.VtxBuffer.push_back(v);
+         for (auto i : triangles.IdxBuffer)
+            in.IdxBuffer.push_back(static_cast<ImDrawIdx>(i + 4));
+         in.CmdBuffer.back().ElemCount += 6;
+
+         ImDrawCmd callback;
+         callback.UserCallback = [](const ImDrawList*, const ImDrawCmd*) {};
+         callback.IdxOffset = static_cast<unsigned>(in.IdxBuffer.Size);
+         in.CmdBuffer.push_back(callback);
+         RectQuad(in, 40, 0);
+
+         instances.Build(&data);
+         instances.Expand(&out);
+
+         THEN("Batches keep the order of the commands") {
+            using Kind = GUIInstances::Kind;
+            const auto& batches = instances.GetBatches();
+            REQUIRE(batches.size() == 4);
+            REQUIRE(batches[0].mKind == Kind::Instances);
+            REQUIRE(batches[1].mKind == Kind::Triangles);
+            REQUIRE(batches[2].mKind == Kind::Callback);
+            REQUIRE(batches[3].mKind == Kind::Instances);
+            REQUIRE(instances.GetInstances().size() == 2);
+            REQUIRE(instances.GetVertices().size() == 4);
+            REQUIRE(instances.GetIndices().size() == 6);
+            REQUIRE(instances.GetOutputBytes() < instances.GetInputBytes());
+         }
+
+         THEN("The expanded triangles are the original ones") {
+            REQUIRE(Corners(in) == Corners(out));
+         }
+      }
+
+      WHEN("Triangles reference more vertices than 16-bit indices address") {
+         // Two commands of lone triangles, that would overflow a       
+         // single batch together                                       
+         constexpr int Count = 39999;
+         for (int c = 0; c < 2; ++c) {
+            ImDrawCmd cmd;
+            cmd.ClipRect = {0, 0, 640, 480};
+            cmd.IdxOffset = static_cast<unsigned>(in.IdxBuffer.Size);
+            cmd.VtxOffset = static_cast<unsigned>(in.VtxBuffer.Size);
+            cmd.ElemCount = Count;
+            in.CmdBuffer.push_back(cmd);
+            for (int i = 0; i < Count; ++i) {
+               const int n = c * Count + i;
+               in.VtxBuffer.push_back({
+                  {float(n % 640), float(n / 640)}, {0, 0}, IM_COL32_WHITE});
+               in.IdxBuffer.push_back(static_cast<ImDrawIdx>(i));
+            }
+         }
+
+         instances.Build(&data);
+         instances.Expand(&out);
+
+         THEN("The triangles are split in batches that fit") {
+            const auto& batches = instances.GetBatches();
+            REQUIRE(instances.GetInstances().empty());
+            REQUIRE(batches.size() == 2);
+            for (auto& batch : batches) {
+               REQUIRE(batch.mKind == GUIInstances::Kind::Triangles);
+               REQUIRE(batch.mCount == Count);
+            }
+         }
+
+         THEN("The expanded triangles are the original ones") {
+            REQUIRE(Corners(in) == Corners(out));
+         }
+      }
+
+      ImGui::DestroyContext(context);
+      ImGui::SetCurrentContext(previous);
+   }
+}
+
+SCENARIO("Staging large draw lists on workers", "[gui]") {
+   GIVEN("Enough draw lists to be copied in parallel") {
+      // 8 lists of 8000 vertices are well above the 256 KiB, below     
+      // which lists are copied in place                                
+      constexpr int Lists = 8;
+      constexpr int Vertices = 8000;
+      std::vector<std::unique_ptr<ImDrawList>> storage;
+      std::vector<const ImDrawList*> lists;
+      for (int n = 0; n < Lists; ++n) {
+         auto& list = *storage.emplace_back(std::make_unique<ImDrawList>(nullptr));
+         for (int i = 0; i < Vertices; ++i) {
+            list.VtxBuffer.push_back({
+               {float(i % 640), float(n)}, {0, 0}, IM_COL32_WHITE});
+         }
+         for (int i = 0; i < Vertices * 3 / 2; ++i)
+            list.IdxBuffer.push_back(static_cast<ImDrawIdx>((i * 7) % Vertices));
+         lists.push_back(&list);
+      }
+
+      GUIWorkers workers {4};
+      GUIUpload upload;
+
+      WHEN("They are staged with rebased indices") {
+         upload.Stage(lists.data(), Lists, {}, &workers, true);
+
+         THEN("Every list is copied, with its base vertex in its indices") {
+            REQUIRE(upload.IsRebased());
+            const auto& ranges = upload.GetRanges();
+            const auto& vertices = upload.GetVertices();
+            const auto& wide = upload.GetWideIndices();
+            REQUIRE(ranges.size() == Lists);
+            REQUIRE(wide.size() >= size_t {Lists} * Vertices * 3 / 2);
+
+            bool copied = true;
+            for (int n = 0; n < Lists; ++n) {
+               const auto& range = ranges[n];
+               const auto& list = *lists[n];
+               for (int i = 0; i < list.IdxBuffer.Size; ++i) {
+                  const auto index = wide[range.mIndexOffset + i];
+                  copied &= index == list.IdxBuffer[i] + range.mVertexOffset;
+                  copied &= vertices[index].pos.x == list.VtxBuffer[list.IdxBuffer[i]].pos.x;
+                  copied &= vertices[index].pos.y == float(n);
+               }
+            }
+            REQUIRE(copied);
+         }
+      }
+
+      WHEN("They are staged again, unchanged, then in place") {
+         upload.Stage(lists.data(), Lists, {}, &workers, true);
+         const auto wide = upload.GetWideIndices();
+         upload.Stage(lists.data(), Lists, {}, &workers, true);
+         GUIUpload serial;
+         serial.Stage(lists.data(), Lists, {}, nullptr, true);
+
+         THEN("Nothing is copied the second time") {
+            REQUIRE(upload.GetDirtyIndices().empty());
+            REQUIRE(upload.GetUploadedBytes() == 0);
+         }
+
+         THEN("The workers produce the same indices as staging in place") {
+            REQUIRE(serial.GetWideIndices() == wide);
+         }
+      }
+
+      WHEN("Rebasing is turned off") {
+         upload.Stage(lists.data(), Lists, {}, &workers, true);
+         upload.Stage(lists.data(), Lists, {}, &workers, false);
+
+         THEN("Everything is restaged with narrow indices") {
+            REQUIRE_FALSE(upload.IsRebased());
+            REQUIRE(upload.IsFullUpload());
+            REQUIRE(upload.GetWideIndices().empty());
+            REQUIRE(upload.GetIndices().size() >= size_t {Lists} * Vertices * 3 / 2);
+         }
+      }
+   }
+}
+
+/// Thumbnails of solid color, counting how many times they were decoded      
+struct SolidThumbnails final : GUIThumbnails::Source {
+   mutable std::atomic<Count> mDecoded {};
+
+   Count GetCount() const override { return 500; }
+
+   bool Decode(Offset, int size, GUIThumbnails::Pixels& out) const override {
+      out.mWidth = out.mHeight = size;
+      out.mData.assign(size_t(size) * size, 0xFFFFFFFF);
+      ++mDecoded;
+      return true;
+   }
+};
+
+SCENARIO("Decoding more thumbnails than fit in the budget", "[gui]") {
+   GIVEN("A grid with more visible cells than slots") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem",
+         Traits::Name {"Window"}, Traits::Size(640, 480));
+      auto item = AsItem(root.CreateUnitToken("GUIItem",
+         Traits::Parent {window}, Traits::Widget {"Thumbnails"}));
+      auto grid = static_cast<GUIThumbnails*>(item->GetWidget());
+
+      // A single page holds 64 slots, small thumbnails show more       
+      const auto source = std::make_shared<SolidThumbnails>();
+      grid->SetBudget(GUIThumbnails::PageBytes);
+      grid->SetThumbnailSize(16);
+      grid->SetSource(source);
+
+      WHEN("Frames are drawn until decoding settles") {
+         Verbs::Create verb;
+         const auto draw = [&](int frames) {
+            for (int i = 0; i < frames; ++i) {
+               system->Draw(verb);
+               std::this_thread::sleep_for(std::chrono::milliseconds {2});
+            }
+         };
+
+         draw(200);
+         const Count decoded = source->mDecoded;
+         const auto evictions = grid->GetEvictions();
+         draw(20);
+
+         THEN("Every slot is used, and nothing is decoded again") {
+            REQUIRE(grid->GetResidentCount() == GUIThumbnails::SlotsPerPage);
+            REQUIRE(grid->GetPlaceholders() > 0);
+            REQUIRE(grid->GetPendingCount() == 0);
+            REQUIRE(source->mDecoded == decoded);
+            REQUIRE(grid->GetEvictions() == evictions);
+         }
+      }
+   }
+}
+
+SCENARIO("Binding a slider to a trait of an entity", "[gui]") {
+   GIVEN("A slider from zero to ten, bound to a trait of an entity") {
+      auto root = Thing::Root<false>("GLFW", "Vulkan", "ImGui");
+      auto system = CreateSystem(root);
+      auto window = root.CreateUnitToken("GUIItem",
+         Traits::Name {"Window"}, Traits::Size(640, 480));
+      auto slider = AsItem(root.CreateUnitToken("GUIItem",
+         Traits::Parent {window}, Traits::Widget {"Slider"},
+         Traits::Name {"Value"}, Traits::Limits(0, 10)));
+
+      // Traits are changed the same way the system sends edits         
+      const auto meta = MetaTraitOf<Traits::Size>();
+      auto target = Thing::Root<false>();
+      const auto change = [&](float value) {
+         Verbs::Associate associate {Trait::From(meta, Many {value})};
+         target.Run(associate);
+      };
+      change(5);
+      slider->Bind(&target, meta);
+
+      // New windows might be hidden in their first frame               
+      Verbs::Create verb;
+      system->Draw(verb);
+      system->Draw(verb);
+      REQUIRE(slider->GetValue() == 5);
+
+      WHEN("The trait is changed outside of the GUI") {
+         change(7);
+         system->Draw(verb);
+
+         THEN("The slider follows only once the system is notified") {
+            REQUIRE(slider->GetValue() == 5);
+            system->Notify(&target, meta);
+            system->Draw(verb);
+            REQUIRE(slider->GetValue() == 7);
+         }
+      }
+
+      WHEN("The trait is edited several times in a frame") {
+         system->Commit(&target, meta, Many {8.0f});
+         system->Commit(&target, meta, Many {9.0f});
+         const auto pending = system->GetPendingEdits();
+         system->Draw(verb);
+
+         THEN("Only the last edit is sent, and the slider rereads it") {
+            REQUIRE(pending == 1);
+            REQUIRE(system->GetSentEdits() == 1);
+            system->Draw(verb);
+            REQUIRE(slider->GetValue() == 9);
+         }
+      }
+
+      WHEN("The slider is dragged with the mouse, and released") {
+         ImVec4 rect;
+         REQUIRE(system->GetSpatial().GetRect(*slider, rect));
+         const float y = (rect.y + rect.w) * 0.5f;
+         auto& io = ImGui::GetIO();
+         io.AddMousePosEvent(rect.x + 2, y);
+         system->Draw(verb);
+         io.AddMouseButtonEvent(0, true);
+         system->Draw(verb);
+         io.AddMousePosEvent(rect.x + 100, y);
+         system->Draw(verb);
+         const auto dragged = slider->GetValue();
+         const auto sentWhileDragging = system->GetSentEdits();
+         io.AddMouseButtonEvent(0, false);
+         system->Draw(verb);
+
+         THEN("The value is sent once, when the slider is released") {
+            REQUIRE(dragged != 5);
+            REQUIRE(dragged >= 0);
+            REQUIRE(dragged <= 10);
+            REQUIRE(sentWhileDragging == 0);
+            REQUIRE(system->GetSentEdits() == 1);
+            REQUIRE(target.GetTrait(meta).template AsCast<float>() == Approx(dragged));
+         }
+      }
+   }
+}